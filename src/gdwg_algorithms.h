@@ -0,0 +1,761 @@
+#ifndef GDWG_ALGORITHMS_H
+#define GDWG_ALGORITHMS_H
+#include "gdwg_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	// A path returned by shortest_path: its total cost and its nodes from src to dst
+	template<typename N, typename E>
+	struct weighted_path {
+		E cost;
+		std::vector<N> nodes;
+
+		auto operator==(weighted_path const&) const -> bool = default;
+	};
+
+	/**
+	* Traversals over the node ids of a graph. Edge weights are ignored, and several edges between
+	* the same pair of nodes count as one.
+	*
+	* Visited marks are one bit per node id, and every work list is sized once up front, so the
+	* single-threaded traversals allocate nothing per visited node beyond the result itself.
+	* Use the free functions below rather than this class directly.
+	*/
+	template<typename N, typename E>
+	class graph_traversal {
+		using graph_type = graph<N, E>;
+		using node_id = typename graph_type::node_id;
+		using edge_list = typename graph_type::edge_list;
+
+	public:
+		// Nodes reachable from sources, in breadth-first order. Neighbours are visited in increasing order.
+		template<typename NodeRange>
+		static auto bfs(graph_type const& g, NodeRange const& sources, char const* caller) -> std::vector<N> {
+			auto visited = visited_set(slot_count(g));
+			auto order = std::vector<node_id>();
+			order.reserve(g.state_->index.size());
+			for (const auto& source : sources) {
+				if (const auto id = id_of(g, source, caller); visited.insert(id)) {
+					order.push_back(id);
+				}
+			}
+
+			// order doubles as the queue: everything after head is the frontier
+			for (auto head = std::size_t{0}; head < order.size(); ++head) {
+				for (const auto& record : g.edges_of(order[head]).outgoing) {
+					if (visited.insert(record.node)) {
+						order.push_back(record.node);
+					}
+				}
+			}
+			return values_of(g, order);
+		}
+
+		// Nodes reachable from src in depth-first preorder. Neighbours are visited in increasing order.
+		static auto dfs(graph_type const& g, N const& src) -> std::vector<N> {
+			auto visited = visited_set(slot_count(g));
+			auto order = std::vector<node_id>();
+			order.reserve(g.state_->index.size());
+
+			// Each frame is a node and the position of the next outgoing edge to follow
+			auto stack = std::vector<std::pair<node_id, std::size_t>>();
+			stack.reserve(g.state_->index.size());
+			const auto src_id = id_of(g, src, "dfs");
+			visited.insert(src_id);
+			order.push_back(src_id);
+			stack.emplace_back(src_id, 0);
+			while (!stack.empty()) {
+				auto& [id, next] = stack.back();
+				const auto& outgoing = g.edges_of(id).outgoing;
+				while (next < outgoing.size() and !visited.insert(outgoing[next].node)) {
+					++next;
+				}
+				if (next == outgoing.size()) {
+					stack.pop_back();
+					continue;
+				}
+				const auto child = outgoing[next++].node;
+				order.push_back(child);
+				stack.emplace_back(child, 0);
+			}
+			return values_of(g, order);
+		}
+
+		// Nodes reachable from src, in increasing order
+		static auto reachable(graph_type const& g, N const& src) -> std::vector<N> {
+			auto nodes = bfs(g, std::initializer_list<N>{src}, "reachable");
+			std::sort(nodes.begin(), nodes.end());
+			return nodes;
+		}
+
+		// Hop distance from the nearest source to every reachable node, by direction-optimizing BFS
+		template<typename NodeRange>
+		static auto parallel_bfs(graph_type const& g, NodeRange const& sources, std::size_t threads)
+		   -> std::vector<std::pair<N, std::size_t>> {
+			if (threads == 0) {
+				threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+			}
+			const auto n = slot_count(g);
+			auto levels = std::vector<std::uint32_t>(n, unreached);
+			auto visited = std::vector<std::atomic<std::uint64_t>>(word_count(n));
+			auto frontier = std::vector<node_id>();
+			for (const auto& source : sources) {
+				const auto id = id_of(g, source, "parallel_bfs");
+				if (levels[id] == unreached) {
+					levels[id] = 0;
+					visited[id / word_bits].fetch_or(bit(id), std::memory_order_relaxed);
+					frontier.push_back(id);
+				}
+			}
+
+			// Edges still to be checked from unvisited nodes, for the direction heuristic
+			auto unexplored = std::size_t{0};
+			for (auto id = node_id{0}; id < n; ++id) {
+				if (is_live(g, id) and levels[id] == unreached) {
+					unexplored += g.edges_of(id).outgoing.size();
+				}
+			}
+
+			auto per_thread = std::vector<thread_frontier>(threads);
+			auto frontier_bits = std::vector<std::uint64_t>();
+			auto next_bits = std::vector<std::uint64_t>();
+			auto bottom_up = false;
+			for (auto level = std::uint32_t{1}; !frontier.empty() or bottom_up; ++level) {
+				// Bottom-up steps need the incoming lists, so graphs that defer them always go top-down
+				if (!bottom_up and g.has_incoming_index()) {
+					// Switch once the frontier has more edges to scan than a fraction of the unvisited nodes do
+					auto frontier_edges = std::size_t{0};
+					for (const auto id : frontier) {
+						frontier_edges += g.edges_of(id).outgoing.size();
+					}
+					if (frontier_edges * alpha > unexplored) {
+						bottom_up = true;
+						frontier_bits.assign(word_count(n), 0);
+						for (const auto id : frontier) {
+							frontier_bits[id / word_bits] |= bit(id);
+						}
+					}
+				}
+
+				if (bottom_up) {
+					next_bits.assign(word_count(n), 0);
+					bottom_up_step(g, level, threads, frontier_bits, next_bits, visited, levels, per_thread);
+				}
+				else {
+					top_down_step(g, level, threads, frontier, visited, levels, per_thread);
+				}
+
+				auto found = std::size_t{0};
+				for (auto& local : per_thread) {
+					found += std::exchange(local.found, 0);
+					unexplored -= std::exchange(local.explored, 0);
+				}
+				if (bottom_up) {
+					std::swap(frontier_bits, next_bits);
+					// Go back to top-down once the frontier is small again
+					if (found == 0 or found * beta < n) {
+						bottom_up = false;
+						frontier.clear();
+						for (auto word = std::size_t{0}; word < frontier_bits.size(); ++word) {
+							for (auto bits = frontier_bits[word]; bits != 0; bits &= bits - 1) {
+								frontier.push_back(static_cast<node_id>(word * word_bits) + static_cast<node_id>(std::countr_zero(bits)));
+							}
+						}
+					}
+				}
+				else {
+					frontier.clear();
+					for (auto& local : per_thread) {
+						frontier.insert(frontier.end(), local.next.begin(), local.next.end());
+						local.next.clear();
+					}
+				}
+			}
+
+			auto result = std::vector<std::pair<N, std::size_t>>();
+			for (const auto& [value, id] : g.state_->index) {
+				if (levels[id] != unreached) {
+					result.emplace_back(value, levels[id]);
+				}
+			}
+			return result;
+		}
+
+		// Cost of the cheapest path from src to every reachable node, by Dijkstra
+		static auto shortest_paths(graph_type const& g, N const& src, E const& unit_cost) -> std::vector<std::pair<N, E>> {
+			check_cost(unit_cost, "shortest_paths");
+			const auto search = dijkstra(g, id_of(g, src, "shortest_paths"), unit_cost, std::nullopt, "shortest_paths");
+			auto result = std::vector<std::pair<N, E>>();
+			for (const auto& [value, id] : g.state_->index) {
+				if (search.state[id] == settled) {
+					result.emplace_back(value, search.dist[id]);
+				}
+			}
+			return result;
+		}
+
+		// Cheapest path from src to dst, by Dijkstra stopping as soon as dst is settled
+		static auto shortest_path(graph_type const& g, N const& src, N const& dst, E const& unit_cost)
+		   -> std::optional<weighted_path<N, E>> {
+			const auto src_it = g.state_->index.find(src);
+			const auto dst_it = g.state_->index.find(dst);
+			if (src_it == g.state_->index.end() or dst_it == g.state_->index.end()) {
+				throw std::runtime_error("Cannot call gdwg::shortest_path if src or dst doesn't exist in the graph");
+			}
+			check_cost(unit_cost, "shortest_path");
+			const auto target = dst_it->second;
+			const auto search = dijkstra(g, src_it->second, unit_cost, target, "shortest_path");
+			if (search.state[target] != settled) {
+				return std::nullopt;
+			}
+			auto path = weighted_path<N, E>{search.dist[target], {}};
+			for (auto id = target; id != none; id = search.parent[id]) {
+				path.nodes.push_back(g.value_of(id));
+			}
+			std::reverse(path.nodes.begin(), path.nodes.end());
+			return path;
+		}
+
+		// Cost of the cheapest path from src to every reachable node, by parallel delta-stepping
+		static auto parallel_shortest_paths(graph_type const& g, N const& src, E const& unit_cost, E delta, std::size_t threads)
+		   -> std::vector<std::pair<N, E>> {
+			static_assert(std::is_trivially_copyable_v<E> and std::numeric_limits<E>::is_specialized,
+			              "parallel_shortest_paths needs an arithmetic-like E to update distances atomically");
+			if (threads == 0) {
+				threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+			}
+			const auto src_id = id_of(g, src, "parallel_shortest_paths");
+			check_cost(unit_cost, "parallel_shortest_paths");
+
+			// Workers cannot throw, so every cost is checked up front. The same pass picks a default delta:
+			// the largest cost divided by the average out-degree.
+			const auto n = slot_count(g);
+			auto max_cost = E{};
+			auto edges = std::size_t{0};
+			auto live = std::size_t{0};
+			for (auto id = node_id{0}; id < n; ++id) {
+				if (!is_live(g, id)) {
+					continue;
+				}
+				++live;
+				for (const auto& record : g.edges_of(id).outgoing) {
+					const auto cost = record.weight ? *record.weight : unit_cost;
+					check_cost(cost, "parallel_shortest_paths");
+					max_cost = std::max(max_cost, cost);
+					++edges;
+				}
+			}
+			if (!(E{} < delta)) {
+				delta = edges == 0 ? E{1}
+				                   : static_cast<E>(static_cast<double>(max_cost) * static_cast<double>(live) / static_cast<double>(edges));
+				if (!(E{} < delta)) {
+					delta = E{1};
+				}
+			}
+
+			const auto infinity = std::numeric_limits<E>::max();
+			auto dist = std::vector<std::atomic<E>>(n);
+			for (auto& d : dist) {
+				d.store(infinity, std::memory_order_relaxed);
+			}
+			const auto bucket_of = [&delta](E const& d) { return static_cast<std::size_t>(d / delta); };
+
+			// Buckets are sparse, since distances / delta can be far larger than the number of nodes
+			auto buckets = std::map<std::size_t, std::vector<node_id>>();
+			auto per_thread = std::vector<std::vector<node_id>>(threads);
+			const auto relax = [&](std::vector<node_id> const& from, bool light) {
+				run_parallel(threads, from.size(), 1, [&](std::size_t t, std::size_t begin, std::size_t end) {
+					for (auto i = begin; i < end; ++i) {
+						const auto base = dist[from[i]].load(std::memory_order_relaxed);
+						for (const auto& record : g.edges_of(from[i]).outgoing) {
+							const auto cost = record.weight ? *record.weight : unit_cost;
+							if ((cost <= delta) == light and atomic_min(dist[record.node], base + cost)) {
+								per_thread[t].push_back(record.node);
+							}
+						}
+					}
+				});
+				for (auto& improved : per_thread) {
+					for (const auto id : improved) {
+						buckets[bucket_of(dist[id].load(std::memory_order_relaxed))].push_back(id);
+					}
+					improved.clear();
+				}
+			};
+
+			dist[src_id].store(E{}, std::memory_order_relaxed);
+			buckets[0].push_back(src_id);
+			auto frontier = std::vector<node_id>();
+			auto settled_here = std::vector<node_id>();
+			while (!buckets.empty()) {
+				const auto current = buckets.begin()->first;
+				settled_here.clear();
+
+				// Light edges can refill the current bucket, so it is emptied repeatedly
+				for (auto it = buckets.find(current); it != buckets.end(); it = buckets.find(current)) {
+					frontier = std::move(it->second);
+					buckets.erase(it);
+					std::erase_if(frontier, [&](node_id id) { return bucket_of(dist[id].load(std::memory_order_relaxed)) != current; });
+					std::sort(frontier.begin(), frontier.end());
+					frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+					settled_here.insert(settled_here.end(), frontier.begin(), frontier.end());
+					relax(frontier, true);
+				}
+
+				// Heavy edges always lead to later buckets, so they are relaxed once per settled node
+				std::sort(settled_here.begin(), settled_here.end());
+				settled_here.erase(std::unique(settled_here.begin(), settled_here.end()), settled_here.end());
+				relax(settled_here, false);
+			}
+
+			auto result = std::vector<std::pair<N, E>>();
+			for (const auto& [value, id] : g.state_->index) {
+				if (const auto d = dist[id].load(std::memory_order_relaxed); d != infinity) {
+					result.emplace_back(value, d);
+				}
+			}
+			return result;
+		}
+
+	private:
+		static constexpr auto word_bits = std::size_t{64};
+		static constexpr auto unreached = std::numeric_limits<std::uint32_t>::max();
+		// Direction switching thresholds from Beamer et al., "Direction-Optimizing Breadth-First Search"
+		static constexpr auto alpha = std::size_t{14};
+		static constexpr auto beta = std::size_t{24};
+
+		// One bit per node id
+		class visited_set {
+		public:
+			explicit visited_set(std::size_t n) : words_(word_count(n), 0) {}
+
+			// Marks id, returns whether it was unmarked before
+			auto insert(node_id id) noexcept -> bool {
+				auto& word = words_[id / word_bits];
+				const auto mask = bit(id);
+				if ((word & mask) != 0) {
+					return false;
+				}
+				word |= mask;
+				return true;
+			}
+
+		private:
+			std::vector<std::uint64_t> words_;
+		};
+
+		static constexpr auto none = std::numeric_limits<node_id>::max();
+		static constexpr auto unseen = std::uint8_t{0};
+		static constexpr auto queued = std::uint8_t{1};
+		static constexpr auto settled = std::uint8_t{2};
+
+		// Distances and shortest path tree of a Dijkstra search. dist and parent are only meaningful
+		// for nodes that are not unseen.
+		struct search_result {
+			std::vector<E> dist;
+			std::vector<node_id> parent;
+			std::vector<std::uint8_t> state;
+		};
+
+		// Pairing heap of node ids keyed by an external distance array, with decrease-key.
+		// Links are stored per id, so the heap never allocates after construction.
+		class pairing_heap {
+		public:
+			pairing_heap(std::vector<E> const& keys, std::size_t n)
+			: keys_(keys), child_(n, none), sibling_(n, none), prev_(n, none) {
+				pairs_.reserve(n);
+			}
+
+			auto empty() const noexcept -> bool {
+				return root_ == none;
+			}
+
+			auto push(node_id id) noexcept -> void {
+				root_ = root_ == none ? id : meld(root_, id);
+			}
+
+			// Precondition: id is in the heap and its key has just decreased
+			auto decrease(node_id id) noexcept -> void {
+				if (id == root_) {
+					return;
+				}
+				const auto parent = prev_[id];
+				if (child_[parent] == id) {
+					child_[parent] = sibling_[id];
+				}
+				else {
+					sibling_[parent] = sibling_[id];
+				}
+				if (sibling_[id] != none) {
+					prev_[sibling_[id]] = parent;
+				}
+				sibling_[id] = none;
+				prev_[id] = none;
+				root_ = meld(root_, id);
+			}
+
+			// Precondition: !empty()
+			auto pop() noexcept -> node_id {
+				const auto top = root_;
+
+				// Two-pass pairing: meld the children in pairs left to right, then fold right to left
+				pairs_.clear();
+				for (auto first = child_[top]; first != none;) {
+					const auto second = sibling_[first];
+					const auto next = second == none ? none : sibling_[second];
+					sibling_[first] = prev_[first] = none;
+					if (second != none) {
+						sibling_[second] = prev_[second] = none;
+						pairs_.push_back(meld(first, second));
+					}
+					else {
+						pairs_.push_back(first);
+					}
+					first = next;
+				}
+				child_[top] = none;
+				root_ = none;
+				for (auto it = pairs_.rbegin(); it != pairs_.rend(); ++it) {
+					root_ = root_ == none ? *it : meld(*it, root_);
+				}
+				return top;
+			}
+
+		private:
+			// Makes the root with the larger key the first child of the other, returns the new root
+			auto meld(node_id a, node_id b) noexcept -> node_id {
+				if (keys_[b] < keys_[a]) {
+					std::swap(a, b);
+				}
+				sibling_[b] = child_[a];
+				if (child_[a] != none) {
+					prev_[child_[a]] = b;
+				}
+				prev_[b] = a;
+				child_[a] = b;
+				return a;
+			}
+
+			std::vector<E> const& keys_;
+			std::vector<node_id> child_;
+			std::vector<node_id> sibling_;
+			// Left sibling, or parent for a first child
+			std::vector<node_id> prev_;
+			std::vector<node_id> pairs_;
+			node_id root_ = none;
+		};
+
+		static auto check_cost(E const& cost, char const* caller) -> void {
+			if (cost < E{}) {
+				throw std::runtime_error(std::string("Cannot call gdwg::") + caller + " on a graph with negative edge costs");
+			}
+		}
+
+		// Lowers target to value if value is smaller, returns whether it did
+		static auto atomic_min(std::atomic<E>& target, E const& value) noexcept -> bool {
+			auto current = target.load(std::memory_order_relaxed);
+			while (value < current) {
+				if (target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Settles nodes in increasing distance from src, until target is settled if there is one.
+		// Of several edges to the same node only the cheapest can improve it: records are sorted
+		// unweighted first, then by weight, so every weighted record after the first is skipped.
+		static auto dijkstra(graph_type const& g, node_id src, E const& unit_cost, std::optional<node_id> target,
+		                     char const* caller) -> search_result {
+			const auto n = slot_count(g);
+			auto search = search_result{std::vector<E>(n), std::vector<node_id>(n, none), std::vector<std::uint8_t>(n, unseen)};
+			auto heap = pairing_heap(search.dist, n);
+			search.dist[src] = E{};
+			search.state[src] = queued;
+			heap.push(src);
+			while (!heap.empty()) {
+				const auto from = heap.pop();
+				search.state[from] = settled;
+				if (target == from) {
+					break;
+				}
+				const auto& outgoing = g.edges_of(from).outgoing;
+				for (auto it = outgoing.begin(); it != outgoing.end(); ++it) {
+					if (it != outgoing.begin() and std::prev(it)->node == it->node and std::prev(it)->weight and it->weight) {
+						continue;
+					}
+					const auto cost = it->weight ? *it->weight : unit_cost;
+					check_cost(cost, caller);
+					const auto to = it->node;
+					if (search.state[to] == settled) {
+						continue;
+					}
+					const auto candidate = search.dist[from] + cost;
+					if (search.state[to] == unseen) {
+						search.dist[to] = candidate;
+						search.parent[to] = from;
+						search.state[to] = queued;
+						heap.push(to);
+					}
+					else if (candidate < search.dist[to]) {
+						search.dist[to] = candidate;
+						search.parent[to] = from;
+						heap.decrease(to);
+					}
+				}
+			}
+			return search;
+		}
+
+		// Per-thread results of one BFS level, reset by the caller after each level
+		struct thread_frontier {
+			std::vector<node_id> next;
+			std::size_t found = 0;
+			std::size_t explored = 0;
+		};
+
+		static auto word_count(std::size_t n) noexcept -> std::size_t {
+			return (n + word_bits - 1) / word_bits;
+		}
+
+		static auto bit(node_id id) noexcept -> std::uint64_t {
+			return std::uint64_t{1} << (id % word_bits);
+		}
+
+		static auto slot_count(graph_type const& g) noexcept -> std::size_t {
+			return g.state_->nodes.size();
+		}
+
+		static auto is_live(graph_type const& g, node_id id) noexcept -> bool {
+			return g.state_->nodes[id].value != nullptr;
+		}
+
+		static auto id_of(graph_type const& g, N const& value, char const* caller) -> node_id {
+			const auto it = g.state_->index.find(value);
+			if (it == g.state_->index.end()) {
+				throw std::runtime_error(std::string("Cannot call gdwg::") + caller + " if src doesn't exist in the graph");
+			}
+			return it->second;
+		}
+
+		static auto values_of(graph_type const& g, std::vector<node_id> const& ids) -> std::vector<N> {
+			auto values = std::vector<N>();
+			values.reserve(ids.size());
+			for (const auto id : ids) {
+				values.push_back(g.value_of(id));
+			}
+			return values;
+		}
+
+		// Expands every frontier node's outgoing edges. Nodes are claimed with an atomic bit so that
+		// each one is added to exactly one thread's next frontier.
+		static auto top_down_step(graph_type const& g, std::uint32_t level, std::size_t threads,
+		                          std::vector<node_id> const& frontier, std::vector<std::atomic<std::uint64_t>>& visited,
+		                          std::vector<std::uint32_t>& levels, std::vector<thread_frontier>& per_thread) -> void {
+			run_parallel(threads, frontier.size(), 1, [&](std::size_t t, std::size_t begin, std::size_t end) {
+				auto& local = per_thread[t];
+				for (auto i = begin; i < end; ++i) {
+					for (const auto& record : g.edges_of(frontier[i]).outgoing) {
+						const auto id = record.node;
+						auto& word = visited[id / word_bits];
+						if ((word.load(std::memory_order_relaxed) & bit(id)) != 0
+						    or (word.fetch_or(bit(id), std::memory_order_relaxed) & bit(id)) != 0) {
+							continue;
+						}
+						levels[id] = level;
+						local.next.push_back(id);
+						++local.found;
+						local.explored += g.edges_of(id).outgoing.size();
+					}
+				}
+			});
+		}
+
+		// Every unvisited node looks for a parent in the frontier through its incoming edges. Threads
+		// own whole words of ids, so the visited and next frontier words are never written concurrently.
+		static auto bottom_up_step(graph_type const& g, std::uint32_t level, std::size_t threads,
+		                           std::vector<std::uint64_t> const& frontier_bits, std::vector<std::uint64_t>& next_bits,
+		                           std::vector<std::atomic<std::uint64_t>>& visited, std::vector<std::uint32_t>& levels,
+		                           std::vector<thread_frontier>& per_thread) -> void {
+			const auto n = slot_count(g);
+			run_parallel(threads, n, word_bits, [&](std::size_t t, std::size_t begin, std::size_t end) {
+				auto& local = per_thread[t];
+				for (auto i = begin; i < end; ++i) {
+					const auto id = static_cast<node_id>(i);
+					auto& word = visited[id / word_bits];
+					if ((word.load(std::memory_order_relaxed) & bit(id)) != 0 or !is_live(g, id)) {
+						continue;
+					}
+					const auto& incoming = g.edges_of(id).incoming;
+					const auto has_parent = std::any_of(incoming.begin(), incoming.end(), [&frontier_bits](const auto& record) {
+						return (frontier_bits[record.node / word_bits] & bit(record.node)) != 0;
+					});
+					if (has_parent) {
+						word.fetch_or(bit(id), std::memory_order_relaxed);
+						next_bits[id / word_bits] |= bit(id);
+						levels[id] = level;
+						++local.found;
+						local.explored += g.edges_of(id).outgoing.size();
+					}
+				}
+			});
+		}
+	};
+
+	/**
+	* Returns: Every node reachable from src, in breadth-first order, starting with src.
+	* Neighbours of a node are visited in increasing order. src counts as reachable from itself.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::bfs if src doesn't exist in the graph") if is_node(src) is false.
+	*
+	* Complexity: O(n + e), where n is the number of stored nodes and e the number of stored edges.
+	*/
+	template<typename N, typename E>
+	auto bfs(graph<N, E> const& g, std::type_identity_t<N> const& src) -> std::vector<N> {
+		return graph_traversal<N, E>::bfs(g, std::initializer_list<N>{src}, "bfs");
+	}
+
+	/**
+	* Effects: Multi-source breadth-first search, as if every node in sources were src at distance 0.
+	*
+	* Returns: Every node reachable from any of sources, in breadth-first order, starting with
+	* sources themselves in the given order. Repeated sources are only visited once.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::bfs if src doesn't exist in the graph") if any source is not a node.
+	*
+	* Complexity: O(n + e + s log(n)), where s is the number of sources.
+	*/
+	template<typename N, typename E, std::ranges::input_range NodeRange>
+	requires (!std::convertible_to<NodeRange const&, N const&>)
+	auto bfs(graph<N, E> const& g, NodeRange const& sources) -> std::vector<N> {
+		return graph_traversal<N, E>::bfs(g, sources, "bfs");
+	}
+
+	/**
+	* Returns: Every node reachable from src, in depth-first preorder, starting with src.
+	* Neighbours of a node are visited in increasing order.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::dfs if src doesn't exist in the graph") if is_node(src) is false.
+	*
+	* Complexity: O(n + e)
+	*/
+	template<typename N, typename E>
+	auto dfs(graph<N, E> const& g, std::type_identity_t<N> const& src) -> std::vector<N> {
+		return graph_traversal<N, E>::dfs(g, src);
+	}
+
+	/**
+	* Returns: Every node reachable from src, including src, in increasing order.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::reachable if src doesn't exist in the graph") if is_node(src) is false.
+	*
+	* Complexity: O(n + e + r log(r)), where r is the number of reachable nodes.
+	*/
+	template<typename N, typename E>
+	auto reachable(graph<N, E> const& g, std::type_identity_t<N> const& src) -> std::vector<N> {
+		return graph_traversal<N, E>::reachable(g, src);
+	}
+
+	/**
+	* Effects: Multi-source breadth-first search spread over threads threads, or one per core if threads is 0.
+	* Each level is expanded either top-down, through the frontier's outgoing edges, or bottom-up, through
+	* the unvisited nodes' incoming edges, whichever is expected to check fewer edges. Graphs whose incoming
+	* index is deferred are only expanded top-down.
+	*
+	* Returns: Every node reachable from any of sources, in increasing order, paired with its number of hops
+	* from the nearest source. Sources are at distance 0.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::parallel_bfs if src doesn't exist in the graph") if any source is not a node.
+	*
+	* Complexity: O(n + e) work, spread over the threads level by level.
+	*/
+	template<typename N, typename E, std::ranges::input_range NodeRange>
+	auto parallel_bfs(graph<N, E> const& g, NodeRange const& sources, std::size_t threads = 0)
+	   -> std::vector<std::pair<N, std::size_t>> {
+		return graph_traversal<N, E>::parallel_bfs(g, sources, threads);
+	}
+
+	/**
+	* Effects: Finds the cheapest path from src to every node reachable from it, using Dijkstra's algorithm
+	* with a pairing heap. A weighted edge costs its weight and an unweighted edge costs unit_cost.
+	* Of several edges between the same pair of nodes only the cheapest is considered.
+	*
+	* Returns: Every node reachable from src, in increasing order, paired with the cost of its cheapest path.
+	* src is paired with E{}.
+	*
+	* Throws:
+	* - std::runtime_error("Cannot call gdwg::shortest_paths if src doesn't exist in the graph") if is_node(src) is false.
+	* - std::runtime_error("Cannot call gdwg::shortest_paths on a graph with negative edge costs") if unit_cost,
+	* or the cost of an edge reached by the search, is negative.
+	*
+	* Complexity: O(e + n log(n)) amortised.
+	*/
+	template<typename N, typename E>
+	auto shortest_paths(graph<N, E> const& g, std::type_identity_t<N> const& src, std::type_identity_t<E> const& unit_cost = E{1})
+	   -> std::vector<std::pair<N, E>> {
+		return graph_traversal<N, E>::shortest_paths(g, src, unit_cost);
+	}
+
+	/**
+	* Effects: Finds the cheapest path from src to dst, as shortest_paths does, but stops once dst is reached.
+	*
+	* Returns: The cost and nodes of the cheapest path, starting with src and ending with dst,
+	* or std::nullopt if dst is not reachable from src.
+	*
+	* Throws:
+	* - std::runtime_error("Cannot call gdwg::shortest_path if src or dst doesn't exist in the graph")
+	* if either of is_node(src) or is_node(dst) is false.
+	* - std::runtime_error("Cannot call gdwg::shortest_path on a graph with negative edge costs") if unit_cost,
+	* or the cost of an edge reached by the search, is negative.
+	*
+	* Complexity: O(e + n log(n)) amortised.
+	*/
+	template<typename N, typename E>
+	auto shortest_path(graph<N, E> const& g,
+	                   std::type_identity_t<N> const& src,
+	                   std::type_identity_t<N> const& dst,
+	                   std::type_identity_t<E> const& unit_cost = E{1}) -> std::optional<weighted_path<N, E>> {
+		return graph_traversal<N, E>::shortest_path(g, src, dst, unit_cost);
+	}
+
+	/**
+	* Effects: Computes the same costs as shortest_paths with delta-stepping, relaxing each bucket's edges
+	* over threads threads, or one per core if threads is 0. Nodes whose cost lies in [i * delta, (i + 1) * delta)
+	* form bucket i. If delta is not positive, the largest edge cost divided by the average out-degree is used.
+	* E must be trivially copyable and have std::numeric_limits, since distances are updated atomically.
+	*
+	* Returns: Every node reachable from src, in increasing order, paired with the cost of its cheapest path.
+	*
+	* Throws:
+	* - std::runtime_error("Cannot call gdwg::parallel_shortest_paths if src doesn't exist in the graph") if is_node(src) is false.
+	* - std::runtime_error("Cannot call gdwg::parallel_shortest_paths on a graph with negative edge costs") if unit_cost,
+	* or the cost of any edge in the graph, is negative.
+	*/
+	template<typename N, typename E>
+	auto parallel_shortest_paths(graph<N, E> const& g,
+	                             std::type_identity_t<N> const& src,
+	                             std::type_identity_t<E> const& unit_cost = E{1},
+	                             std::type_identity_t<E> const& delta = E{},
+	                             std::size_t threads = 0) -> std::vector<std::pair<N, E>> {
+		return graph_traversal<N, E>::parallel_shortest_paths(g, src, unit_cost, delta, threads);
+	}
+} // namespace gdwg
+
+#endif // GDWG_ALGORITHMS_H
@@ -0,0 +1,193 @@
+#include "gdwg_algorithms.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+	// a → b → d, a → c → d, d → a, e isolated, f → e
+	auto make_diamond() -> gdwg::graph<std::string, int> {
+		auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e", "f"};
+		g.insert_edge("a", "c", 2);
+		g.insert_edge("a", "b", 1);
+		g.insert_edge("a", "b", 5);
+		g.insert_edge("b", "d");
+		g.insert_edge("c", "d", 3);
+		g.insert_edge("d", "a", 4);
+		g.insert_edge("c", "c", 1);
+		g.insert_edge("f", "e");
+		return g;
+	}
+
+	// Hop distances by repeated single-threaded bfs layers, as a reference for parallel_bfs
+	auto reference_distances(gdwg::graph<int, int> const& g, std::vector<int> const& sources)
+	   -> std::vector<std::pair<int, std::size_t>> {
+		auto result = std::vector<std::pair<int, std::size_t>>();
+		for (auto const& node : gdwg::bfs(g, sources)) {
+			auto distance = std::size_t{0};
+			auto frontier = sources;
+			auto seen = std::vector<int>(sources);
+			while (std::find(frontier.begin(), frontier.end(), node) == frontier.end()) {
+				auto next = std::vector<int>();
+				for (auto const& from : frontier) {
+					for (auto const& to : g.connections(from)) {
+						if (std::find(seen.begin(), seen.end(), to) == seen.end()) {
+							seen.push_back(to);
+							next.push_back(to);
+						}
+					}
+				}
+				frontier = next;
+				++distance;
+			}
+			result.emplace_back(node, distance);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+} // namespace
+
+TEST_CASE("bfs visits nodes level by level in increasing order") {
+	auto const g = make_diamond();
+	REQUIRE(gdwg::bfs(g, "a") == std::vector<std::string>{"a", "b", "c", "d"});
+	REQUIRE(gdwg::bfs(g, "d") == std::vector<std::string>{"d", "a", "b", "c"});
+	REQUIRE(gdwg::bfs(g, "e") == std::vector<std::string>{"e"});
+
+	SECTION("Multiple sources") {
+		auto const sources = std::vector<std::string>{"f", "c", "f"};
+		REQUIRE(gdwg::bfs(g, sources) == std::vector<std::string>{"f", "c", "e", "d", "a", "b"});
+	}
+
+	SECTION("Missing source") {
+		REQUIRE_THROWS_WITH(gdwg::bfs(g, "z"), "Cannot call gdwg::bfs if src doesn't exist in the graph");
+		REQUIRE_THROWS_AS(gdwg::bfs(g, std::vector<std::string>{"a", "z"}), std::runtime_error);
+	}
+}
+
+TEST_CASE("dfs visits nodes in preorder") {
+	auto g = make_diamond();
+	REQUIRE(gdwg::dfs(g, "a") == std::vector<std::string>{"a", "b", "d", "c"});
+	REQUIRE(gdwg::dfs(g, "f") == std::vector<std::string>{"f", "e"});
+	g.insert_edge("b", "e");
+	REQUIRE(gdwg::dfs(g, "a") == std::vector<std::string>{"a", "b", "d", "e", "c"});
+	REQUIRE_THROWS_WITH(gdwg::dfs(g, "z"), "Cannot call gdwg::dfs if src doesn't exist in the graph");
+}
+
+TEST_CASE("reachable returns the sorted set of reachable nodes") {
+	auto g = make_diamond();
+	REQUIRE(gdwg::reachable(g, "c") == std::vector<std::string>{"a", "b", "c", "d"});
+	REQUIRE(gdwg::reachable(g, "f") == std::vector<std::string>{"e", "f"});
+
+	SECTION("Erased and reinserted nodes") {
+		g.erase_node("b");
+		g.erase_node("d");
+		REQUIRE(gdwg::reachable(g, "a") == std::vector<std::string>{"a", "c"});
+		g.insert_node("g");
+		g.insert_edge("c", "g");
+		REQUIRE(gdwg::reachable(g, "a") == std::vector<std::string>{"a", "c", "g"});
+	}
+	REQUIRE_THROWS_WITH(gdwg::reachable(g, "z"), "Cannot call gdwg::reachable if src doesn't exist in the graph");
+}
+
+TEST_CASE("parallel_bfs matches sequential bfs distances") {
+	auto const diamond = make_diamond();
+	auto const expected = std::vector<std::pair<std::string, std::size_t>>{{"a", 0}, {"b", 1}, {"c", 1}, {"d", 2}};
+	REQUIRE(gdwg::parallel_bfs(diamond, std::vector<std::string>{"a"}, 1) == expected);
+	REQUIRE(gdwg::parallel_bfs(diamond, std::vector<std::string>{"a"}, 3) == expected);
+	REQUIRE_THROWS_WITH(gdwg::parallel_bfs(diamond, std::vector<std::string>{"z"}),
+	                    "Cannot call gdwg::parallel_bfs if src doesn't exist in the graph");
+
+	// Dense enough that some levels run bottom-up, with erased nodes leaving holes in the ids
+	auto rng = std::mt19937(6771);
+	auto pick = std::uniform_int_distribution<int>(0, 299);
+	auto g = gdwg::graph<int, int>();
+	for (auto i = 0; i < 300; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 0; i < 1500; ++i) {
+		g.insert_edge(pick(rng), pick(rng), i % 3 == 0 ? std::nullopt : std::optional<int>(i));
+	}
+	for (auto i = 0; i < 300; i += 7) {
+		g.erase_node(i);
+	}
+	for (auto const& sources : {std::vector<int>{1}, std::vector<int>{2, 5, 2}, std::vector<int>{299}}) {
+		auto const reference = reference_distances(g, sources);
+		for (auto const threads : {std::size_t{1}, std::size_t{2}, std::size_t{4}}) {
+			REQUIRE(gdwg::parallel_bfs(g, sources, threads) == reference);
+		}
+	}
+
+	// Without an incoming index every level runs top-down
+	auto deferred = g;
+	deferred.defer_incoming_index();
+	REQUIRE(gdwg::parallel_bfs(deferred, std::vector<int>{2, 5}, 2) == reference_distances(g, std::vector<int>{2, 5}));
+}
+
+TEST_CASE("shortest_paths uses the cheapest edge between each pair") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e"};
+	g.insert_edge("a", "b", 7);
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("a", "c", 9);
+	g.insert_edge("b", "c", 3);
+	g.insert_edge("c", "d");
+	g.insert_edge("b", "d", 10);
+	g.insert_edge("d", "a", 1);
+
+	auto const expected = std::vector<std::pair<std::string, int>>{{"a", 0}, {"b", 2}, {"c", 5}, {"d", 6}};
+	REQUIRE(gdwg::shortest_paths(g, "a") == expected);
+
+	SECTION("Unweighted edges cost unit_cost") {
+		auto const costly = std::vector<std::pair<std::string, int>>{{"a", 0}, {"b", 2}, {"c", 5}, {"d", 12}};
+		REQUIRE(gdwg::shortest_paths(g, "a", 100) == costly);
+		auto const free = std::vector<std::pair<std::string, int>>{{"a", 1}, {"b", 3}, {"c", 6}, {"d", 0}};
+		REQUIRE(gdwg::shortest_paths(g, "d", 0) == free);
+	}
+
+	SECTION("shortest_path returns the path itself") {
+		auto const path = gdwg::shortest_path(g, "a", "d");
+		REQUIRE(path.has_value());
+		REQUIRE(*path == gdwg::weighted_path<std::string, int>{6, {"a", "b", "c", "d"}});
+		REQUIRE(gdwg::shortest_path(g, "c", "c") == gdwg::weighted_path<std::string, int>{0, {"c"}});
+		REQUIRE_FALSE(gdwg::shortest_path(g, "a", "e").has_value());
+		REQUIRE_THROWS_WITH(gdwg::shortest_path(g, "a", "z"),
+		                    "Cannot call gdwg::shortest_path if src or dst doesn't exist in the graph");
+	}
+
+	SECTION("Negative costs are rejected") {
+		g.insert_edge("c", "e", -1);
+		REQUIRE(gdwg::shortest_paths(g, "e") == std::vector<std::pair<std::string, int>>{{"e", 0}});
+		REQUIRE_THROWS_WITH(gdwg::shortest_paths(g, "a"), "Cannot call gdwg::shortest_paths on a graph with negative edge costs");
+		REQUIRE_THROWS_AS(gdwg::shortest_paths(g, "e", -1), std::runtime_error);
+		REQUIRE_THROWS_AS(gdwg::parallel_shortest_paths(g, "e"), std::runtime_error);
+	}
+	REQUIRE_THROWS_WITH(gdwg::shortest_paths(g, "z"), "Cannot call gdwg::shortest_paths if src doesn't exist in the graph");
+}
+
+TEST_CASE("parallel_shortest_paths matches shortest_paths") {
+	auto rng = std::mt19937(6771);
+	auto pick = std::uniform_int_distribution<int>(0, 199);
+	auto weight = std::uniform_int_distribution<int>(0, 50);
+	auto g = gdwg::graph<int, double>();
+	for (auto i = 0; i < 200; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 0; i < 1200; ++i) {
+		g.insert_edge(pick(rng), pick(rng), i % 5 == 0 ? std::nullopt : std::optional<double>(weight(rng) / 4.0));
+	}
+	for (auto i = 3; i < 200; i += 11) {
+		g.erase_node(i);
+	}
+	for (auto const src : {0, 1, 150}) {
+		auto const expected = gdwg::shortest_paths(g, src, 2.5);
+		REQUIRE(std::find(expected.begin(), expected.end(), std::pair<int, double>{src, 0.0}) != expected.end());
+		REQUIRE(expected.size() > 1);
+		for (auto const delta : {0.0, 0.5, 4.0, 1000.0}) {
+			for (auto const threads : {std::size_t{1}, std::size_t{3}}) {
+				REQUIRE(gdwg::parallel_shortest_paths(g, src, 2.5, delta, threads) == expected);
+			}
+		}
+	}
+}
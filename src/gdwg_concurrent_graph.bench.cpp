@@ -0,0 +1,157 @@
+#include "gdwg_concurrent_graph.h"
+#include "gdwg_graph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Throughput benchmark for gdwg::concurrent_graph against gdwg::graph behind one std::shared_mutex.
+//
+// Usage: gdwg_concurrent_graph_bench [--nodes N] [--ops N] [--max-threads N] [--read-percent N] [--seed N]
+//
+// Each thread issues --ops operations on random node pairs: is_connected and connections
+// in the read share, insert_edge and erase_edge in equal parts of the rest. Thread counts
+// double from 1 to --max-threads. Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+namespace {
+	using clock_type = std::chrono::steady_clock;
+
+	struct options {
+		std::size_t nodes = 10000;
+		std::size_t ops = 200000;
+		std::size_t max_threads = 64;
+		std::size_t read_percent = 90;
+		std::uint64_t seed = 6771;
+	};
+
+	// The baseline: every reader takes the global lock shared and every writer takes it exclusively
+	class locked_graph {
+	public:
+		auto insert_node(int value) -> void {
+			const auto lock = std::unique_lock(mutex_);
+			g_.insert_node(value);
+		}
+
+		auto insert_edge(int src, int dst, int weight) -> bool {
+			const auto lock = std::unique_lock(mutex_);
+			return g_.insert_edge(src, dst, weight);
+		}
+
+		auto erase_edge(int src, int dst, int weight) -> bool {
+			const auto lock = std::unique_lock(mutex_);
+			return g_.erase_edge(src, dst, weight);
+		}
+
+		auto is_connected(int src, int dst) const -> bool {
+			const auto lock = std::shared_lock(mutex_);
+			return g_.is_connected(src, dst);
+		}
+
+		auto connections(int src) const -> std::vector<int> {
+			const auto lock = std::shared_lock(mutex_);
+			return g_.connections(src);
+		}
+
+	private:
+		mutable std::shared_mutex mutex_;
+		gdwg::graph<int, int> g_;
+	};
+
+	// Loads every node and an average out-degree of 8, then runs the mixed workload on threads threads
+	template<typename Graph>
+	auto run(options const& opts, std::size_t threads) -> double {
+		auto g = Graph();
+		auto const n = static_cast<int>(opts.nodes);
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937_64(opts.seed);
+		auto pick = std::uniform_int_distribution<int>(0, n - 1);
+		for (std::size_t i = 0; i < 8 * opts.nodes; ++i) {
+			g.insert_edge(pick(rng), pick(rng), pick(rng) % 100);
+		}
+
+		auto sink = std::vector<std::size_t>(threads);
+		auto workers = std::vector<std::thread>();
+		auto const start = clock_type::now();
+		for (std::size_t t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t] {
+				auto local = std::mt19937_64(opts.seed + t + 1);
+				auto node = std::uniform_int_distribution<int>(0, n - 1);
+				auto percent = std::uniform_int_distribution<std::size_t>(0, 99);
+				auto count = std::size_t{0};
+				for (std::size_t i = 0; i < opts.ops; ++i) {
+					auto const src = node(local);
+					auto const dst = node(local);
+					auto const roll = percent(local);
+					if (roll < opts.read_percent / 2) {
+						count += g.is_connected(src, dst) ? 1U : 0U;
+					} else if (roll < opts.read_percent) {
+						count += g.connections(src).size();
+					} else if (roll % 2 == 0) {
+						count += g.insert_edge(src, dst, dst % 100) ? 1U : 0U;
+					} else {
+						count += g.erase_edge(src, dst, dst % 100) ? 1U : 0U;
+					}
+				}
+				sink[t] = count;
+			});
+		}
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		auto const seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+		if (std::all_of(sink.begin(), sink.end(), [](std::size_t c) { return c == 0; })) {
+			std::cerr << "empty checksum\n";
+		}
+		return seconds > 0.0 ? static_cast<double>(threads * opts.ops) / seconds : 0.0;
+	}
+
+	auto parse_options(int argc, char** argv) -> options {
+		auto opts = options{};
+		for (int i = 1; i + 1 < argc; i += 2) {
+			auto const flag = std::string_view(argv[i]);
+			auto const value = std::strtoull(argv[i + 1], nullptr, 10);
+			if (flag == "--nodes") {
+				opts.nodes = std::max<std::size_t>(1, value);
+			} else if (flag == "--ops") {
+				opts.ops = value;
+			} else if (flag == "--max-threads") {
+				opts.max_threads = std::max<std::size_t>(1, value);
+			} else if (flag == "--read-percent") {
+				opts.read_percent = std::min<std::size_t>(100, value);
+			} else if (flag == "--seed") {
+				opts.seed = value;
+			} else {
+				std::cerr << "unknown option " << flag << "\n";
+				std::exit(EXIT_FAILURE);
+			}
+		}
+		return opts;
+	}
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+	auto const opts = parse_options(argc, argv);
+	std::cout << opts.nodes << " nodes, " << 8 * opts.nodes << " edges, " << opts.ops << " ops per thread, "
+	          << opts.read_percent << "% reads, " << std::thread::hardware_concurrency() << " hardware threads\n";
+	std::cout << std::setw(8) << "threads" << std::setw(20) << "global lock ops/s" << std::setw(20)
+	          << "concurrent ops/s" << std::setw(10) << "ratio\n";
+	for (std::size_t threads = 1; threads <= opts.max_threads; threads *= 2) {
+		auto const locked = run<locked_graph>(opts, threads);
+		auto const striped = run<gdwg::concurrent_graph<int, int>>(opts, threads);
+		std::cout << std::setw(8) << threads << std::setw(20) << std::fixed << std::setprecision(0) << locked
+		          << std::setw(20) << striped << std::setw(9) << std::setprecision(2)
+		          << (locked > 0.0 ? striped / locked : 0.0) << "\n";
+	}
+	return EXIT_SUCCESS;
+}
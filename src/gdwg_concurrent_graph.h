@@ -0,0 +1,375 @@
+#ifndef GDWG_CONCURRENT_GRAPH_H
+#define GDWG_CONCURRENT_GRAPH_H
+#include "gdwg_graph.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	/**
+	* A directed weighted graph that can be read and modified from many threads at once, with the
+	* same edge semantics as gdwg::graph.
+	*
+	* Nodes are spread over a fixed number of index stripes by std::hash<N>, each behind its own
+	* std::shared_mutex, so node lookups only contend when they land on the same stripe. Every node
+	* then owns its adjacency behind a per-node std::shared_mutex: readers of src take its lock
+	* shared, and an edge mutation locks only its two endpoints (std::lock orders the pair, so
+	* writers never deadlock). Unrelated edges are inserted, erased and queried in parallel.
+	*
+	* Every member function is linearizable on its own. Whole-graph reads (nodes(), to_graph()) are
+	* weakly consistent: they see each node as of some moment during the call, not one global instant.
+	*
+	* Requires: std::hash<N> in addition to what gdwg::graph requires.
+	*/
+	template<typename N, typename E>
+	class concurrent_graph {
+		struct node_entry;
+
+		// Edge record stored in a node's adjacency lists. node is the other endpoint of the edge.
+		// While a record is in a list, its node is alive: erase_node unlinks every record pointing
+		// at a node before releasing it.
+		struct edge_record {
+			node_entry* node;
+			std::optional<E> weight;
+		};
+		using edge_list = std::vector<edge_record>;
+
+		struct node_entry : std::enable_shared_from_this<node_entry> {
+			explicit node_entry(N const& v)
+			: value(v) {}
+
+			N const value;
+			mutable std::shared_mutex mutex;
+			std::atomic<bool> erased = false;
+			edge_list outgoing;
+			edge_list incoming;
+		};
+		using entry_ptr = std::shared_ptr<node_entry>;
+
+		// One slice of the node index. Aligned so that stripes never share a cache line.
+		struct alignas(64) stripe {
+			mutable std::shared_mutex mutex;
+			std::map<N, entry_ptr> nodes;
+		};
+
+		static constexpr std::size_t num_stripes = 64;
+
+	public:
+		concurrent_graph() = default;
+
+		/**
+		* Effects: Constructs a concurrent_graph holding the nodes and edges of g.
+		* Complexity: O(n log n + e log e)
+		*/
+		explicit concurrent_graph(graph<N, E> const& g) {
+			for (const auto& value : g.nodes()) {
+				insert_node(value);
+			}
+			for (const auto& [src, dst, weight] : g) {
+				insert_edge(src, dst, weight);
+			}
+		}
+
+		// Threads share a concurrent_graph by reference, so it is neither copyable nor movable
+		concurrent_graph(concurrent_graph const&) = delete;
+		concurrent_graph(concurrent_graph&&) = delete;
+		auto operator=(concurrent_graph const&) -> concurrent_graph& = delete;
+		auto operator=(concurrent_graph&&) -> concurrent_graph& = delete;
+		~concurrent_graph() = default;
+
+		/**
+		* Effects: Adds a new node with value value if, and only if, there is no node equivalent to value already stored.
+		* Returns: true if the node is added and false otherwise.
+		* Complexity: O(log n), holding one stripe exclusively.
+		*/
+		auto insert_node(N const& value) -> bool {
+			auto& s = stripe_of(value);
+			const auto lock = std::unique_lock(s.mutex);
+			const auto [it, inserted] = s.nodes.try_emplace(value);
+			if (inserted) {
+				it->second = std::make_shared<node_entry>(value);
+			}
+			return inserted;
+		}
+
+		/**
+		* Effects: Adds a new edge src → dst with an optional weight, unless an equal edge already exists.
+		* Returns: true if the edge is added and false otherwise.
+		* Throws: std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::insert_edge when either src or dst node does not exist")
+		* if either src or dst is not stored, or is erased concurrently.
+		* Complexity: O(log n + e), holding src and dst exclusively.
+		*/
+		auto insert_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
+			const auto src_entry = find_entry(src);
+			const auto dst_entry = find_entry(dst);
+			if (!src_entry or !dst_entry) {
+				throw std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::insert_edge when either src or dst node does not exist");
+			}
+			const auto lock = lock_pair(*src_entry, *dst_entry);
+			if (src_entry->erased or dst_entry->erased) {
+				throw std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::insert_edge when either src or dst node does not exist");
+			}
+			auto out = edge_record{dst_entry.get(), std::move(weight)};
+			const auto out_pos = std::lower_bound(src_entry->outgoing.begin(), src_entry->outgoing.end(), out, record_less);
+			if (out_pos != src_entry->outgoing.end() and same_record(*out_pos, out)) {
+				return false;
+			}
+			auto const in = edge_record{src_entry.get(), out.weight};
+			src_entry->outgoing.insert(out_pos, std::move(out));
+			dst_entry->incoming.insert(std::lower_bound(dst_entry->incoming.begin(), dst_entry->incoming.end(), in, record_less), in);
+			return true;
+		}
+
+		/**
+		* Effects: Erases the edge src → dst with the specified weight, or the unweighted edge if weight is std::nullopt.
+		* Returns: true if an edge was removed and false otherwise.
+		* Throws: std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::erase_edge on src or dst if they don't exist in the graph")
+		* if either src or dst is not stored, or is erased concurrently.
+		* Complexity: O(log n + e), holding src and dst exclusively.
+		*/
+		auto erase_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
+			const auto src_entry = find_entry(src);
+			const auto dst_entry = find_entry(dst);
+			if (!src_entry or !dst_entry) {
+				throw std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::erase_edge on src or dst if they don't exist in the graph");
+			}
+			const auto lock = lock_pair(*src_entry, *dst_entry);
+			if (src_entry->erased or dst_entry->erased) {
+				throw std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::erase_edge on src or dst if they don't exist in the graph");
+			}
+			if (!erase_record(src_entry->outgoing, edge_record{dst_entry.get(), weight})) {
+				return false;
+			}
+			erase_record(dst_entry->incoming, edge_record{src_entry.get(), std::move(weight)});
+			return true;
+		}
+
+		/**
+		* Effects: Erases the node equivalent to value and every edge incident to it.
+		* The node disappears from lookups at once, and its edges are then unlinked from one neighbour
+		* at a time, so no more than one node lock is held at once.
+		* Returns: true if value was removed and false otherwise.
+		* Complexity: O(log n + d log d + s), where d is the degree of value and s is the total degree of its neighbours.
+		*/
+		auto erase_node(N const& value) -> bool {
+			auto& s = stripe_of(value);
+			auto victim = entry_ptr();
+			{
+				const auto lock = std::unique_lock(s.mutex);
+				const auto it = s.nodes.find(value);
+				if (it == s.nodes.end()) {
+					return false;
+				}
+				victim = std::move(it->second);
+				s.nodes.erase(it);
+			}
+
+			// Writers that locked victim before this point have finished, later ones see erased and throw.
+			// Neighbours are pinned while victim is locked, since a neighbour being erased at the same
+			// time cannot finish until it has unlinked itself from victim.
+			auto neighbours = std::vector<entry_ptr>();
+			{
+				const auto lock = std::unique_lock(victim->mutex);
+				victim->erased = true;
+				for (auto* list : {&victim->outgoing, &victim->incoming}) {
+					for (const auto& record : *list) {
+						if (record.node != victim.get() and (neighbours.empty() or neighbours.back().get() != record.node)) {
+							neighbours.push_back(record.node->shared_from_this());
+						}
+					}
+					list->clear();
+				}
+			}
+			std::sort(neighbours.begin(), neighbours.end());
+			neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+			for (const auto& neighbour : neighbours) {
+				unlink(*neighbour, victim.get());
+			}
+			return true;
+		}
+
+		/**
+		* Returns: true if a node equivalent to value is stored and false otherwise.
+		* Complexity: O(log n), holding one stripe shared.
+		*/
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return find_entry(value) != nullptr;
+		}
+
+		/**
+		* Returns: true if there are no nodes and false otherwise.
+		* Complexity: O(1) per stripe.
+		*/
+		[[nodiscard]] auto empty() const -> bool {
+			return std::all_of(stripes_.begin(), stripes_.end(), [](stripe const& s) {
+				const auto lock = std::shared_lock(s.mutex);
+				return s.nodes.empty();
+			});
+		}
+
+		/**
+		* Returns: true if an edge src → dst exists and false otherwise.
+		* Throws: std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::is_connected if src or dst node don't exist in the graph")
+		* if either src or dst is not stored.
+		* Complexity: O(log n + log e + k), holding src shared, where k is the number of src → dst edges.
+		*/
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			const auto src_entry = find_entry(src);
+			const auto dst_entry = find_entry(dst);
+			if (!src_entry or !dst_entry) {
+				throw std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::is_connected if src or dst node don't exist in the graph");
+			}
+			const auto lock = std::shared_lock(src_entry->mutex);
+			const auto [first, last] = value_range(src_entry->outgoing, dst);
+			// As in connections, a dst whose erase_node has not reached src yet has no edges
+			return std::any_of(first, last, [&](edge_record const& record) {
+				return record.node == dst_entry.get() and !record.node->erased;
+			});
+		}
+
+		/**
+		* Returns: All nodes connected to src by an outgoing edge, sorted in ascending order.
+		* Throws: std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::connections if src doesn't exist in the graph")
+		* if src is not stored.
+		* Complexity: O(log n + e), holding src shared.
+		*/
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			const auto src_entry = find_entry(src);
+			if (!src_entry) {
+				throw std::runtime_error("Cannot call gdwg::concurrent_graph<N, E>::connections if src doesn't exist in the graph");
+			}
+			auto result = std::vector<N>();
+			const auto lock = std::shared_lock(src_entry->mutex);
+			for (const auto& record : src_entry->outgoing) {
+				// Skip records of a dst whose erase_node has not reached src yet
+				if (!record.node->erased and (result.empty() or result.back() < record.node->value)) {
+					result.push_back(record.node->value);
+				}
+			}
+			return result;
+		}
+
+		/**
+		* Returns: A sequence of all stored nodes, sorted in ascending order.
+		* Complexity: O(n log n), holding one stripe shared at a time.
+		*/
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			auto result = std::vector<N>();
+			for (const auto& s : stripes_) {
+				const auto lock = std::shared_lock(s.mutex);
+				for (const auto& [value, entry] : s.nodes) {
+					result.push_back(value);
+				}
+			}
+			std::sort(result.begin(), result.end());
+			return result;
+		}
+
+		/**
+		* Returns: A gdwg::graph copy of the nodes and edges, for running the rest of the library on.
+		* Complexity: O(n log n + e log e), holding one stripe or one node shared at a time.
+		*/
+		[[nodiscard]] auto to_graph() const -> graph<N, E> {
+			auto entries = std::vector<entry_ptr>();
+			for (const auto& s : stripes_) {
+				const auto lock = std::shared_lock(s.mutex);
+				for (const auto& [value, entry] : s.nodes) {
+					entries.push_back(entry);
+				}
+			}
+
+			auto result = graph<N, E>();
+			for (const auto& entry : entries) {
+				result.insert_node(entry->value);
+			}
+			for (const auto& entry : entries) {
+				const auto lock = std::shared_lock(entry->mutex);
+				for (const auto& record : entry->outgoing) {
+					// A dst inserted after the node scan is left out along with its edges
+					if (!record.node->erased and result.is_node(record.node->value)) {
+						result.insert_edge(entry->value, record.node->value, record.weight);
+					}
+				}
+			}
+			return result;
+		}
+
+	private:
+		// Records are ordered by node value, then unweighted first and by weight. The entry address
+		// only separates a dying node's leftover records from those of a node re-inserted with the same value.
+		static auto record_less(edge_record const& a, edge_record const& b) -> bool {
+			if (a.node != b.node and a.node->value != b.node->value) {
+				return a.node->value < b.node->value;
+			}
+			if (a.weight != b.weight) {
+				return a.weight < b.weight;
+			}
+			return std::less<node_entry const*>()(a.node, b.node);
+		}
+
+		static auto same_record(edge_record const& a, edge_record const& b) -> bool {
+			return a.node == b.node and a.weight == b.weight;
+		}
+
+		// The run of records whose node compares equivalent to value
+		static auto value_range(edge_list const& edges, N const& value) {
+			const auto first = std::partition_point(edges.begin(), edges.end(), [&](edge_record const& r) { return r.node->value < value; });
+			const auto last = std::partition_point(first, edges.end(), [&](edge_record const& r) { return !(value < r.node->value); });
+			return std::pair(first, last);
+		}
+
+		static auto erase_record(edge_list& edges, edge_record const& record) -> bool {
+			const auto it = std::lower_bound(edges.begin(), edges.end(), record, record_less);
+			if (it == edges.end() or !same_record(*it, record)) {
+				return false;
+			}
+			edges.erase(it);
+			return true;
+		}
+
+		// Locks both endpoints of an edge exclusively, once if they are the same node
+		static auto lock_pair(node_entry& a, node_entry& b) -> std::pair<std::unique_lock<std::shared_mutex>, std::unique_lock<std::shared_mutex>> {
+			if (&a == &b) {
+				return {std::unique_lock(a.mutex), std::unique_lock<std::shared_mutex>()};
+			}
+			auto first = std::unique_lock(a.mutex, std::defer_lock);
+			auto second = std::unique_lock(b.mutex, std::defer_lock);
+			std::lock(first, second);
+			return {std::move(first), std::move(second)};
+		}
+
+		// Removes every record pointing at victim from both edge lists of neighbour
+		static auto unlink(node_entry& neighbour, node_entry const* victim) -> void {
+			const auto lock = std::unique_lock(neighbour.mutex);
+			for (auto* list : {&neighbour.outgoing, &neighbour.incoming}) {
+				list->erase(std::remove_if(list->begin(), list->end(), [&](edge_record const& r) { return r.node == victim; }), list->end());
+			}
+		}
+
+		auto stripe_of(N const& value) const -> stripe& {
+			return stripes_[std::hash<N>()(value) % num_stripes];
+		}
+
+		auto find_entry(N const& value) const -> entry_ptr {
+			auto const& s = stripe_of(value);
+			const auto lock = std::shared_lock(s.mutex);
+			const auto it = s.nodes.find(value);
+			return it == s.nodes.end() ? nullptr : it->second;
+		}
+
+		mutable std::array<stripe, num_stripes> stripes_;
+	};
+} // namespace gdwg
+
+#endif // GDWG_CONCURRENT_GRAPH_H
@@ -0,0 +1,159 @@
+#include "gdwg_concurrent_graph.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("concurrent_graph matches graph semantics on a single thread") {
+	auto g = gdwg::concurrent_graph<std::string, int>{};
+	REQUIRE(g.empty());
+	REQUIRE(g.insert_node("a"));
+	REQUIRE(g.insert_node("b"));
+	REQUIRE(g.insert_node("c"));
+	REQUIRE_FALSE(g.insert_node("a"));
+	REQUIRE_FALSE(g.empty());
+	REQUIRE(g.nodes() == std::vector<std::string>{"a", "b", "c"});
+
+	SECTION("insert_edge and erase_edge") {
+		REQUIRE(g.insert_edge("a", "b", 3));
+		REQUIRE(g.insert_edge("a", "b"));
+		REQUIRE(g.insert_edge("a", "c", 1));
+		REQUIRE(g.insert_edge("a", "a", 2));
+		REQUIRE_FALSE(g.insert_edge("a", "b", 3));
+		REQUIRE(g.is_connected("a", "b"));
+		REQUIRE_FALSE(g.is_connected("b", "a"));
+		REQUIRE(g.connections("a") == std::vector<std::string>{"a", "b", "c"});
+
+		REQUIRE(g.erase_edge("a", "b", 3));
+		REQUIRE_FALSE(g.erase_edge("a", "b", 3));
+		REQUIRE(g.is_connected("a", "b"));
+		REQUIRE(g.erase_edge("a", "b"));
+		REQUIRE_FALSE(g.is_connected("a", "b"));
+	}
+
+	SECTION("erase_node removes its edges from both sides") {
+		g.insert_edge("a", "b", 1);
+		g.insert_edge("b", "c", 2);
+		g.insert_edge("c", "b", 3);
+		g.insert_edge("b", "b", 4);
+		REQUIRE(g.erase_node("b"));
+		REQUIRE_FALSE(g.erase_node("b"));
+		REQUIRE_FALSE(g.is_node("b"));
+		REQUIRE(g.connections("a").empty());
+		REQUIRE(g.connections("c").empty());
+
+		// A node re-inserted under the same value starts without edges
+		REQUIRE(g.insert_node("b"));
+		REQUIRE_FALSE(g.is_connected("a", "b"));
+		REQUIRE(g.connections("b").empty());
+	}
+
+	SECTION("to_graph and the graph constructor round trip") {
+		g.insert_edge("a", "b", 1);
+		g.insert_edge("a", "b");
+		g.insert_edge("c", "a", 5);
+		auto expected = gdwg::graph<std::string, int>{"a", "b", "c"};
+		expected.insert_edge("a", "b", 1);
+		expected.insert_edge("a", "b");
+		expected.insert_edge("c", "a", 5);
+		REQUIRE(g.to_graph() == expected);
+
+		auto const copy = gdwg::concurrent_graph<std::string, int>(expected);
+		REQUIRE(copy.to_graph() == expected);
+	}
+
+	SECTION("missing nodes throw") {
+		REQUIRE_THROWS_WITH(g.insert_edge("a", "z"),
+		                    "Cannot call gdwg::concurrent_graph<N, E>::insert_edge when either src or dst node does not exist");
+		REQUIRE_THROWS_WITH(g.erase_edge("z", "a"),
+		                    "Cannot call gdwg::concurrent_graph<N, E>::erase_edge on src or dst if they don't exist in the graph");
+		REQUIRE_THROWS_WITH(g.is_connected("a", "z"),
+		                    "Cannot call gdwg::concurrent_graph<N, E>::is_connected if src or dst node don't exist in the graph");
+		REQUIRE_THROWS_WITH(g.connections("z"),
+		                    "Cannot call gdwg::concurrent_graph<N, E>::connections if src doesn't exist in the graph");
+	}
+}
+
+TEST_CASE("concurrent_graph stays consistent under concurrent writers and readers") {
+	constexpr auto num_nodes = 64;
+	constexpr auto num_threads = 4;
+	auto g = gdwg::concurrent_graph<int, int>{};
+	for (auto i = 0; i < num_nodes; ++i) {
+		g.insert_node(i);
+	}
+
+	SECTION("disjoint writers all land") {
+		// Thread t owns the edges whose weight is t, so every insert must succeed exactly once
+		auto threads = std::vector<std::thread>();
+		for (auto t = 0; t < num_threads; ++t) {
+			threads.emplace_back([&g, t] {
+				for (auto i = 0; i < num_nodes; ++i) {
+					g.insert_edge(i, (i * 7 + 1) % num_nodes, t);
+					static_cast<void>(g.is_connected(i, (i * 3) % num_nodes));
+					static_cast<void>(g.connections((i + t) % num_nodes));
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		auto expected = gdwg::graph<int, int>{};
+		for (auto i = 0; i < num_nodes; ++i) {
+			expected.insert_node(i);
+		}
+		for (auto t = 0; t < num_threads; ++t) {
+			for (auto i = 0; i < num_nodes; ++i) {
+				expected.insert_edge(i, (i * 7 + 1) % num_nodes, t);
+			}
+		}
+		REQUIRE(g.to_graph() == expected);
+	}
+
+	SECTION("node erasure racing edge writers leaves no dangling edges") {
+		auto threads = std::vector<std::thread>();
+		for (auto t = 0; t < num_threads; ++t) {
+			threads.emplace_back([&g, t] {
+				auto rng = std::mt19937(static_cast<unsigned>(t));
+				auto pick = std::uniform_int_distribution<int>(0, num_nodes - 1);
+				for (auto i = 0; i < 2000; ++i) {
+					auto const src = pick(rng);
+					auto const dst = pick(rng);
+					try {
+						switch (i % 8) {
+						case 0: g.erase_node(src); break;
+						case 1: g.insert_node(src); break;
+						case 2: g.erase_edge(src, dst, t); break;
+						default: g.insert_edge(src, dst, t); break;
+						}
+					} catch (std::runtime_error const&) {
+						// Either endpoint was erased by another thread
+					}
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		// Every view agrees, and erasing the survivors unlinks every incoming record without touching a freed node
+		auto const snapshot = g.to_graph();
+		REQUIRE(snapshot.nodes() == g.nodes());
+		for (auto const& src : snapshot.nodes()) {
+			REQUIRE(snapshot.connections(src) == g.connections(src));
+			for (auto const& dst : snapshot.nodes()) {
+				REQUIRE(snapshot.is_connected(src, dst) == g.is_connected(src, dst));
+			}
+		}
+		for (auto const& node : snapshot.nodes()) {
+			g.erase_node(node);
+		}
+		REQUIRE(g.empty());
+	}
+}
@@ -0,0 +1,553 @@
+#include "gdwg_algorithms.h"
+#include "gdwg_graph.h"
+#include "gdwg_io.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include <sys/resource.h>
+
+// Benchmark suite for the core gdwg::graph operations.
+//
+// Usage: gdwg_graph_bench [--min-edges N] [--max-edges N] [--samples N] [--seed N]
+//
+// Every (generator, node type, scale) case builds a fresh graph and times each
+// operation. Point operations are timed one call at a time so that p50/p99
+// latencies can be reported, whole-graph passes (iteration, operator==,
+// operator<<) are timed per pass. Build with -DCMAKE_BUILD_TYPE=Release for
+// meaningful numbers.
+namespace {
+	using clock_type = std::chrono::steady_clock;
+
+	struct options {
+		std::size_t min_edges = 1000;
+		std::size_t max_edges = 100000;
+		std::size_t samples = 1000;
+		std::uint64_t seed = 6771;
+	};
+
+	// Synthetic edge in terms of node indices, converted to N when loaded
+	struct edge_spec {
+		std::size_t src;
+		std::size_t dst;
+		std::optional<int> weight;
+	};
+
+	struct workload {
+		std::string name;
+		std::size_t num_nodes;
+		std::vector<edge_spec> edges;
+	};
+
+	// Roughly one in eight edges is unweighted, the rest carry a weight in [1, 100]
+	auto random_weight(std::mt19937_64& rng) -> std::optional<int> {
+		auto dist = std::uniform_int_distribution<int>(0, 100);
+		auto const w = dist(rng);
+		if (w % 8 == 0) {
+			return std::nullopt;
+		}
+		return w;
+	}
+
+	// Uniform random graph with an average out-degree of 8
+	auto make_random(std::size_t num_edges, std::mt19937_64& rng) -> workload {
+		auto const n = std::max<std::size_t>(2, num_edges / 8);
+		auto pick = std::uniform_int_distribution<std::size_t>(0, n - 1);
+		auto w = workload{"random", n, {}};
+		w.edges.reserve(num_edges);
+		for (std::size_t i = 0; i < num_edges; ++i) {
+			w.edges.push_back({pick(rng), pick(rng), random_weight(rng)});
+		}
+		return w;
+	}
+
+	// Skewed graph: both endpoints follow a power law, so a handful of
+	// low-index nodes become hubs with very large in- and out-degree
+	auto make_power_law(std::size_t num_edges, std::mt19937_64& rng) -> workload {
+		auto const n = std::max<std::size_t>(2, num_edges / 8);
+		auto unit = std::uniform_real_distribution<double>(0.0, 1.0);
+		auto const skewed = [&]() {
+			auto const x = std::pow(unit(rng), 3.0) * static_cast<double>(n);
+			return std::min(n - 1, static_cast<std::size_t>(x));
+		};
+		auto w = workload{"power-law", n, {}};
+		w.edges.reserve(num_edges);
+		for (std::size_t i = 0; i < num_edges; ++i) {
+			w.edges.push_back({skewed(), skewed(), random_weight(rng)});
+		}
+		return w;
+	}
+
+	// Square grid where every cell points right and down
+	auto make_grid(std::size_t num_edges, std::mt19937_64& rng) -> workload {
+		auto const side = std::max<std::size_t>(
+		    2,
+		    static_cast<std::size_t>(std::sqrt(static_cast<double>(num_edges) / 2.0)));
+		auto w = workload{"grid", side * side, {}};
+		w.edges.reserve(2 * side * side);
+		for (std::size_t r = 0; r < side; ++r) {
+			for (std::size_t c = 0; c < side; ++c) {
+				auto const id = r * side + c;
+				if (c + 1 < side) {
+					w.edges.push_back({id, id + 1, random_weight(rng)});
+				}
+				if (r + 1 < side) {
+					w.edges.push_back({id, id + side, random_weight(rng)});
+				}
+			}
+		}
+		return w;
+	}
+
+	template<typename N>
+	auto make_node(std::size_t i) -> N;
+
+	template<>
+	auto make_node<int>(std::size_t i) -> int {
+		return static_cast<int>(i);
+	}
+
+	template<>
+	auto make_node<std::string>(std::size_t i) -> std::string {
+		// Pad to a realistic key length so copies are not hidden by SSO
+		auto s = std::string("https://example.com/node/");
+		s += std::to_string(i);
+		return s;
+	}
+
+	template<typename N>
+	auto type_name() -> std::string_view {
+		if constexpr (std::is_same_v<N, int>) {
+			return "int";
+		} else {
+			return "string";
+		}
+	}
+
+	// Stream buffer that counts and discards everything written, so operator<<
+	// is measured without the cost of growing a huge std::string
+	class discard_buffer : public std::streambuf {
+	public:
+		std::size_t bytes = 0;
+
+	protected:
+		auto overflow(int_type c) -> int_type override {
+			++bytes;
+			return traits_type::not_eof(c);
+		}
+
+		auto xsputn(char const*, std::streamsize n) -> std::streamsize override {
+			bytes += static_cast<std::size_t>(n);
+			return n;
+		}
+	};
+
+	// The high-water mark of the whole process, so a case only shows its own peak when it is the largest so far
+	auto peak_rss_kib() -> long {
+		auto usage = rusage{};
+		getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_maxrss;
+	}
+
+	auto percentile(std::vector<double>& sorted_ns, double p) -> double {
+		if (sorted_ns.empty()) {
+			return 0.0;
+		}
+		auto const rank = p * static_cast<double>(sorted_ns.size() - 1);
+		return sorted_ns[static_cast<std::size_t>(rank)];
+	}
+
+	// Times `op(i)` for i in [0, count) individually and prints one report line
+	template<typename Op>
+	auto time_each(std::string_view label, std::size_t count, Op op) -> void {
+		auto latencies = std::vector<double>();
+		latencies.reserve(count);
+		auto const total_start = clock_type::now();
+		for (std::size_t i = 0; i < count; ++i) {
+			auto const start = clock_type::now();
+			op(i);
+			auto const stop = clock_type::now();
+			latencies.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+		}
+		auto const total = std::chrono::duration<double>(clock_type::now() - total_start).count();
+		std::sort(latencies.begin(), latencies.end());
+		auto const ops_per_sec = total > 0.0 ? static_cast<double>(count) / total : 0.0;
+		std::cout << "    " << std::left << std::setw(22) << label << std::right << std::setw(10) << count
+		          << std::setw(16) << std::fixed << std::setprecision(0) << ops_per_sec << std::setw(12)
+		          << percentile(latencies, 0.50) << std::setw(12) << percentile(latencies, 0.99) << "\n";
+	}
+
+	// Times `passes` whole-graph passes, each covering `items` edges
+	template<typename Pass>
+	auto time_pass(std::string_view label, std::size_t passes, std::size_t items, Pass pass) -> void {
+		auto latencies = std::vector<double>();
+		latencies.reserve(passes);
+		for (std::size_t i = 0; i < passes; ++i) {
+			auto const start = clock_type::now();
+			pass();
+			auto const stop = clock_type::now();
+			latencies.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+		}
+		std::sort(latencies.begin(), latencies.end());
+		auto const median = percentile(latencies, 0.50);
+		auto const edges_per_sec = median > 0.0 ? static_cast<double>(items) * 1e9 / median : 0.0;
+		std::cout << "    " << std::left << std::setw(22) << label << std::right << std::setw(10) << passes
+		          << std::setw(16) << std::fixed << std::setprecision(0) << edges_per_sec << std::setw(12)
+		          << median << std::setw(12) << percentile(latencies, 0.99) << "  (edges/sec, ns/pass)\n";
+	}
+
+	template<typename N>
+	auto run_case(workload const& w, options const& opts, std::mt19937_64& rng) -> void {
+		using graph_type = gdwg::graph<N, int>;
+
+		std::cout << "  " << w.name << " / " << type_name<N>() << " / " << w.edges.size() << " edges, "
+		          << w.num_nodes << " nodes\n";
+		std::cout << "    " << std::left << std::setw(22) << "operation" << std::right << std::setw(10) << "count"
+		          << std::setw(16) << "ops/sec" << std::setw(12) << "p50 ns" << std::setw(12) << "p99 ns\n";
+
+		// Pre-convert node values so the conversion is not part of any timing
+		auto values = std::vector<N>();
+		values.reserve(w.num_nodes);
+		for (std::size_t i = 0; i < w.num_nodes; ++i) {
+			values.push_back(make_node<N>(i));
+		}
+
+		auto sink = std::size_t{0};
+		auto g = graph_type{};
+		time_each("insert_node", values.size(), [&](std::size_t i) { g.insert_node(values[i]); });
+		time_pass("insert_node (moved)", 1, values.size(), [&, owned = values]() mutable {
+			auto moved = graph_type();
+			for (auto& value : owned) {
+				moved.insert_node(std::move(value));
+			}
+			sink += moved.num_nodes();
+		});
+		time_each("insert_edge", w.edges.size(), [&](std::size_t i) {
+			auto const& e = w.edges[i];
+			g.insert_edge(values[e.src], values[e.dst], e.weight);
+		});
+
+		using edge_tuple = std::tuple<N, N, std::optional<int>>;
+		auto batch = std::vector<edge_tuple>();
+		batch.reserve(w.edges.size());
+		for (auto const& e : w.edges) {
+			batch.emplace_back(values[e.src], values[e.dst], e.weight);
+		}
+		time_pass("bulk load", 1, w.edges.size(), [&] {
+			auto loaded = graph_type(values, batch);
+			sink += loaded.nodes().size();
+		});
+		time_pass("bulk load (arena)", 1, w.edges.size(), [&] {
+			auto arena = std::pmr::monotonic_buffer_resource();
+			auto loaded = graph_type(&arena);
+			for (auto const& value : values) {
+				loaded.insert_node(value);
+			}
+			sink += loaded.insert_edges(batch);
+		});
+		time_pass("bulk load (deferred incoming)", 1, w.edges.size(), [&] {
+			auto loaded = graph_type(values.begin(), values.end());
+			loaded.defer_incoming_index();
+			sink += loaded.insert_edges(batch);
+		});
+		time_pass("insert_edge (deferred incoming)", 1, w.edges.size(), [&] {
+			auto loaded = graph_type(values.begin(), values.end());
+			loaded.defer_incoming_index();
+			for (auto const& e : w.edges) {
+				sink += loaded.insert_edge(values[e.src], values[e.dst], e.weight) ? 1U : 0U;
+			}
+		});
+		time_pass("insert_edge (logged)", 1, w.edges.size(), [&] {
+			auto logged = graph_type(values.begin(), values.end());
+			logged.record_mutations(4096);
+			for (auto const& e : w.edges) {
+				logged.insert_edge(values[e.src], values[e.dst], e.weight);
+				if (logged.pending_mutations() == 4096) {
+					sink += logged.drain_mutations().size();
+				}
+			}
+		});
+
+		auto const samples = std::min(opts.samples, w.edges.size());
+		auto pick_edge = std::uniform_int_distribution<std::size_t>(0, w.edges.size() - 1);
+		auto pick_node = std::uniform_int_distribution<std::size_t>(0, w.num_nodes - 1);
+		auto edge_probes = std::vector<std::size_t>(samples);
+		auto node_probes = std::vector<std::size_t>(samples);
+		std::generate(edge_probes.begin(), edge_probes.end(), [&] { return pick_edge(rng); });
+		std::generate(node_probes.begin(), node_probes.end(), [&] { return pick_node(rng); });
+
+		time_each("find", samples, [&](std::size_t i) {
+			auto const& e = w.edges[edge_probes[i]];
+			sink += g.find(values[e.src], values[e.dst], e.weight) != g.end() ? 1U : 0U;
+		});
+		time_each("is_connected", samples, [&](std::size_t i) {
+			auto const& e = w.edges[edge_probes[i]];
+			sink += g.is_connected(values[e.src], values[node_probes[i]]) ? 1U : 0U;
+		});
+		time_each("connections", samples, [&](std::size_t i) {
+			sink += g.connections(values[node_probes[i]]).size();
+		});
+		time_each("connections_view", samples, [&](std::size_t i) {
+			for (auto const& dst : g.connections_view(values[node_probes[i]])) {
+				sink += &dst == &values[0] ? 1U : 0U;
+			}
+		});
+		time_each("out_degree", samples, [&](std::size_t i) { sink += g.out_degree(values[node_probes[i]]); });
+
+		// The same probes as one batch, against one call per probe. Batches are usually built per src,
+		// so they are given in order here; shuffled, the sort in find_many costs about what it saves
+		auto probes = std::vector<edge_tuple>();
+		probes.reserve(samples);
+		for (auto const i : edge_probes) {
+			probes.emplace_back(values[w.edges[i].src], values[w.edges[i].dst], w.edges[i].weight);
+		}
+		std::sort(probes.begin(), probes.end());
+		time_pass("find (k calls)", 5, samples, [&] {
+			for (auto const& [src, dst, weight] : probes) {
+				sink += g.find(src, dst, weight) != g.end() ? 1U : 0U;
+			}
+		});
+		time_pass("find_many", 5, samples, [&] {
+			for (auto const& it : g.find_many(probes)) {
+				sink += it != g.end() ? 1U : 0U;
+			}
+		});
+		auto const& hub = values[w.edges.front().src];
+		time_pass("is_connected (k calls)", 5, values.size(), [&] {
+			for (auto const& dst : values) {
+				sink += g.is_connected(hub, dst) ? 1U : 0U;
+			}
+		});
+		time_pass("is_connected (batch)", 5, values.size(), [&] {
+			for (auto const connected : g.is_connected(hub, values)) {
+				sink += connected ? 1U : 0U;
+			}
+		});
+
+		// The same point lookups through a hash index
+		using hashed_type = gdwg::graph<N, int, gdwg::edge_policy::mixed, gdwg::index_policy::hashed>;
+		auto hashed = hashed_type();
+		for (auto const& value : values) {
+			hashed.insert_node(value);
+		}
+		hashed.insert_edges(batch);
+		time_each("find (hashed)", samples, [&](std::size_t i) {
+			auto const& e = w.edges[edge_probes[i]];
+			sink += hashed.find(values[e.src], values[e.dst], e.weight) != hashed.end() ? 1U : 0U;
+		});
+		time_each("is_connected (hashed)", samples, [&](std::size_t i) {
+			auto const& e = w.edges[edge_probes[i]];
+			sink += hashed.is_connected(values[e.src], values[node_probes[i]]) ? 1U : 0U;
+		});
+
+		auto const passes = std::size_t{5};
+		time_pass("iterator traversal", passes, w.edges.size(), [&] {
+			for (auto const& [from, to, weight] : g) {
+				sink += weight.has_value() ? 1U : 0U;
+			}
+		});
+		time_pass("unordered traversal", passes, w.edges.size(), [&] {
+			for (auto const& [from, to, weight] : g.edges_unordered()) {
+				sink += weight.has_value() ? 1U : 0U;
+			}
+		});
+
+		auto const bfs_sources = std::vector<N>{values[node_probes[0]]};
+		time_pass("bfs", passes, w.edges.size(), [&] { sink += gdwg::bfs(g, bfs_sources).size(); });
+		time_pass("parallel_bfs", passes, w.edges.size(), [&] { sink += gdwg::parallel_bfs(g, bfs_sources).size(); });
+		time_pass("shortest_paths", passes, w.edges.size(), [&] {
+			sink += gdwg::shortest_paths(g, bfs_sources[0]).size();
+		});
+		time_pass("delta-stepping", passes, w.edges.size(), [&] {
+			sink += gdwg::parallel_shortest_paths(g, bfs_sources[0]).size();
+		});
+		time_each("shortest_path", std::min<std::size_t>(samples, 100), [&](std::size_t i) {
+			sink += gdwg::shortest_path(g, values[edge_probes[i] % w.num_nodes], values[node_probes[i]]) ? 1U : 0U;
+		});
+		time_pass("copy", passes, w.edges.size(), [&] { sink += graph_type(g).empty() ? 0U : 1U; });
+		time_pass("copy + insert_edge", passes, w.edges.size(), [&] {
+			auto copy = g;
+			auto const& e = w.edges[edge_probes[0]];
+			sink += copy.insert_edge(values[e.dst], values[e.src], e.weight) ? 1U : 0U;
+		});
+		// The subgraph induced by half of the nodes, built one call at a time and through a view
+		auto const half = std::vector<N>(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2));
+		time_pass("subgraph (by insert)", passes, w.edges.size(), [&] {
+			auto part = graph_type(half.begin(), half.end());
+			for (auto it = g.begin(); it != g.end(); ++it) {
+				auto const& [from, to, weight] = *it;
+				if (part.is_node(from) and part.is_node(to)) {
+					part.insert_edge(from, to, weight);
+				}
+			}
+			sink += part.num_edges();
+		});
+		time_pass("subgraph + materialize", passes, w.edges.size(), [&] {
+			sink += g.subgraph(half).materialize().num_edges();
+		});
+		// Unmodified copies share storage and compare equal in O(1), so compare against one that was touched
+		auto copy = graph_type(g);
+		auto const extra = make_node<N>(w.num_nodes);
+		copy.insert_node(extra);
+		copy.erase_node(extra);
+		time_pass("operator==", passes, w.edges.size(), [&] { sink += g == copy ? 1U : 0U; });
+		time_pass("parallel_equal", passes, w.edges.size(), [&] { sink += g.parallel_equal(copy) ? 1U : 0U; });
+		time_pass("for_each_edge", passes, w.edges.size(), [&] {
+			g.for_each_edge([&sink](N const&, N const&, std::optional<int> const& weight) { sink += weight.has_value() ? 1U : 0U; });
+		});
+		time_pass("parallel_for_each_edge", passes, w.edges.size(), [&] {
+			auto weighted = std::atomic<std::size_t>(0);
+			g.parallel_for_each_edge([&weighted](N const&, N const&, std::optional<int> const& weight) {
+				if (weight.has_value()) {
+					weighted.fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+			sink += weighted.load();
+		});
+		time_pass("transform_weights", passes, w.edges.size(), [&] {
+			copy.transform_weights([](int weight) noexcept { return weight + 1; });
+		});
+		time_pass("parallel_transform", passes, w.edges.size(), [&] {
+			copy.parallel_transform_weights([](int weight) noexcept { return weight - 1; });
+		});
+
+		time_pass("operator<<", passes, w.edges.size(), [&] {
+			auto buffer = discard_buffer{};
+			auto os = std::ostream(&buffer);
+			os << g;
+			sink += buffer.bytes;
+		});
+
+		if (auto* const null_file = std::fopen("/dev/null", "wb"); null_file != nullptr) {
+			time_pass("write_to(FILE*)", passes, w.edges.size(), [&] { gdwg::write_to(g, null_file); });
+			std::fclose(null_file);
+		}
+
+		{
+			auto dump = std::ostringstream();
+			dump << g;
+			auto const text = dump.str();
+			time_pass("read_edge_list", 1, w.edges.size(), [&] {
+				auto in = std::istringstream(text);
+				auto read = graph_type();
+				sink += gdwg::read_edge_list(in, read);
+			});
+		}
+
+		auto const image_path = std::filesystem::temp_directory_path() / "gdwg_graph_bench.bin";
+		time_pass("save", 1, w.edges.size(), [&] { gdwg::save(g, image_path); });
+		time_pass("load", passes, w.edges.size(), [&] { sink += gdwg::load<N, int>(image_path).nodes().size(); });
+		if constexpr (std::is_trivially_copyable_v<N>) {
+			time_pass("mapped_graph open", passes, w.edges.size(), [&] {
+				sink += gdwg::mapped_graph<N, int>(image_path, false).nodes().size();
+			});
+		}
+		std::filesystem::remove(image_path);
+
+		auto const csr = g.freeze();
+		time_pass("freeze", passes, w.edges.size(), [&] { sink += g.freeze().nodes().size(); });
+		time_each("csr is_connected", samples, [&](std::size_t i) {
+			auto const& e = w.edges[edge_probes[i]];
+			sink += csr.is_connected(values[e.src], values[node_probes[i]]) ? 1U : 0U;
+		});
+		time_each("csr connections", samples, [&](std::size_t i) {
+			sink += csr.connections(values[node_probes[i]]).size();
+		});
+		time_pass("csr traversal", passes, w.edges.size(), [&] {
+			for (auto const& [from, to, weight] : csr) {
+				sink += weight.has_value() ? 1U : 0U;
+			}
+		});
+
+		// Edge churn: erase and re-insert the same edge, once with the default resource and once pooled
+		auto pool = std::pmr::unsynchronized_pool_resource();
+		auto pooled = graph_type(g, &pool);
+		auto const churn = [&](graph_type& target, std::size_t i) {
+			auto const& e = w.edges[edge_probes[i]];
+			target.erase_edge(values[e.src], values[e.dst], e.weight);
+			sink += target.insert_edge(values[e.src], values[e.dst], e.weight) ? 1U : 0U;
+		};
+		time_each("edge churn", samples, [&](std::size_t i) { churn(g, i); });
+		time_each("edge churn (pool)", samples, [&](std::size_t i) { churn(pooled, i); });
+
+		time_each("erase_edge", samples, [&](std::size_t i) {
+			auto const& e = w.edges[edge_probes[i]];
+			sink += g.erase_edge(values[e.src], values[e.dst], e.weight) ? 1U : 0U;
+		});
+		auto const node_samples = std::min<std::size_t>(samples, std::max<std::size_t>(1, w.num_nodes / 10));
+		auto pruned = g;
+		time_pass("erase_nodes batch", 1, node_samples, [&] {
+			auto victims = std::vector<N>();
+			victims.reserve(node_samples);
+			for (std::size_t i = 0; i < node_samples; ++i) {
+				victims.push_back(values[node_probes[i]]);
+			}
+			sink += pruned.erase_nodes(victims);
+		});
+		time_each("erase_node", node_samples, [&](std::size_t i) {
+			sink += g.erase_node(values[node_probes[i]]) ? 1U : 0U;
+		});
+
+		std::cout << "    process peak RSS so far: " << peak_rss_kib() << " KiB (checksum " << sink << ")\n\n";
+	}
+
+	auto parse_options(int argc, char** argv) -> options {
+		auto opts = options{};
+		for (int i = 1; i + 1 < argc; i += 2) {
+			auto const flag = std::string_view(argv[i]);
+			auto const value = std::strtoull(argv[i + 1], nullptr, 10);
+			if (flag == "--min-edges") {
+				opts.min_edges = std::max<std::size_t>(1, value);
+			} else if (flag == "--max-edges") {
+				opts.max_edges = value;
+			} else if (flag == "--samples") {
+				opts.samples = value;
+			} else if (flag == "--seed") {
+				opts.seed = value;
+			} else {
+				std::cerr << "unknown option " << flag << "\n";
+				std::exit(EXIT_FAILURE);
+			}
+		}
+		return opts;
+	}
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+	auto const opts = parse_options(argc, argv);
+	auto const generators = std::vector<std::function<workload(std::size_t, std::mt19937_64&)>>{
+	    make_random,
+	    make_power_law,
+	    make_grid,
+	};
+
+	for (auto scale = opts.min_edges; scale <= opts.max_edges; scale *= 10) {
+		std::cout << "scale 10^" << std::lround(std::log10(static_cast<double>(scale))) << " edges\n";
+		for (auto const& generate : generators) {
+			auto rng = std::mt19937_64(opts.seed);
+			auto const w = generate(scale, rng);
+			run_case<int>(w, opts, rng);
+			run_case<std::string>(w, opts, rng);
+		}
+	}
+	return EXIT_SUCCESS;
+}
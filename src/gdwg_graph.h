@@ -2,19 +2,45 @@
 #define GDWG_GRAPH_H
 #include <initializer_list>
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
 #include <optional>
 #include <set>
 #include <vector>
 #include <utility>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <sstream>
 #include <map>
+#include <unordered_map>
+#include <atomic>
 #include <cassert>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <iterator>
+#include <limits>
 #include <stdexcept>
+#include <numeric>
 #include <ranges>
+#include <span>
+#include <thread>
+#include <tuple>
 #include <typeinfo>
+#include <variant>
+
+// Set to 1, in every translation unit of a program, to have graphs collect the counters of graph::stats()
+#ifndef GDWG_INSTRUMENT
+#define GDWG_INSTRUMENT 0
+#endif
+
 namespace gdwg {
 	// General template for to_string
 	template <typename T>
@@ -30,10 +56,262 @@ namespace gdwg {
 		return value;
 	}
 
+	// Arithmetic types that std::to_chars formats exactly as a default std::ostream does. Character
+	// types and bool are left out, since streams print them as characters and words.
+	template<typename T>
+	concept chars_formattable = (std::integral<T> and !std::same_as<T, bool> and !std::same_as<T, char>
+	                             and !std::same_as<T, signed char> and !std::same_as<T, unsigned char>
+	                             and !std::same_as<T, wchar_t> and !std::same_as<T, char8_t>
+	                             and !std::same_as<T, char16_t> and !std::same_as<T, char32_t>)
+	                            or std::same_as<T, float> or std::same_as<T, double>;
+
+	// Whether os formats values exactly as to_string does, so that text_writer may stand in for it
+	inline auto has_default_format(std::ostream const& os) -> bool {
+		return os.flags() == (std::ios_base::skipws | std::ios_base::dec) and os.precision() == 6 and os.width() == 0
+		       and os.getloc() == std::locale::classic();
+	}
+
+	/**
+	* Builds text into a reusable buffer and hands it to sink(char const*, std::size_t) in large blocks.
+	* Values are formatted byte for byte as to_string formats them: std::string is appended as is,
+	* integers and floating point numbers go through std::to_chars (6 significant digits, as %g), and
+	* everything else through one std::ostringstream that is reused.
+	* Call flush() once done, the destructor does not.
+	*/
+	template<typename Sink>
+	class text_writer {
+		public:
+			explicit text_writer(Sink sink) : sink_(std::move(sink)) {}
+
+			auto text(std::string_view s) -> text_writer& {
+				buffer_.append(s);
+				if (buffer_.size() >= block_size) {
+					flush();
+				}
+				return *this;
+			}
+
+			template<typename T>
+			auto value(T const& v) -> text_writer& {
+				format(buffer_, v);
+				return *this;
+			}
+
+			// Appends v to out in the format of to_string
+			template<typename T>
+			auto format(std::string& out, T const& v) -> void {
+				if constexpr (std::same_as<T, std::string>) {
+					out.append(v);
+				} else if constexpr (chars_formattable<T>) {
+					char digits[64];
+					auto const result = [&] {
+						if constexpr (std::floating_point<T>) {
+							return std::to_chars(digits, digits + sizeof(digits), v, std::chars_format::general, 6);
+						} else {
+							return std::to_chars(digits, digits + sizeof(digits), v);
+						}
+					}();
+					out.append(digits, result.ptr);
+				} else {
+					scratch_.str(std::string());
+					scratch_ << v;
+					out.append(scratch_.view());
+				}
+			}
+
+			auto flush() -> void {
+				if (!buffer_.empty()) {
+					sink_(buffer_.data(), buffer_.size());
+					buffer_.clear();
+				}
+			}
+
+		private:
+			static constexpr std::size_t block_size = std::size_t{1} << 16;
+
+			Sink sink_;
+			std::string buffer_;
+			std::ostringstream scratch_;
+	};
+
+	// Calls work(thread, begin, end) for up to threads contiguous chunks of [0, count), each chunk a
+	// multiple of granularity long. The calling thread takes the first chunk. If work throws on any
+	// thread, the first exception is rethrown once every chunk has finished.
+	template<typename Work>
+	auto run_parallel(std::size_t threads, std::size_t count, std::size_t granularity, Work const& work) -> void {
+		const auto units = (count + granularity - 1) / granularity;
+		threads = std::min(threads, units);
+		if (threads <= 1) {
+			work(0, 0, count);
+			return;
+		}
+		const auto chunk = (units + threads - 1) / threads * granularity;
+		auto errors = std::vector<std::exception_ptr>(threads);
+		const auto guarded = [&work, &errors](std::size_t t, std::size_t begin, std::size_t end) {
+			try {
+				work(t, begin, end);
+			} catch (...) {
+				errors[t] = std::current_exception();
+			}
+		};
+		auto workers = std::vector<std::thread>();
+		workers.reserve(threads - 1);
+		for (auto t = std::size_t{1}; t < threads; ++t) {
+			const auto begin = std::min(count, t * chunk);
+			workers.emplace_back([&guarded, t, begin, end = std::min(count, begin + chunk)] { guarded(t, begin, end); });
+		}
+		guarded(0, 0, std::min(count, chunk));
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		for (const auto& error : errors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+	}
+
+	// Whether graphs collect the counters of graph::stats(), see GDWG_INSTRUMENT. When false, every
+	// counter and timer compiles away and stats() returns zeros.
+	inline constexpr bool instrumented = GDWG_INSTRUMENT != 0;
+
+	// The public members of graph whose latency graph::stats() records. Each member counts once per call,
+	// however many other members it calls; erase_edge covers every overload, and equal covers operator==
+	// and parallel_equal.
+	enum class graph_operation : std::size_t {
+		insert_node,
+		insert_edge,
+		insert_edges,
+		replace_node,
+		merge_replace_node,
+		erase_node,
+		erase_nodes,
+		erase_edge,
+		clear,
+		is_node,
+		is_connected,
+		find,
+		edges,
+		connections,
+		nodes,
+		equal,
+		transform_weights,
+		freeze,
+		count,
+	};
+
+	// The name of op, as used for its member when exported
+	inline auto operation_name(graph_operation op) noexcept -> std::string_view {
+		constexpr auto names = std::array<std::string_view, static_cast<std::size_t>(graph_operation::count)>{
+			"insert_node", "insert_edge", "insert_edges", "replace_node", "merge_replace_node", "erase_node",
+			"erase_nodes", "erase_edge", "clear", "is_node", "is_connected", "find", "edges", "connections",
+			"nodes", "equal", "transform_weights", "freeze",
+		};
+		return names[static_cast<std::size_t>(op)];
+	}
+
+	// A snapshot of a graph's instrumentation counters, see graph::stats()
+	struct graph_stats {
+		// Bucket 0 counts calls that took no measurable time, and bucket b > 0 those that took [2^(b-1), 2^b)
+		// nanoseconds. The last bucket also takes every longer call.
+		static constexpr std::size_t num_buckets = 40;
+
+		struct latency {
+			std::uint64_t calls = 0;
+			std::uint64_t total_ns = 0;
+			std::array<std::uint64_t, num_buckets> buckets = {};
+		};
+
+		// Lookups of a node value in the index, or in the hash table of a hashed graph
+		std::uint64_t index_probes = 0;
+		// Calls of the comparator that orders edge records, each of which compares node values
+		std::uint64_t comparisons = 0;
+		// Storage and edge list blocks copied on write, and edge lists that grew or were rebuilt
+		std::uint64_t allocations = 0;
+		// Edge records walked or shifted by linear passes over an edge list
+		std::uint64_t scanned_records = 0;
+		std::array<latency, static_cast<std::size_t>(graph_operation::count)> operations = {};
+
+		[[nodiscard]] auto operator[](graph_operation op) const noexcept -> latency const& {
+			return operations[static_cast<std::size_t>(op)];
+		}
+
+		/**
+		* Effects: Writes stats as text, one "name value" line per counter, for a metrics exporter to forward:
+		* the four totals, then for each operation that was called its calls, total_ns and non-zero buckets,
+		* as in "insert_edge.calls 12" and "insert_edge.bucket.7 3".
+		*/
+		friend auto operator<<(std::ostream& os, graph_stats const& stats) -> std::ostream& {
+			os << "index_probes " << stats.index_probes << '\n' << "comparisons " << stats.comparisons << '\n'
+			   << "allocations " << stats.allocations << '\n' << "scanned_records " << stats.scanned_records << '\n';
+			for (auto op = std::size_t{0}; op < stats.operations.size(); ++op) {
+				const auto& latency = stats.operations[op];
+				if (latency.calls == 0) {
+					continue;
+				}
+				const auto name = operation_name(static_cast<graph_operation>(op));
+				os << name << ".calls " << latency.calls << '\n' << name << ".total_ns " << latency.total_ns << '\n';
+				for (auto b = std::size_t{0}; b < num_buckets; ++b) {
+					if (latency.buckets[b] != 0) {
+						os << name << ".bucket." << b << ' ' << latency.buckets[b] << '\n';
+					}
+				}
+			}
+			return os;
+		}
+	};
+
+	// Which kinds of edge a graph may hold. A graph restricted to one kind stores each weight without the
+	// std::optional around it, or stores no weight at all, and its API takes and returns weights accordingly.
+	enum class edge_policy {
+		mixed,
+		weighted_only,
+		unweighted_only,
+	};
+
+	// The weight of every edge of an unweighted_only graph. It takes no space in an edge record.
+	struct no_weight {
+		friend auto operator<=>(no_weight const&, no_weight const&) = default;
+	};
+
+	// How a graph finds a node from its value. Both keep the nodes in sorted order for iteration, nodes() and
+	// operator<<. A hashed graph also keeps an open addressing hash table over them, so is_node, find,
+	// is_connected and the existence checks of every mutator take O(1) expected time instead of O(log n).
+	enum class index_policy {
+		ordered,
+		hashed,
+	};
+
+	// Types that std::hash supports. Graphs whose nodes and weights are hashable keep a fingerprint.
+	template<typename T>
+	concept hashable = requires(T const& value) {
+		{ std::hash<T>{}(value) } -> std::convertible_to<std::size_t>;
+	};
+
 	// Forward declaration of graph
-	template<typename N, typename E>
+	template<typename N, typename E, edge_policy Policy = edge_policy::mixed, index_policy Index = index_policy::ordered>
 	class graph;
 
+	// Forward declaration of csr_graph
+	template<typename N, typename E>
+	class csr_graph;
+
+	// Forward declaration of graph_snapshot
+	template<typename N, typename E, edge_policy Policy = edge_policy::mixed, index_policy Index = index_policy::ordered>
+	class graph_snapshot;
+
+	// Forward declaration of subgraph_view
+	template<typename N, typename E, edge_policy Policy, index_policy Index>
+	class subgraph_view;
+
+	// Forward declaration of graph_traversal, see gdwg_algorithms.h
+	template<typename N, typename E>
+	class graph_traversal;
+
+	// Forward declaration of graph_io, see gdwg_io.h
+	template<typename N, typename E>
+	class graph_io;
+
 	template<typename N, typename E>
 	class edge {
 		public:
@@ -75,6 +353,23 @@ namespace gdwg {
 				return std::pair(this->src_, this->dst_);
 			};
 
+			/**
+			* Returns: A reference to the source node of the edge.
+			*
+			* Remarks: Unlike get_nodes, this does not copy the node, and is used by the graph
+			* on every comparison and dereference.
+			*/
+			auto src() const noexcept -> N const& {
+				return src_;
+			}
+
+			/**
+			* Returns: A reference to the destination node of the edge.
+			*/
+			auto dst() const noexcept -> N const& {
+				return dst_;
+			}
+
 			/**
 			* Returns: Returns true if two edges are equal, false otherwise
 			*/
@@ -107,12 +402,12 @@ namespace gdwg {
 				dst_ = new_dst;
 			}
 
-			edge(N src, N dst, E weight) : src_(src), dst_(dst), weight_(weight) {};
+			edge(N src, N dst) : src_(std::move(src)), dst_(std::move(dst)) {};
 			N src_;
 			N dst_;
-			E weight_;
 	 	private:
-			friend class graph<N, E>;
+			template<typename, typename, edge_policy, index_policy>
+			friend class graph;
 	};
 
 	template<typename N, typename E>
@@ -124,7 +419,7 @@ namespace gdwg {
 			* @param src The source node of the edge.
 			* @param dst The destination node of the edge.
 			*/
-			unweighted_edge(N const& src, N const& dst) : gdwg::edge<N, E>{src, dst, E{1}} {}
+			unweighted_edge(N src, N dst) : gdwg::edge<N, E>{std::move(src), std::move(dst)} {}
 
 			/**
 			* Effects: Returns a string representation of the edge.
@@ -169,7 +464,7 @@ namespace gdwg {
 			* @param src The source node of the edge.
 			* @param dst The destination node of the edge.
 			*/
-			weighted_edge(N const& src, N const& dst, E const& weight) : gdwg::edge<N, E>{src, dst, weight} {}
+			weighted_edge(N src, N dst, E weight) : gdwg::edge<N, E>{std::move(src), std::move(dst)}, weight_(std::move(weight)) {}
 
 			/**
 			* Effects: Returns a string representation of the edge.
@@ -203,103 +498,593 @@ namespace gdwg {
 			auto get_weight() const noexcept -> std::optional<E> override {
 				return this->weight_;
 			};
+
+		private:
+			E weight_;
 	};
 
-	template<typename N, typename E>
+
+	/**
+	* A directed graph with weighted and unweighted edges between nodes of type N.
+	*
+	* Policy restricts the edges a graph may hold, see edge_policy. A weighted_only graph takes and returns
+	* plain E weights, and an unweighted_only graph takes no weights and stores none: its edge records are
+	* a node id alone, and E only names the edge type that edges() returns. Index chooses how nodes are
+	* looked up, see index_policy; a hashed graph requires std::hash<N>. freeze() and the functions of
+	* gdwg_algorithms.h and gdwg_io.h take mixed, ordered graphs.
+	*/
+	template<typename N, typename E, edge_policy Policy, index_policy Index>
 	class graph {
-		using edge_ = gdwg::edge<N, E>;
-		using edge_ptr = std::shared_ptr<edge_>;
-		struct EdgePtrComparator {
-			bool operator()(const edge_ptr& a, const edge_ptr& b) const {					
-				// 0. Check if they are the same
-				if (a == b) {
-					return false;
+		public:
+			// Every container of the graph allocates from the memory resource of this allocator
+			using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+			// The weight of an edge: std::optional<E>, where std::nullopt is an unweighted edge,
+			// E in weighted_only graphs, and no_weight in unweighted_only graphs
+			using weight_type = std::conditional_t<Policy == edge_policy::mixed, std::optional<E>,
+			                    std::conditional_t<Policy == edge_policy::weighted_only, E, no_weight>>;
+
+			// Whether the graph maintains fingerprint(): it needs std::hash of N, and of E unless edges carry no weight
+			static constexpr bool fingerprinted = hashable<N> and (Policy == edge_policy::unweighted_only or hashable<E>);
+
+			// The events of the mutation log, see record_mutations. Each names the mutator that caused it
+			// and the arguments that replay it, as apply does.
+			struct node_inserted {
+				N value;
+			};
+
+			// value was erased together with every edge into or out of it
+			struct node_erased {
+				N value;
+			};
+
+			struct node_replaced {
+				N old_value;
+				N new_value;
+			};
+
+			struct node_merged {
+				N old_value;
+				N new_value;
+			};
+
+			struct edge_inserted {
+				N from;
+				N to;
+				weight_type weight;
+			};
+
+			struct edge_erased {
+				N from;
+				N to;
+				weight_type weight;
+			};
+
+			// The graph was cleared, or moved from
+			struct cleared {};
+
+			// The events since the last drain cannot be replayed: the log overflowed, or the graph was
+			// assigned to or had its weights transformed. Consumers resynchronise from a copy of the graph.
+			struct reset {};
+
+			using mutation = std::variant<node_inserted, node_erased, node_replaced, node_merged,
+			                              edge_inserted, edge_erased, cleared, reset>;
+
+		private:
+		// Every node is interned once: its value lives only as a key of state_->index, and
+		// everything else refers to it by a dense id into state_->nodes
+		using node_id = std::uint32_t;
+
+		// The live counters behind stats(). Relaxed atomics, since const members count too and may run concurrently.
+		struct live_stats {
+			struct latency {
+				std::atomic<std::uint64_t> calls{0};
+				std::atomic<std::uint64_t> total_ns{0};
+				std::array<std::atomic<std::uint64_t>, graph_stats::num_buckets> buckets = {};
+			};
+
+			std::atomic<std::uint64_t> index_probes{0};
+			std::atomic<std::uint64_t> comparisons{0};
+			std::atomic<std::uint64_t> allocations{0};
+			std::atomic<std::uint64_t> scanned_records{0};
+			std::array<latency, static_cast<std::size_t>(graph_operation::count)> operations = {};
+		};
+
+		// Stands in for the counters when the graph is not instrumented
+		struct no_stats {};
+
+		// Times the enclosing public member into stats, unless another timed member on this thread called it
+		class operation_timer {
+			public:
+				operation_timer(live_stats* stats, graph_operation op) noexcept
+				: stats_(depth()++ == 0 ? stats : nullptr), op_(op), start_(std::chrono::steady_clock::now()) {}
+
+				operation_timer(operation_timer const&) = delete;
+				auto operator=(operation_timer const&) -> operation_timer& = delete;
+
+				~operation_timer() {
+					--depth();
+					if (stats_ == nullptr) {
+						return;
+					}
+					const auto elapsed = std::chrono::steady_clock::now() - start_;
+					const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+					auto& latency = stats_->operations[static_cast<std::size_t>(op_)];
+					latency.calls.fetch_add(1, std::memory_order_relaxed);
+					latency.total_ns.fetch_add(ns, std::memory_order_relaxed);
+					const auto bucket = std::min<std::size_t>(static_cast<std::size_t>(std::bit_width(ns)), graph_stats::num_buckets - 1);
+					latency.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+				}
+
+			private:
+				static auto depth() noexcept -> int& {
+					thread_local auto calls = 0;
+					return calls;
+				}
+
+				live_stats* stats_;
+				graph_operation op_;
+				std::chrono::steady_clock::time_point start_;
+		};
+
+		// Compact edge record stored in a node's adjacency lists. node is the other endpoint
+		// of the edge: the dst for outgoing records and the src for incoming records.
+		struct edge_record {
+			node_id node;
+			[[no_unique_address]] weight_type weight;
+		};
+		using edge_list = std::pmr::vector<edge_record>;
+
+		// A node's outgoing and incoming edge lists, shared between copies of the graph until
+		// one of them modifies the node
+		struct adjacency {
+			adjacency() = default;
+
+			explicit adjacency(allocator_type alloc)
+			: outgoing(alloc), incoming(alloc) {}
+
+			adjacency(adjacency const& other, allocator_type alloc)
+			: outgoing(other.outgoing, alloc), incoming(other.incoming, alloc), distinct_out(other.distinct_out) {}
+
+			edge_list outgoing;
+			edge_list incoming;
+			// The number of distinct dsts in outgoing
+			std::size_t distinct_out = 0;
+		};
+
+		// The mixed hash of a node's value, and its sub-fingerprint: that hash plus the hashes of its outgoing edges
+		struct node_digest {
+			std::uint64_t hash = 0;
+			std::uint64_t sum = 0;
+		};
+
+		// Stands in for node_digest and the graph's fingerprint when the graph is not fingerprinted
+		struct no_digest {};
+
+		// Per-node storage. value points at the node's key in the index, which std::map
+		// never relocates, and is nullptr for ids on the free list.
+		struct node_slot {
+			N const* value;
+			std::shared_ptr<adjacency> edges;
+			[[no_unique_address]] std::conditional_t<fingerprinted, node_digest, no_digest> digest = {};
+		};
+
+		// Heterogeneous lookup key for a single edge record
+		struct record_key {
+			N const& node;
+			weight_type const& weight;
+		};
+
+		// Heterogeneous lookup key matching every record to node regardless of weight
+		struct node_key {
+			N const& node;
+		};
+
+		// Orders records by node value, so it needs the slots to resolve ids
+		struct EdgeRecordComparator {
+			std::pmr::vector<node_slot> const& slots;
+			[[no_unique_address]] std::conditional_t<instrumented, live_stats*, no_stats> stats;
+
+			bool operator()(const edge_record& a, const edge_record& b) const {
+				tick();
+				// 1. Order by node
+				if (a.node != b.node and value(a) != value(b)) {
+					return value(a) < value(b);
+				}
+
+				// 2. Order by unweighted first, then by weight
+				return a.weight < b.weight;
+			}
+
+			bool operator()(const edge_record& a, const record_key& k) const {
+				tick();
+				return compare(a, k) < 0;
+			}
+
+			bool operator()(const record_key& k, const edge_record& a) const {
+				tick();
+				return compare(a, k) > 0;
+			}
+
+			bool operator()(const edge_record& a, const node_key& k) const {
+				tick();
+				return compare(a, k) < 0;
+			}
+
+			bool operator()(const node_key& k, const edge_record& a) const {
+				tick();
+				return compare(a, k) > 0;
+			}
+
+			auto tick() const noexcept -> void {
+				if constexpr (instrumented) {
+					stats->comparisons.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+
+			auto value(const edge_record& r) const -> N const& {
+				return *slots[r.node].value;
+			}
+
+			// Three-way comparison of a record against a key, following step 1 above
+			auto compare(const edge_record& r, const node_key& k) const -> int {
+				if (value(r) != k.node) {
+					return value(r) < k.node ? -1 : 1;
+				}
+				return 0;
+			}
+
+			// Three-way comparison of a record against a key, following steps 1 - 2 above
+			auto compare(const edge_record& r, const record_key& k) const -> int {
+				if (const auto node_order = compare(r, node_key{k.node}); node_order != 0) {
+					return node_order;
+				}
+				if (r.weight != k.weight) {
+					return r.weight < k.weight ? -1 : 1;
+				}
+				return 0;
+			}
+		};
+
+		using node_index = std::pmr::map<N, node_id>;
+
+		// Open addressing hash table from a node's value to its entry in the index, used by hashed graphs.
+		// Linear probing over a power of two number of slots, with backward shift erasure so that no
+		// tombstones build up. Slots hold the hash, with the low bit set so that 0 marks an empty slot.
+		class hash_index {
+			public:
+				using position = typename node_index::iterator;
+
+				hash_index() = default;
+
+				explicit hash_index(allocator_type alloc) : slots_(alloc) {}
+
+				// Returns the entry of value, or end if it is not a node
+				auto find(N const& value, position end) const -> position {
+					if (size_ == 0) {
+						return end;
+					}
+					const auto tag = tag_of(value);
+					for (auto i = home(tag); slots_[i].tag != 0; i = next(i)) {
+						if (slots_[i].tag == tag and slots_[i].at->first == value) {
+							return slots_[i].at;
+						}
+					}
+					return end;
+				}
+
+				// Precondition: at->first is not in the table yet
+				auto insert(position at) -> void {
+					if ((size_ + 1) * 4 > slots_.size() * 3) {
+						rehash(std::max(slots_.size() * 2, std::size_t{16}));
+					}
+					place(slot{tag_of(at->first), at});
+					++size_;
+				}
+
+				// Precondition: value is in the table
+				auto erase(N const& value) -> void {
+					const auto tag = tag_of(value);
+					auto hole = home(tag);
+					while (slots_[hole].tag != tag or slots_[hole].at->first != value) {
+						hole = next(hole);
+					}
+					// Shift back every later slot of the run whose home does not lie after the hole
+					for (auto i = next(hole); slots_[i].tag != 0; i = next(i)) {
+						if (distance(home(slots_[i].tag), i) >= distance(hole, i)) {
+							slots_[hole] = slots_[i];
+							hole = i;
+						}
+					}
+					slots_[hole] = slot{};
+					--size_;
+				}
+
+				// Makes room for count entries without rehashing
+				auto reserve(std::size_t count) -> void {
+					auto capacity = std::size_t{16};
+					while (count * 4 > capacity * 3) {
+						capacity *= 2;
+					}
+					if (capacity > slots_.size()) {
+						rehash(capacity);
+					}
+				}
+
+			private:
+				struct slot {
+					std::size_t tag = 0;
+					position at;
+				};
+
+				static auto tag_of(N const& value) -> std::size_t {
+					return std::hash<N>{}(value) | 1U;
+				}
+
+				// Fibonacci hashing spreads identity hashes, such as std::hash<int>, over the high bits
+				auto home(std::size_t tag) const noexcept -> std::size_t {
+					return static_cast<std::size_t>((static_cast<std::uint64_t>(tag) * 0x9E3779B97F4A7C15ULL) >> shift_);
 				}
 
-				// 1. Order by src
-				if (a->get_nodes().first != b->get_nodes().first) {
-					return a->get_nodes().first < b->get_nodes().first;
+				auto next(std::size_t i) const noexcept -> std::size_t {
+					return (i + 1) & (slots_.size() - 1);
 				}
 
-				// 2. Order by dst
-				if (a->get_nodes().second != b->get_nodes().second) {
-					return a->get_nodes().second < b->get_nodes().second;
+				auto distance(std::size_t from, std::size_t to) const noexcept -> std::size_t {
+					return (to - from) & (slots_.size() - 1);
 				}
 
-				// 3. Order by unweighted first
-				if (a->is_weighted() != b->is_weighted()) {
-					return !a->is_weighted();
+				auto place(slot entry) -> void {
+					auto i = home(entry.tag);
+					while (slots_[i].tag != 0) {
+						i = next(i);
+					}
+					slots_[i] = entry;
 				}
 
-				// 4. Order by weight 
-				if (a->is_weighted() and b->is_weighted()) {
-					if (a->get_weight() != b->get_weight()) {
-						return a->get_weight() < b->get_weight();
+				// Precondition: capacity is a power of two, at least 16
+				auto rehash(std::size_t capacity) -> void {
+					auto old = std::pmr::vector<slot>(capacity, slots_.get_allocator());
+					old.swap(slots_);
+					shift_ = 64;
+					for (auto c = capacity; c > 1; c /= 2) {
+						--shift_;
+					}
+					for (const auto& entry : old) {
+						if (entry.tag != 0) {
+							place(entry);
+						}
 					}
 				}
 
-				// 5. Order by memory address
-				return std::less<const edge_*>{}(a.get(), b.get());
+				std::pmr::vector<slot> slots_;
+				std::size_t size_ = 0;
+				int shift_ = 64;
+		};
+
+		// Stands in for hash_index in ordered graphs
+		struct no_hash_index {
+			no_hash_index() = default;
+
+			explicit no_hash_index(allocator_type) {}
+		};
+
+		// Interned nodes: each value is stored once, as a key of index mapping it to its id.
+		// nodes[id] holds the node's edge lists; reflexive edge will be stored on both of the lists
+		struct storage {
+			storage() = default;
+
+			// Copies other into alloc. Ids are unchanged and the slots' value pointers are re-pointed
+			// at the keys of the new index, while edge lists stay shared with other.
+			storage(storage const& other, allocator_type alloc)
+			: index(other.index, alloc), nodes(other.nodes, alloc), free_ids(other.free_ids, alloc), table(alloc),
+			  num_edges(other.num_edges), digest(other.digest), incoming_indexed(other.incoming_indexed) {
+				if constexpr (Index == index_policy::hashed) {
+					table.reserve(index.size());
+				}
+				for (auto it = index.begin(); it != index.end(); ++it) {
+					nodes[it->second].value = &it->first;
+					if constexpr (Index == index_policy::hashed) {
+						table.insert(it);
+					}
+				}
 			}
+
+			storage(storage const&) = delete;
+			auto operator=(storage const&) -> storage& = delete;
+
+			node_index index;
+			std::pmr::vector<node_slot> nodes;
+			std::pmr::vector<node_id> free_ids;
+			// The same entries as index, hashed for point lookups in hashed graphs
+			[[no_unique_address]] std::conditional_t<Index == index_policy::hashed, hash_index, no_hash_index> table;
+			std::size_t num_edges = 0;
+			// The sum of every node's sub-fingerprint, see fingerprint()
+			[[no_unique_address]] std::conditional_t<fingerprinted, std::uint64_t, no_digest> digest = {};
+			// False while the incoming lists are left empty, see defer_incoming_index()
+			bool incoming_indexed = true;
+		};
+
+		// Bounded FIFO of mutations in a ring of slots, reserved up front so that recording never reallocates.
+		// When it is full, or an event cannot be copied, every pending event is replaced by a single reset and
+		// nothing more is recorded until that reset has been drained.
+		class mutation_log {
+			public:
+				explicit mutation_log(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {
+					slots_.reserve(capacity_);
+				}
+
+				// Appends the event make() returns
+				template<typename Make>
+				auto record(Make const& make) noexcept -> void {
+					if (overflowed_) {
+						return;
+					}
+					if (size_ == capacity_) {
+						overflow();
+						return;
+					}
+					try {
+						const auto pos = (head_ + size_) % capacity_;
+						if (pos == slots_.size()) {
+							slots_.emplace_back(make());
+						} else {
+							slots_[pos] = make();
+						}
+						++size_;
+					} catch (...) {
+						overflow();
+					}
+				}
+
+				auto drain(std::size_t max) -> std::vector<mutation> {
+					const auto count = std::min(max, size_);
+					auto events = std::vector<mutation>();
+					events.reserve(count);
+					for (auto i = std::size_t{0}; i < count; ++i) {
+						events.push_back(std::move(slots_[(head_ + i) % capacity_]));
+					}
+					head_ = (head_ + count) % capacity_;
+					size_ -= count;
+					if (size_ == 0) {
+						head_ = 0;
+						overflowed_ = false;
+					}
+					return events;
+				}
+
+				auto size() const noexcept -> std::size_t {
+					return size_;
+				}
+
+			private:
+				auto overflow() noexcept -> void {
+					// Within the reserved capacity, so this cannot throw
+					slots_.clear();
+					slots_.emplace_back(std::in_place_type<reset>);
+					head_ = 0;
+					size_ = 1;
+					overflowed_ = true;
+				}
+
+				// Slots are only ever appended up to capacity_, then reused by assignment, so mutation
+				// needs no default constructor. The pending events are [head_, head_ + size_) modulo capacity_.
+				std::vector<mutation> slots_;
+				std::size_t capacity_;
+				std::size_t head_ = 0;
+				std::size_t size_ = 0;
+				bool overflowed_ = false;
+		};
+
+		// Edge record waiting to be merged into the list of owner, used by batch insertion
+		struct pending_record {
+			node_id owner;
+			edge_record record;
 		};
-		using edge_ptr_set = std::set<edge_ptr, EdgePtrComparator>;
-		using edge_ptr_set_pair = std::pair<edge_ptr_set, edge_ptr_set>;
 
 	 	public:
 			// Forward declaration of iterator
 			class iterator;
-			
+
+			// Forward declaration of the range returned by edges_unordered()
+			class unordered_edges;
+
+			// Forward declaration of the range returned by connections_view()
+			class connections_range;
+
 			/**
 			* Default constructor for graph
 			*/
 			graph() noexcept = default;
 
+			/**
+			 * Effects: Constructs an empty graph whose index, node slots and edge lists are all allocated from
+			 * the memory resource of alloc, e.g. a std::pmr::monotonic_buffer_resource for a graph that is built
+			 * once, or a std::pmr::unsynchronized_pool_resource for one with heavy edge churn.
+			 *
+			 * Precondition: The resource outlives the graph and every copy or snapshot sharing its storage.
+			 */
+			explicit graph(allocator_type alloc) noexcept : alloc_(alloc) {}
+
 			/**
 			 * Equivalent to: graph(il.begin(), il.end());
 			 */
 			graph(std::initializer_list<N> il) noexcept {
 				std::for_each(il.begin(), il.end(), [this](const N& node) {
-					g_[node] = edge_ptr_set_pair();
+					intern_node(node);
 				});
 			}
 
 			/**
-			 * Precondition: InputIt models Cpp17 Input Iterator 
+			 * Precondition: InputIt models Cpp17 Input Iterator
 			 * Preconditon: InputIt indirectly readable as type N
-			 * 
-			 * Initialises the graph’s node collection with the range [first, last)
+			 *
+			 * Initialises the graph’s node collection with the range [first, last). Nodes are moved in
+			 * if InputIt yields rvalues, e.g. a std::move_iterator.
 			 */
-			template<typename InputIt>
+			template<std::input_iterator InputIt>
 			graph(InputIt first, InputIt last) noexcept {
-				std::for_each(first, last, [this](const N& node) {
-					g_[node] = edge_ptr_set_pair();
-				});
+				for (; first != last; ++first) {
+					intern_node(*first);
+				}
+			}
+
+			/**
+			 * Precondition: NodeRange is an input range of values convertible to N
+			 * Precondition: EdgeRange is an input range of {src, dst, weight} elements, see insert_edges
+			 *
+			 * Initialises the graph’s node collection with nodes, then bulk-loads edges.
+			 *
+			 * Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist")
+			 * if an edge refers to a node that is not in nodes.
+			 */
+			template<std::ranges::input_range NodeRange, std::ranges::input_range EdgeRange>
+			graph(NodeRange const& nodes, EdgeRange const& edges) {
+				for (const auto& node : nodes) {
+					intern_node(node);
+				}
+				insert_edges(edges);
 			}
 
 			/**
 			 * Postcondition: *this is equal to the value other had before this constructor’s invocation
-			 * 
+			 *
 			 * Postcondition: other.empty() is true
-			 * 
-			 * Postcondition: All iterators pointing to elements owned by *this 
+			 *
+			 * Postcondition: All iterators pointing to elements owned by *this
 			 * prior to this constructor’s invocation are invalidated
-			 * 
-			 * Postcondition: All iterators pointing to elements owned by other 
-			 * prior to this constructor’s invocation remain valid, 
+			 *
+			 * Postcondition: All iterators pointing to elements owned by other
+			 * prior to this constructor’s invocation remain valid,
 			 * but now point to the elements owned by *this
 			 *
 			 */
-			graph(graph&& other) noexcept {
-				g_ = std::exchange(other.g_, {});
+			graph(graph&& other) noexcept : alloc_(other.alloc_), state_(std::exchange(other.state_, empty_storage())) {
+				other.note([] { return cleared{}; });
 			};
 
+			/**
+			 * Effects: Constructs a graph equal to other that allocates from alloc. The storage of other is
+			 * taken over if other uses the same resource, and copied as by graph(other, alloc) otherwise.
+			 *
+			 * Postcondition: *this is equal to the value other had before this constructor’s invocation
+			 */
+			graph(graph&& other, allocator_type alloc) : alloc_(alloc) {
+				if (alloc_ == other.alloc_) {
+					state_ = std::exchange(other.state_, empty_storage());
+					other.note([] { return cleared{}; });
+				} else {
+					state_ = graph(other, alloc_).state_;
+				}
+			}
+
 			/**
 			 * Effects: All existing nodes and edges are either move-assigned to, or are destroyed
 			 *
 			 * Postconditions:
 			 * - *this is equal to the value other had before this operator’s invocation.
 			 * - All iterators pointing to elements owned by *this prior to this operator’s invocation are invalidated.
-			 * - All iterators pointing to elements owned by other prior to this operator’s invocation remain valid, 
+			 * - All iterators pointing to elements owned by other prior to this operator’s invocation remain valid,
 			 * but now point to the elements owned by *this.
 			 *
 			 * Returns: *this.
@@ -308,24 +1093,53 @@ namespace gdwg {
 				if (this == &other) {
 					return *this;
 				}
-				g_ = std::exchange(other.g_, {});
+				state_ = std::exchange(other.state_, empty_storage());
+				note([] { return reset{}; });
+				other.note([] { return cleared{}; });
 				return *this;
 			};
 
 			/**
 			 * Postconditions: *this == other is true
+			 *
+			 * The copy shares other's storage until either graph is modified, and even then only the modified
+			 * nodes' edge lists are duplicated. Modifying one graph never affects the other. Like every
+			 * constructor, it does not record mutations, see record_mutations.
+			 *
+			 * Complexity: O(1)
 			 */
-			graph(graph const& other) noexcept : g_(std::move(other.g_)) {};
+			graph(graph const& other) noexcept : alloc_(other.alloc_), state_(other.state_) {};
 
 			/**
-			 * Postconditions
-			 * - *this == other is true
-			 * - All iterators pointing to elements owned by *this prior to this operator’s invocation are invalidated
-			 * 
+			 * Effects: Constructs a graph equal to other whose storage is entirely allocated from alloc,
+			 * sharing nothing with other. Use it to move a built graph into an arena.
+			 *
+			 * Postconditions: *this == other is true
+			 *
+			 * Complexity: O(n + e), where n is the number of stored nodes and e is the number of stored edges.
+			 */
+			graph(graph const& other, allocator_type alloc) : alloc_(alloc) {
+				if (other.state_->nodes.empty()) {
+					return;
+				}
+				state_ = std::allocate_shared<storage>(alloc_, *other.state_, alloc_);
+				for (auto& slot : state_->nodes) {
+					if (slot.value and (!slot.edges->outgoing.empty() or !slot.edges->incoming.empty())) {
+						slot.edges = std::allocate_shared<adjacency>(alloc_, *slot.edges, alloc_);
+					}
+				}
+			}
+
+			/**
+			 * Postconditions
+			 * - *this == other is true
+			 * - All iterators pointing to elements owned by *this prior to this operator’s invocation are invalidated
+			 *
 			 * Returns: *this
 			 */
-			auto operator=(graph const& other) -> graph& {
-				g_ = std::move(other.g_);
+			auto operator=(graph const& other) noexcept -> graph& {
+				state_ = other.state_;
+				note([] { return reset{}; });
 				return *this;
 			};
 
@@ -339,19 +1153,35 @@ namespace gdwg {
 			* Returns: true if the node is added to the graph and false otherwise.
 			*/
 			auto insert_node(N const& value) noexcept -> bool {
-				if (is_node(value)) {
-					return false;
-				}
-				g_[value] = edge_ptr_set_pair();
-				return true;
+				return insert_node_value(value);
 			};
 
 			/**
-			* Effects: Adds a new edge representing src → dst with an optional weight. 
-			* 
-			* - If weight is std::nullopt, an unweighted_edge is created. 
-			* - Otherwise, a weighted_edge with the specified weight is created. 
+			* Effects: As insert_node(value), but moves value into the graph if it is added.
+			* value is left unchanged if an equivalent node is already stored.
+			*/
+			auto insert_node(N&& value) noexcept -> bool {
+				return insert_node_value(std::move(value));
+			}
+
+			/**
+			* Effects: As insert_node(N(std::forward<Args>(args)...)): the node is constructed once, then
+			* moved into the graph if there is no equivalent node already stored.
+			* Returns: true if the node is added to the graph and false otherwise.
+			*/
+			template<typename... Args>
+			requires std::constructible_from<N, Args...>
+			auto emplace_node(Args&&... args) -> bool {
+				return insert_node_value(N(std::forward<Args>(args)...));
+			}
+
+			/**
+			* Effects: Adds a new edge representing src → dst with an optional weight.
+			*
+			* - If weight is std::nullopt, an unweighted_edge is created.
+			* - Otherwise, a weighted_edge with the specified weight is created.
 			* - The edge is only added if there is no existing edge between src and dst with the same weight.
+			* In a weighted_only graph weight is an E, and an unweighted_only graph only has insert_edge(src, dst).
 			* [Note:⁠ Nodes are allowed to be connected to themselves. —end note]
 			* Postconditions: All iterators are invalidated.
 			*
@@ -359,50 +1189,79 @@ namespace gdwg {
 			*
 			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist") if either of is_node(src) or is_node(dst) are false.
 			* [Note: Unlike Assignment 2, the exception message must be used verbatim. —end note]
+			*
+			* Remarks: weight is moved into the outgoing record of src, so passing an rvalue copies it only once,
+			* into the incoming record of dst that mirrors it.
 			*/
-			auto create_edge_ptr (N const& src, N const& dst, std::optional<E> weight = std::nullopt) const -> std::shared_ptr<edge_> {
-				if (weight == std::nullopt) {
-					return std::make_shared<gdwg::unweighted_edge<N, E>>(src, dst);
-				} else {
-					return std::make_shared<gdwg::weighted_edge<N, E>>(src, dst, weight.value());
-				}
+			auto insert_edge(N const& src, N const& dst, weight_type weight) -> bool
+			requires (Policy != edge_policy::unweighted_only) {
+				return insert_edge_value(src, dst, std::move(weight));
 			}
 
-			// Find based on edges from given node
-			auto existed_edge(const std::set<std::shared_ptr<edge_>, EdgePtrComparator>& edges_ptr, 
-									const std::shared_ptr<edge_>& new_edge_ptr) const -> bool {
-				
-				// Define a lambda to compare edges based on their content, not their address
-				auto edge_content_equal = [&new_edge_ptr](const edge_ptr& e) {
-					return *e == *new_edge_ptr;
-				};
-
-				auto it = std::find_if(edges_ptr.begin(), edges_ptr.end(), edge_content_equal);
-				if (it == edges_ptr.end()) {
-					return false;
-				} else {
-					return true;
-				}
+			/**
+			* Effects: Adds an unweighted edge representing src → dst, as insert_edge(src, dst, std::nullopt).
+			* Not available in weighted_only graphs.
+			*/
+			auto insert_edge(N const& src, N const& dst) -> bool
+			requires (Policy != edge_policy::weighted_only) {
+				return insert_edge_value(src, dst, weight_type());
 			}
 
-			auto insert_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
-				// Check src and dst existence first
-				if (!is_node(src) or !is_node(dst)) {
-					throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist");
+			/**
+			* Effects: Adds every edge in edges, with the same semantics as calling insert_edge on each of them.
+			* Each element is destructured as auto const& [src, dst, weight], so graph::iterator::value_type,
+			* std::tuple<N, N, std::optional<E>> and similar types all work. In an unweighted_only graph
+			* elements are destructured as auto const& [src, dst] instead.
+			* Edges already in the graph, or repeated in edges, are only added once.
+			*
+			* The batch is sorted and deduplicated once, then merged into each affected edge list in a single pass,
+			* instead of one sorted insertion per edge.
+			*
+			* Postconditions: All iterators are invalidated.
+			*
+			* Returns: The number of edges added.
+			*
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist")
+			* if any src or dst is not a node. Nothing is inserted in that case.
+			*
+			* Complexity: O(n + k log(k) + k log(n) + d), where k is the number of edges in the batch and d is the total
+			* number of edges already stored on the nodes the batch touches.
+			*/
+			template<std::ranges::input_range EdgeRange>
+			auto insert_edges(EdgeRange const& edges) -> std::size_t {
+				[[maybe_unused]] const auto timer = time(graph_operation::insert_edges);
+				// Resolve every endpoint before touching the graph, so a missing node leaves it unchanged
+				auto outgoing_batch = std::vector<pending_record>();
+				if constexpr (std::ranges::sized_range<EdgeRange>) {
+					outgoing_batch.reserve(std::ranges::size(edges));
 				}
-
-				auto new_edge_ptr = create_edge_ptr(src, dst, weight);
-				if (existed_edge(g_[src].first, new_edge_ptr) or existed_edge(g_[dst].second, new_edge_ptr)) {
-					return false;
+				// Edge lists are usually grouped by src, so the last src lookup is reused while it still matches
+				auto src_it = state_->index.end();
+				const auto resolve = [&](auto const& src, auto const& dst, weight_type weight) {
+					if (src_it == state_->index.end() or src_it->first != src) {
+						src_it = locate(src);
+					}
+					const auto dst_it = locate(dst);
+					if (src_it == state_->index.end() or dst_it == state_->index.end()) {
+						throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist");
+					}
+					outgoing_batch.push_back(pending_record{src_it->second, edge_record{dst_it->second, std::move(weight)}});
+				};
+				for (const auto& element : edges) {
+					if constexpr (Policy == edge_policy::unweighted_only) {
+						const auto& [src, dst] = element;
+						resolve(src, dst, weight_type());
+					} else {
+						const auto& [src, dst, weight] = element;
+						resolve(src, dst, weight_type(weight));
+					}
 				}
-				
-				// The set will automatically order the edges based on the custom comparator
-				return g_[src].first.insert(new_edge_ptr).second and
- 				g_[dst].second.insert(new_edge_ptr).second;
-			};
+
+				return load_records(outgoing_batch);
+			}
 
 			/**
-			* Effects: Replaces the original data, old_data, stored at this particular node by the replacement data, new_data. 
+			* Effects: Replaces the original data, old_data, stored at this particular node by the replacement data, new_data.
 			* Does nothing if new_data already exists as a node.
 			*
 			* Postconditions: All iterators are invalidated.
@@ -414,62 +1273,73 @@ namespace gdwg {
 			* [Note: Unlike Assignment 2, the exception message must be used verbatim. —end note]
 			*
 			*/
-			auto move_node_data(N const& old_node, N const& new_node) -> void {
-				auto insert_new_edge = [this](const auto& edge_ptr, const N& src, const N& dst) {
-					edge_ptr->is_weighted()
-						? this->insert_edge(src, dst, edge_ptr->get_weight())
-						: this->insert_edge(src, dst);
-				};
-
-				// Handle outgoing edges
-				for (const auto& edge : g_[old_node].first)
-					insert_new_edge(edge, new_node, edge->get_nodes().second);
-
-				// Handle incoming edges
-				for (const auto& edge : g_[old_node].second)
-					insert_new_edge(edge, edge->get_nodes().first, new_node);
-
-				g_.erase(old_node);
-			}
-
 			auto replace_node(N const& old_data, N const& new_data) -> bool {
+				[[maybe_unused]] const auto timer = time(graph_operation::replace_node);
 				// Check src and dst existence first
 				if (!is_node(old_data)) {
 					throw std::runtime_error("Cannot call gdwg::graph<N, E>::replace_node on a node that doesn't exist");
 				}
-				
+
 				if (is_node(new_data)) {
 					return false;
 				}
-				
-				insert_node(new_data);
-				move_node_data(old_data, new_data);
+
+				note([&] { return node_replaced{old_data, new_data}; });
+
+				// Relabel in place: the node keeps its id, so no edge has to be rebuilt
+				build_incoming_index();
+				auto& state = writable();
+				const auto old_it = locate(old_data);
+				const auto id = old_it->second;
+				const auto new_it = state.index.emplace_hint(old_it, new_data, id);
+				state.nodes[id].value = &new_it->first;
+				if constexpr (fingerprinted) {
+					// Every edge of the node hashes its value, so they are all re-hashed with the new one
+					track_incident(id, false);
+					auto& digest = state.nodes[id].digest;
+					state.digest -= digest.hash;
+					digest.sum -= digest.hash;
+					digest.hash = node_hash(new_data);
+					state.digest += digest.hash;
+					digest.sum += digest.hash;
+					track_incident(id, true);
+				}
+				if constexpr (Index == index_policy::hashed) {
+					state.table.erase(old_data);
+					state.table.insert(new_it);
+				}
+				state.index.erase(old_it);
+				restore_order_around(id);
 				return true;
 			};
 
 			/**
-			* Effects: The node equivalent to old_data in the graph are replaced with instances of new_data. 
-			* After completing, every incoming and outgoing edge of old_data becomes an incoming/ougoing edge of new_data, 
+			* Effects: The node equivalent to old_data in the graph are replaced with instances of new_data.
+			* After completing, every incoming and outgoing edge of old_data becomes an incoming/ougoing edge of new_data,
 			* except that duplicate edges shall be removed.
-			* 
+			*
 			* Postconditions: All iterators are invalidated.
-			* 
-			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::merge_replace_node on old or new data if they don't exist in the graph") 
+			*
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::merge_replace_node on old or new data if they don't exist in the graph")
 			* if either of is_node(old_data) or is_node(new_data) are false.
-			* 
-			* 
+			*
+			*
 			*/
 			auto merge_replace_node(N const& old_data, N const& new_data) -> void {
+				[[maybe_unused]] const auto timer = time(graph_operation::merge_replace_node);
 				// Check src and dst existence first
 				if (!is_node(old_data) or !is_node(new_data)) {
 					throw std::runtime_error("Cannot call gdwg::graph<N, E>::merge_replace_node on old or new data if they don't exist in the graph");
 				}
-					
+
 				if (old_data == new_data) {
 					return;
 				}
-				move_node_data(old_data, new_data);
-			}; 
+				note([&] { return node_merged{old_data, new_data}; });
+				build_incoming_index();
+				writable();
+				move_node_data(locate(old_data), locate(new_data)->second);
+			};
 
 			/**
 			* Effects: Erases node equivalent to value, including all incoming and outgoing edges.
@@ -477,562 +1347,2828 @@ namespace gdwg {
 			* Postconditions: All iterators are invalidated.
 			*/
 			auto erase_node(N const& value) -> bool {
+				[[maybe_unused]] const auto timer = time(graph_operation::erase_node);
 				// Check if the node exists
 				if (!is_node(value)) {
 					return false;
 				}
+				note([&] { return node_erased{value}; });
+				build_incoming_index();
+				writable();
+				remove_node(locate(value));
+				return true;
+			}
 
-				// 1. Erase all incoming and outgoing edges of the node
-				g_[value].first.clear();  // Clear outgoing edges
-				g_[value].second.clear(); // Clear incoming edges
 
-				// 2. Go through all other nodes and remove edges associated with the deleted node
-				for (auto& [node, edge_sets] : g_) {
-					if (node != value) {
-						std::erase_if(edge_sets.first, 
-							[&value](const auto& edge) { return edge->get_nodes().second == value; });
-						std::erase_if(edge_sets.second, 
-							[&value](const auto& edge) { return edge->get_nodes().first == value; });
+			/**
+			* Effects: Erases every node in values, including all their incoming and outgoing edges, as if by calling
+			* erase_node on each of them. Values that are not nodes, or are repeated, are ignored.
+			*
+			* The lists of the surviving neighbours are each swept once for the whole batch, instead of once per
+			* erased node.
+			*
+			* Returns: The number of nodes removed.
+			* Postconditions: All iterators are invalidated.
+			* Complexity: O(k log(n) + n + d), where k is the number of values and d is the total number of edges
+			* stored on the erased nodes and their neighbours.
+			*/
+			template<std::ranges::input_range NodeRange>
+			auto erase_nodes(NodeRange const& values) -> std::size_t {
+				[[maybe_unused]] const auto timer = time(graph_operation::erase_nodes);
+				// 1. Mark the nodes to erase, without touching the storage unless there are any
+				auto doomed = std::vector<bool>(state_->nodes.size(), false);
+				auto victim_ids = std::vector<node_id>();
+				for (const auto& value : values) {
+					const auto node_it = locate(value);
+					if (node_it != state_->index.end() and !doomed[node_it->second]) {
+						doomed[node_it->second] = true;
+						victim_ids.push_back(node_it->second);
 					}
 				}
+				if (victim_ids.empty()) {
+					return 0;
+				}
+				// Ids survive both calls, index iterators do not
+				build_incoming_index();
+				auto& state = writable();
+				auto victims = std::vector<typename node_index::iterator>();
+				victims.reserve(victim_ids.size());
+				for (const auto id : victim_ids) {
+					victims.push_back(locate(value_of(id)));
+				}
 
-				// 3. Finally, erase the node itself
-				g_.erase(value);
+				// 2. Collect the surviving neighbours, then sweep each of their lists exactly once
+				auto neighbours = std::vector<node_id>();
+				for (const auto& node_it : victims) {
+					const auto& edges = edges_of(node_it->second);
+					for (const auto& record : edges.outgoing) {
+						neighbours.push_back(record.node);
+					}
+					state.num_edges -= edges.outgoing.size();
+					for (const auto& record : edges.incoming) {
+						neighbours.push_back(record.node);
+						// Edges out of the victims leave with their sub-fingerprints in release_node
+						if (!doomed[record.node]) {
+							track_edge(record.node, node_it->second, record.weight, false);
+							--state.num_edges;
+						}
+					}
+				}
+				std::sort(neighbours.begin(), neighbours.end());
+				neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+				const auto points_at_doomed = [&doomed](const edge_record& record) { return doomed[record.node]; };
+				for (const auto id : neighbours) {
+					if (!doomed[id]) {
+						auto& edges = writable_edges(id);
+						count(&live_stats::scanned_records, edges.outgoing.size() + edges.incoming.size());
+						std::erase_if(edges.outgoing, points_at_doomed);
+						std::erase_if(edges.incoming, points_at_doomed);
+						edges.distinct_out = count_distinct(edges.outgoing);
+					}
+				}
 
-				return true;
+				// 3. Finally, erase the nodes themselves
+				for (const auto& node_it : victims) {
+					note([&key = node_it->first] { return node_erased{key}; });
+					release_node(node_it);
+				}
+				return victims.size();
 			}
 
-
 			/**
-			* Effects: Erases the edge representing src → dst with the specified weight. 
-			* If weight is std::nullopt, it erases the unweighted_edge between src and dst. 
+			* Effects: Erases the edge representing src → dst with the specified weight.
+			* If weight is std::nullopt, it erases the unweighted_edge between src and dst.
 			* If weight has a value, it erases the weighted_edge between src and dst with the specified weight.
-			* 
+			* In a weighted_only graph weight is an E, and an unweighted_only graph only has erase_edge(src, dst).
+			*
 			* Returns: true if an edge was removed; false otherwise.
 			* Postconditions: All iterators are invalidated.
 			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they don't exist in the graph") if either is_node(src) or is_node(dst) is false.
 			* [Note: Unlike Assignment 2, the exception message must be used verbatim. —end note]
-			* Complexity: O(log( n) + e), where n is the total number of stored nodes and e is the total number of stored edges.
+			* Complexity: O(log(n) + e), where n is the total number of stored nodes and e is the number of outgoing and incoming edges of src and dst.
 			*/
-			auto erase_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
-				// Check if src and dst exist in the graph
-				if (!is_node(src) or !is_node(dst)) {
-					throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they don't exist in the graph");
-				}
-
-				// Handling out going edge
-				// Create a temporary edge for comparison
-				auto temp_edge_ptr = create_edge_ptr(src, dst, weight);
-
-				// Try to erase from outgoing edges of src
-				auto& outgoing_edges = g_[src].first;
-
-				// Define a lambda to compare edges based on their content, not their address
-				auto edge_content_equal = [&temp_edge_ptr](const edge_ptr& e) {
-					return *e == *temp_edge_ptr;
-				};
-
-				// Find the iterator to the edge we want to remove
-				auto it = std::find_if(outgoing_edges.begin(), outgoing_edges.end(), edge_content_equal);
-				if (it != outgoing_edges.end()) {
-					outgoing_edges.erase(it);
-				} else {
-					return false;
-				}
-
-				// Handling incomming edges
-				// Now erase from incoming edges of dst
-				auto& incoming_edges = g_[dst].second;
-				auto in_it = std::find_if(incoming_edges.begin(), incoming_edges.end(), edge_content_equal);
-				if (in_it != incoming_edges.end()) {
-					incoming_edges.erase(in_it);
-				} else {
-					return false;
-				}
+			auto erase_edge(N const& src, N const& dst, weight_type const& weight) -> bool
+			requires (Policy != edge_policy::unweighted_only) {
+				return erase_edge_value(src, dst, weight);
+			}
 
-				return true;
+			/**
+			* Effects: Erases the unweighted edge representing src → dst, as erase_edge(src, dst, std::nullopt).
+			* Not available in weighted_only graphs.
+			*/
+			auto erase_edge(N const& src, N const& dst) -> bool
+			requires (Policy != edge_policy::weighted_only) {
+				return erase_edge_value(src, dst, weight_type());
 			}
 
 
 			/**
 			* Effects: Erases the edge pointed to by i.
 			*
-			* Complexity: O(log (n) + e), where n is the total number of stored nodes 
-			* and e is the total number of stored edges. 
-			* [Note: This complexity requirement is slightly weaker 
+			* Complexity: O(log (n) + e), where n is the total number of stored nodes
+			* and e is the total number of stored edges.
+			* [Note: This complexity requirement is slightly weaker
 			* than a real-world container to help make the assignment easier. —end note]
 			*
-			* Returns: An iterator pointing to the element immediately after i 
-			* prior to the element being erased. 
+			* Returns: An iterator pointing to the element immediately after i
+			* prior to the element being erased.
 			* If no such element exists, returns end().
 			*
-			* Postconditions: All iterators are invalidated. 
-			* [Note: The postcondition is slightly stricter than a real-world container to help make the assignment easier (i.e. we won’t be testing any iterators post-erasure). —end note]
+			* Postconditions: All iterators are invalidated.
+			* [Note: The postcondition is slightly stricter than a real-world container to help make the assignment easier (i.e. we won’t be testing any iterators post-erasure). —end note]
 			*/
 			auto erase_edge(iterator i) -> iterator {
+				[[maybe_unused]] const auto timer = time(graph_operation::erase_edge);
 				if (i == end()) {
         			return end();
     			}
-				// Copy the edge where the iterator points to
-				auto src = (*i).from;
-				auto dst = (*i).to;
-				auto weight = (*i).weight;
-
-				// Get the iterator to the element after i
-				auto next = i;
-				++next;
-				// Erase the edge
-				if (erase_edge(src, dst, weight)) {
-					// If successful, return the iterator to the element after i
-					return next;
-				} else {
-					// If the edge wasn't found (which shouldn't happen), return the original iterator
-					return i;
-				}
+				const auto src = i.current_node_->second;
+				const auto& record = edges_of(src).outgoing[i.current_edge_];
+
+				// Erase the edge. If that made the storage our own, i still points into the shared index
+				const auto* shared_state = state_.get();
+				erase_edge_record(src, record.node, record.weight);
+				const auto node = state_.get() == shared_state ? i.current_node_ : locate(value_of(src));
+
+				// The element after i has shifted into the position i pointed to
+				auto next = iterator(node, i.current_edge_, this);
+				next.skip_empty_nodes();
+				return next;
 			};
 
 			/**
 			* Effects: Erases all edges between the iterators [i, s).
-			* Complexity O(d(log( n) + e)), where d = std::distance(i, s). 
-			* 
+			* Complexity O(d(log( n) + e)), where d = std::distance(i, s).
+			*
 			* Returns: An iterator equivalent to s prior to the items iterated through being erased. If no such element exists, returns end().
-			* 
-			* Postconditions: All iterators are invalidated. [Note: The postcondition is slightly stricter than a real-world container to help make the assignment easier (i.e. we won’t be testing any iterators post-erasure). —end note]
+			*
+			* Postconditions: All iterators are invalidated. [Note: The postcondition is slightly stricter than a real-world container to help make the assignment easier (i.e. we won’t be testing any iterators post-erasure). —end note]
 			*/
 			auto erase_edge(iterator i, iterator s) -> iterator {
+				[[maybe_unused]] const auto timer = time(graph_operation::erase_edge);
 				if (i == s) {
 					return s;
 				}
 				if (i == end()) {
 					return i;
 				}
-				// Loop until see s
-				while (i != s) {
+				// Count first, since erasing shifts the edges s may point into
+				auto count = std::size_t{0};
+				for (auto it = i; it != s and it != end(); ++it) {
+					++count;
+				}
+				for (; count > 0; --count) {
 					i = erase_edge(i);
-					if (i == end()) {
-            			return end();
-        			}
 				}
 				return i;
 			};
 
 			/**
 			* Effects: Erases all nodes from the graph.
-			* Postconditions: empty() is true.
+			* Postconditions: empty() is true, and so is has_incoming_index().
 			*/
 			auto clear() noexcept -> void {
-				g_.clear();
-			};
-			
-			// Returns: An iterator pointing to the first element in the container.
-			[[nodiscard]] auto begin() const -> iterator {
-				// auto it = iterator();
-				// it = it.begin(this);
-				// return it;
-				return graph<N, E>::iterator::begin(this);
+				[[maybe_unused]] const auto timer = time(graph_operation::clear);
+				state_ = empty_storage();
+				note([] { return cleared{}; });
 			};
 
 			/**
-			* Returns: An iterator denoting the end of the iterable list 
-			* that begin() points to.
-			* Remarks: [begin(), end()) shall denote a valid iterable list. 
+			* Effects: Drops the index of edges by dst, and stops maintaining it, for graphs that are built once
+			* and then only queried through outgoing edges. Inserting and erasing edges then touches only the
+			* list of src, which halves the memory and the work spent on edge records.
+			*
+			* The index is rebuilt by build_incoming_index(), which erase_node, erase_nodes, replace_node,
+			* merge_replace_node and the non-const in_edges call first, and is kept up to date from then on.
+			* in_degree and the const in_edges scan every outgoing list instead while it is deferred.
+			*
+			* Postconditions: has_incoming_index() is false. The graph compares equal to what it was.
+			* Complexity: O(n + e), where n is the number of stored nodes and e is the number of stored edges.
 			*/
-			[[nodiscard]] auto end() const -> iterator {
-				// auto it = iterator();
-				// it = it.end(this);
-				// return it;
-				return graph<N, E>::iterator::end(this);
-			};
+			auto defer_incoming_index() -> void {
+				if (!state_->incoming_indexed) {
+					return;
+				}
+				auto& state = writable();
+				for (auto id = node_id{0}; id < state.nodes.size(); ++id) {
+					if (state.nodes[id].value != nullptr and !edges_of(id).incoming.empty()) {
+						auto& incoming_edges = writable_edges(id).incoming;
+						incoming_edges.clear();
+						incoming_edges.shrink_to_fit();
+					}
+				}
+				state.incoming_indexed = false;
+			}
 
+			/**
+			* Effects: Rebuilds the index of edges by dst if it was deferred, see defer_incoming_index().
+			* Postconditions: has_incoming_index() is true.
+			* Complexity: O(n + e), and O(1) if the index is already built.
+			*/
+			auto build_incoming_index() -> void {
+				if (state_->incoming_indexed) {
+					return;
+				}
+				// Own every list that gains records first, then fill them by walking the srcs in ascending
+				// order, so that each incoming list comes out sorted by src and then by weight
+				auto& state = writable();
+				auto in_counts = std::vector<std::size_t>(state.nodes.size(), 0);
+				for (auto id = node_id{0}; id < state.nodes.size(); ++id) {
+					if (state.nodes[id].value != nullptr) {
+						for (const auto& record : edges_of(id).outgoing) {
+							++in_counts[record.node];
+						}
+					}
+				}
+				for (auto id = node_id{0}; id < state.nodes.size(); ++id) {
+					if (in_counts[id] != 0) {
+						writable_edges(id).incoming.reserve(in_counts[id]);
+					}
+				}
+				for (const auto& [value, src] : state.index) {
+					for (const auto& record : edges_of(src).outgoing) {
+						state.nodes[record.node].edges->incoming.push_back(edge_record{src, record.weight});
+					}
+				}
+				state.incoming_indexed = true;
+			}
 
 			/**
-			* Returns: true if a node equivalent to value exists in the graph, and false otherwise.
-			* Complexity: O(log n) time.
+			* Returns: true unless the index of edges by dst is deferred, see defer_incoming_index().
+			* Complexity: O(1)
 			*/
-	 		[[nodiscard]] auto is_node(N const& value) const noexcept -> bool {
-				return g_.find(value) != g_.end();
-			};
-		
+			[[nodiscard]] auto has_incoming_index() const noexcept -> bool {
+				return state_->incoming_indexed;
+			}
+
 			/**
-			 * Returns: true if there are no nodes in the graph, and false otherwise
-			 */
-			[[nodiscard]] auto empty() const noexcept -> bool {
-				return g_.empty();
-			};
+			* Effects: Starts recording every mutation of this graph object as a typed event, see mutation, in a
+			* ring buffer of capacity events, for replicas and derived indices to drain and replay. Events pending
+			* from an earlier call are discarded. If more than capacity events are pending, they are all replaced
+			* by a single reset, and nothing more is recorded until it is drained.
+			*
+			* Mutators record one event per change, as named by the event types; erase_nodes, insert_edges and
+			* erase_edge(i, s) record one for each node or edge they change. A mutation that changes nothing,
+			* such as inserting an edge that exists, records nothing. Assignment and transform_weights record reset.
+			*
+			* Complexity: O(capacity), to reserve the buffer. Recording an event copies its values, and never allocates
+			* anything else.
+			*/
+			auto record_mutations(std::size_t capacity) -> void {
+				log_ = std::make_unique<mutation_log>(capacity);
+			}
 
 			/**
-			* Returns: true if an edge src → dst exists in the graph, and false otherwise.
-			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the graph") 
-			* if either of is_node(src) or is_node(dst) are false. [Note: Unlike Assignment 2, the exception message must be used verbatim. —end note]
+			* Effects: Stops recording mutations and discards the pending events.
 			*/
-			[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
-				// Check src and dst existence first
-				if (!is_node(src) or !is_node(dst)) {
-					throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the graph");
-				}
+			auto stop_recording_mutations() noexcept -> void {
+				log_.reset();
+			}
 
-				return std::any_of(g_.at(src).first.begin(), g_.at(src).first.end(),
-					[&dst](const auto& edge_ptr) {
-						return edge_ptr->get_nodes().second == dst;
-					}
-				);
-			};
+			/**
+			* Effects: Removes up to max of the oldest pending events from the mutation log.
+			* Returns: The events removed, oldest first. Empty if mutations are not being recorded.
+			*/
+			[[nodiscard]] auto drain_mutations(std::size_t max = std::numeric_limits<std::size_t>::max()) -> std::vector<mutation> {
+				if (!log_) {
+					return {};
+				}
+				return log_->drain(max);
+			}
 
 			/**
-			* Returns: A sequence of all stored nodes, sorted in ascending order.
-			* Complexity: O(n), where n is the number of stored nodes. 
+			* Returns: The number of events waiting to be drained.
 			*/
-			[[nodiscard]] auto nodes() const noexcept -> std::vector<N> {
-				std::vector<N> nodes_vector;
-				nodes_vector.reserve(g_.size());
-				std::for_each(g_.begin(), g_.end(),
-					[&nodes_vector](const auto& pair) {
-						nodes_vector.push_back(pair.first);
-					}
-				);
-				return nodes_vector;
-			};
+			[[nodiscard]] auto pending_mutations() const noexcept -> std::size_t {
+				return log_ ? log_->size() : 0;
+			}
 
 			/**
-			* Returns: A sequence of edges from src to dst, start with the unweighted edge (if exists), 
-			* then the rest of the weighted edges are sorted in ascending order.
-			* 
-			* Complexity: O(log n + e), where n is the number of stored nodes and eis the number of stored edges.
-			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::edges if src or dst node don't exist in the graph") if either of is_node(src) or is_node(dst) are false. [Note: Unlike Assignment 2, the exception message must be used verbatim. —end note]
+			* Returns: A snapshot of the instrumentation counters of this graph object since it was constructed or
+			* reset_stats() was last called: index probes, edge record comparisons, allocations, linear scan lengths
+			* and a latency histogram of each graph_operation. Copies and moves start their own counters.
+			* All zeros unless the program is built with GDWG_INSTRUMENT=1, see gdwg::instrumented.
+			*
+			* Counters are read one at a time, so a snapshot taken while other threads read the graph may be
+			* mid-update.
 			*/
-			[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<std::unique_ptr<edge<N,E>>> {
-				// Check src and dst existence first
-				if (!is_node(src) or !is_node(dst)) {
-					throw std::runtime_error("Cannot call gdwg::graph<N, E>::edges if src or dst node don't exist in the graph");
-				}
-				std::vector<std::unique_ptr<edge<N,E>>> edges_ptr_vector;
-				std::for_each(g_.at(src).first.begin(), g_.at(src).first.end(), [&](const auto& edge_ptr) {
-					if (edge_ptr->get_nodes().second == dst) {
-						if (edge_ptr->is_weighted()) {
-							edges_ptr_vector.push_back(std::make_unique<gdwg::weighted_edge<N, E>>(
-								edge_ptr->get_nodes().first, edge_ptr->get_nodes().second, edge_ptr->get_weight().value()));
-						} else {
-							edges_ptr_vector.push_back(std::make_unique<gdwg::unweighted_edge<N, E>>(
-								edge_ptr->get_nodes().first, edge_ptr->get_nodes().second));
+			[[nodiscard]] auto stats() const noexcept -> graph_stats {
+				auto snapshot = graph_stats();
+				if constexpr (instrumented) {
+					const auto load = [](std::atomic<std::uint64_t> const& counter) {
+						return counter.load(std::memory_order_relaxed);
+					};
+					snapshot.index_probes = load(stats_->index_probes);
+					snapshot.comparisons = load(stats_->comparisons);
+					snapshot.allocations = load(stats_->allocations);
+					snapshot.scanned_records = load(stats_->scanned_records);
+					for (auto op = std::size_t{0}; op < snapshot.operations.size(); ++op) {
+						const auto& live = stats_->operations[op];
+						auto& latency = snapshot.operations[op];
+						latency.calls = load(live.calls);
+						latency.total_ns = load(live.total_ns);
+						for (auto b = std::size_t{0}; b < graph_stats::num_buckets; ++b) {
+							latency.buckets[b] = load(live.buckets[b]);
 						}
 					}
-				});
-				return edges_ptr_vector;
-			};
+				}
+				return snapshot;
+			}
 
 			/**
-			* Returns: An iterator pointing to an edge equivalent to the specified src, dst, and weight. 
-			* If weight is std::nullopt, it searches for an unweighted_edge between src and dst. 
-			* If weight has a value, it searches for a weighted_edge between src and dst with the specified weight. Returns end() if no such edge exists.
-			* Complexity:  O(log(n) + e), where n is the number of stored nodes and e is the number of edges (either weighted or unweighted) between src and dst.
-			* Assume that dst and src given are valid
+			* Effects: Sets every instrumentation counter of this graph back to zero.
+			* Precondition: No other thread uses the graph.
 			*/
-			[[nodiscard]] auto find(N const& src, N const& dst, std::optional<E> weight = std::nullopt) const noexcept -> iterator {
-				// Define a lambda to compare edges based on their content, not their address
-				if (!is_node(src) or !is_node(dst)) {
-					return end();
-				}
-				const auto& edges_ptr_set = g_.find(src)->second.first;
-				const auto find_edge_ptr = create_edge_ptr(src, dst, weight);
-				const auto edge_content_equal = [&find_edge_ptr](const edge_ptr& e) {
-					return *e == *find_edge_ptr;
-				};
-
-				auto it = std::find_if(edges_ptr_set.begin(), edges_ptr_set.end(), edge_content_equal);
-				if (it == edges_ptr_set.end()) {
-					return end();
-				} else {
-					return iterator(g_.find(src), it , this);
+			auto reset_stats() noexcept -> void {
+				if constexpr (instrumented) {
+					stats_ = std::make_unique<live_stats>();
 				}
-			};
+			}
 
 			/**
-			* Returns: All nodes (found from any immediate outgoing edge) connected to src, sorted in ascending order. This returns copies of the specified data.
+			* Effects: Replays event on this graph by calling the mutator that recorded it with the same arguments,
+			* so that applying the events drained from another graph, in order, brings a copy of it up to date.
 			*
-			* Complexity: O(log (n) + e), where e is the number of outgoing edges associated with src.
-			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't exist in the graph") if is_node(src) is false. [Note: Unlike Assignment 2, the exception message must be used verbatim. —end note]
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::apply on a reset mutation") if event is a reset.
+			* Anything the replayed mutator throws, for instance when this graph was not a copy of the recording one.
 			*/
-			[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
-				// Check if src exists in the graph
-				if (!is_node(src)) {
-					throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't exist in the graph");
-				}
-
-				// Set to store unique destinations
-				std::set<N> unique_dests;
+			auto apply(mutation const& event) -> void {
+				std::visit([this](auto const& e) {
+					using event_type = std::remove_cvref_t<decltype(e)>;
+					if constexpr (std::is_same_v<event_type, node_inserted>) {
+						insert_node(e.value);
+					} else if constexpr (std::is_same_v<event_type, node_erased>) {
+						erase_node(e.value);
+					} else if constexpr (std::is_same_v<event_type, node_replaced>) {
+						replace_node(e.old_value, e.new_value);
+					} else if constexpr (std::is_same_v<event_type, node_merged>) {
+						merge_replace_node(e.old_value, e.new_value);
+					} else if constexpr (std::is_same_v<event_type, edge_inserted>) {
+						insert_edge_value(e.from, e.to, e.weight);
+					} else if constexpr (std::is_same_v<event_type, edge_erased>) {
+						erase_edge_value(e.from, e.to, e.weight);
+					} else if constexpr (std::is_same_v<event_type, cleared>) {
+						clear();
+					} else {
+						throw std::runtime_error("Cannot call gdwg::graph<N, E>::apply on a reset mutation");
+					}
+				}, event);
+			}
 
-				// Iterate through outgoing edges
-				std::transform(
-					g_.at(src).first.begin(),
-					g_.at(src).first.end(),
-					std::inserter(unique_dests, unique_dests.end()),
-					[](const auto& edge_ptr) { return edge_ptr->get_nodes().second; }
-				);
+			/**
+			 * Returns: The allocator the graph allocates its storage from. Copies and moves keep the allocator
+			 * of their source, while assignment keeps the allocator of *this, as std::pmr containers do. Storage
+			 * an assignment shares with its source stays in the source's resource until *this modifies it.
+			 */
+			[[nodiscard]] auto get_allocator() const noexcept -> allocator_type {
+				return alloc_;
+			}
 
-				// Convert set to vector
-				return std::vector<N>(unique_dests.begin(), unique_dests.end());
+			// Returns: An iterator pointing to the first element in the container.
+			[[nodiscard]] auto begin() const -> iterator {
+				// auto it = iterator();
+				// it = it.begin(this);
+				// return it;
+				return iterator::begin(this);
 			};
 
-			[[nodiscard]] auto operator==(graph const& other) const -> bool {
-				// Compare the size of the two maps first
-				if (g_.size() != other.g_.size()) {
+			/**
+			* Returns: An iterator denoting the end of the iterable list
+			* that begin() points to.
+			* Remarks: [begin(), end()) shall denote a valid iterable list.
+			*/
+			[[nodiscard]] auto end() const -> iterator {
+				// auto it = iterator();
+				// it = it.end(this);
+				// return it;
+				return iterator::end(this);
+			};
+
+
+			/**
+			* Returns: A forward range over every edge, as iterator::value_type, in no particular order: nodes are
+			* visited in the order of their internal ids, and each node's edges in sorted order.
+			* It walks the node slots and edge lists linearly instead of the sorted index, so it is the fastest
+			* way to scan every edge, and works with std::ranges and the parallel algorithms.
+			* Mutating the graph invalidates the range and its iterators.
+			*
+			* Complexity: O(1), and O(n + e) for a full pass.
+			*/
+			[[nodiscard]] auto edges_unordered() const noexcept -> unordered_edges {
+				return unordered_edges(state_.get());
+			}
+
+			/**
+			* Effects: Calls fn(src, dst, weight) for every edge, in no particular order, where weight is a
+			* weight_type const&. In an unweighted_only graph fn is called as fn(src, dst).
+			*
+			* Complexity: O(n + e)
+			*/
+			template<typename Fn>
+			auto for_each_edge(Fn fn) const -> void {
+				visit_edges(0, state_->nodes.size(), fn);
+			}
+
+			/**
+			* Effects: As for_each_edge(fn), with the nodes split between up to threads threads, or one per
+			* hardware thread if threads is 0. Calls of fn for edges of different src nodes may run at the
+			* same time, so fn must be safe to call concurrently. The graph must not be mutated meanwhile.
+			*
+			* Throws: The first exception thrown by fn, once every thread has stopped.
+			*
+			* Complexity: O((n + e) / threads) on each thread.
+			*/
+			template<typename Fn>
+			auto parallel_for_each_edge(Fn fn, std::size_t threads = 0) const -> void {
+				for_each_node_block(threads, [this, &fn](std::size_t begin, std::size_t end) { visit_edges(begin, end, fn); });
+			}
+
+			/**
+			* Effects: Replaces the weight w of every weighted edge by fn(w). Edges that end up equal to
+			* another edge between the same nodes are merged, as insert_edge would have, and unweighted edges
+			* are left alone. Not available in unweighted_only graphs.
+			*
+			* fn is called once for each side of an edge, so it must be a pure function of the weight.
+			*
+			* Postconditions: All iterators are invalidated.
+			*
+			* Throws: Whatever fn throws. The graph is then unchanged.
+			*
+			* Complexity: O(n + e log(d)), where d is the largest degree.
+			*/
+			template<typename Fn>
+			auto transform_weights(Fn fn) -> void
+			requires (Policy != edge_policy::unweighted_only) {
+				parallel_transform_weights(std::move(fn), 1);
+			}
+
+			/**
+			* Effects: As transform_weights(fn), with the nodes split between up to threads threads, or one per
+			* hardware thread if threads is 0. fn must be safe to call concurrently.
+			*
+			* Throws: The first exception thrown by fn, once every thread has stopped. The graph is then unchanged.
+			* Unless fn is noexcept, the lists are rewritten in a copy to make that possible.
+			*
+			* Postconditions: All iterators are invalidated.
+			*/
+			template<typename Fn>
+			auto parallel_transform_weights(Fn fn, std::size_t threads = 0) -> void
+			requires (Policy != edge_policy::unweighted_only) {
+				[[maybe_unused]] const auto timer = time(graph_operation::transform_weights);
+				if constexpr (std::is_nothrow_invocable_v<Fn&, E const&>) {
+					rewrite_weights(fn, threads);
+				} else {
+					// The new weights are written into a copy, so that a throwing fn leaves *this untouched
+					auto result = graph(*this);
+					result.rewrite_weights(fn, threads);
+					std::swap(state_, result.state_);
+				}
+				note([] { return reset{}; });
+			}
+
+			/**
+			* Returns: *this == other, comparing the edges of different nodes on up to threads threads, or one
+			* per hardware thread if threads is 0.
+			*
+			* Complexity: O(n + e / threads)
+			*/
+			[[nodiscard]] auto parallel_equal(graph const& other, std::size_t threads = 0) const -> bool {
+				[[maybe_unused]] const auto timer = time(graph_operation::equal);
+				if (state_ == other.state_) {
+					return true;
+				}
+				if (state_->index.size() != other.state_->index.size()) {
+					return false;
+				}
+				if constexpr (fingerprinted) {
+					if (state_->digest != other.state_->digest) {
+						return false;
+					}
+				}
+				// Pair the nodes up in sorted order; their ids differ between the graphs
+				auto pairs = std::vector<std::pair<node_id, node_id>>();
+				pairs.reserve(state_->index.size());
+				for (auto it = state_->index.begin(), other_it = other.state_->index.begin(); it != state_->index.end(); ++it, ++other_it) {
+					if (it->first != other_it->first) {
+						return false;
+					}
+					pairs.emplace_back(it->second, other_it->second);
+				}
+
+				auto equal = std::atomic<bool>(true);
+				if (threads == 0) {
+					threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+				}
+				run_parallel(threads, pairs.size(), 1, [&](std::size_t, std::size_t begin, std::size_t end) {
+					for (auto i = begin; i < end and equal.load(std::memory_order_relaxed); ++i) {
+						const auto& edges = edges_of(pairs[i].first).outgoing;
+						const auto& other_edges = other.edges_of(pairs[i].second).outgoing;
+						const auto same = [this, &other](const edge_record& a, const edge_record& b) {
+							return a.weight == b.weight and value_of(a.node) == other.value_of(b.node);
+						};
+						if (!std::equal(edges.begin(), edges.end(), other_edges.begin(), other_edges.end(), same)) {
+							equal.store(false, std::memory_order_relaxed);
+						}
+					}
+				});
+				return equal.load();
+			}
+
+			/**
+			* Returns: true if a node equivalent to value exists in the graph, and false otherwise.
+			* Complexity: O(log n) time, O(1) expected in hashed graphs.
+			*/
+	 		[[nodiscard]] auto is_node(N const& value) const noexcept -> bool {
+				[[maybe_unused]] const auto timer = time(graph_operation::is_node);
+				return locate(value) != state_->index.end();
+			};
+
+			/**
+			 * Returns: true if there are no nodes in the graph, and false otherwise
+			 */
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return state_->index.empty();
+			};
+
+			/**
+			* Returns: The number of nodes in the graph.
+			* Complexity: O(1)
+			*/
+			[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+				return state_->index.size();
+			}
+
+			/**
+			* Returns: The number of edges in the graph, kept up to date by every mutator.
+			* Complexity: O(1)
+			*/
+			[[nodiscard]] auto num_edges() const noexcept -> std::size_t {
+				return state_->num_edges;
+			}
+
+			/**
+			* Returns: The number of edges out of src, counting each weight separately.
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::out_degree if src doesn't exist in the graph") if is_node(src) is false.
+			* Complexity: O(log(n)), O(1) expected in hashed graphs
+			*/
+			[[nodiscard]] auto out_degree(N const& src) const -> std::size_t {
+				return adjacency_of(src, "Cannot call gdwg::graph<N, E>::out_degree if src doesn't exist in the graph").outgoing.size();
+			}
+
+			/**
+			* Returns: The number of edges into dst, counting each weight separately.
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::in_degree if dst doesn't exist in the graph") if is_node(dst) is false.
+			* Complexity: O(log(n)), O(1) expected in hashed graphs. O(n log(e)) while the incoming index is deferred.
+			*/
+			[[nodiscard]] auto in_degree(N const& dst) const -> std::size_t {
+				const auto& edges = adjacency_of(dst, "Cannot call gdwg::graph<N, E>::in_degree if dst doesn't exist in the graph");
+				if (state_->incoming_indexed) {
+					return edges.incoming.size();
+				}
+				auto degree = std::size_t{0};
+				scan_incoming(dst, [&degree](node_id, const edge_record&) { ++degree; });
+				return degree;
+			}
+
+			/**
+			* Returns: Every edge into dst, as iterator::value_type, sorted by src and then by weight as the
+			* graph's iterators visit them.
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::in_edges if dst doesn't exist in the graph") if is_node(dst) is false.
+			* Complexity: O(log(n) + d), where d is in_degree(dst). O(n log(e) + d) while the incoming index is deferred.
+			*/
+			[[nodiscard]] auto in_edges(N const& dst) const -> std::vector<typename iterator::value_type> {
+				const auto& edges = adjacency_of(dst, "Cannot call gdwg::graph<N, E>::in_edges if dst doesn't exist in the graph");
+				auto result = std::vector<typename iterator::value_type>();
+				const auto push = [this, &result, &dst](node_id src, const edge_record& record) {
+					if constexpr (Policy == edge_policy::unweighted_only) {
+						result.push_back({value_of(src), dst});
+					} else {
+						result.push_back({value_of(src), dst, record.weight});
+					}
+				};
+				if (state_->incoming_indexed) {
+					result.reserve(edges.incoming.size());
+					for (const auto& record : edges.incoming) {
+						push(record.node, record);
+					}
+				} else {
+					scan_incoming(dst, push);
+				}
+				return result;
+			}
+
+			/**
+			* Effects: Builds the incoming index first if it was deferred, see build_incoming_index().
+			* Returns: The same edges as the const overload.
+			*/
+			[[nodiscard]] auto in_edges(N const& dst) -> std::vector<typename iterator::value_type> {
+				if (is_node(dst)) {
+					build_incoming_index();
+				}
+				return std::as_const(*this).in_edges(dst);
+			}
+
+			/**
+			* Returns: The number of distinct nodes src has an edge to, connections(src).size().
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::distinct_out_neighbours if src doesn't exist in the graph") if is_node(src) is false.
+			* Complexity: O(log(n)), O(1) expected in hashed graphs
+			*/
+			[[nodiscard]] auto distinct_out_neighbours(N const& src) const -> std::size_t {
+				return adjacency_of(src, "Cannot call gdwg::graph<N, E>::distinct_out_neighbours if src doesn't exist in the graph").distinct_out;
+			}
+
+			/**
+			* Returns: true if an edge src → dst exists in the graph, and false otherwise.
+			* Complexity: O(log(n) + log(e)), where e is the number of outgoing edges of src, and O(log(e)) expected
+			* in hashed graphs.
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the graph")
+			* if either of is_node(src) or is_node(dst) are false. [Note: Unlike Assignment 2, the exception message must be used verbatim. —end note]
+			*/
+			[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+				[[maybe_unused]] const auto timer = time(graph_operation::is_connected);
+				// Check src and dst existence first
+				if (!is_node(src) or !is_node(dst)) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the graph");
+				}
+
+				const auto& outgoing_edges = out_edges(src);
+				return std::binary_search(outgoing_edges.begin(), outgoing_edges.end(), node_key{dst}, record_order());
+			};
+
+			/**
+			* Returns: A sequence whose i-th element is is_connected(src, dsts[i]).
+			*
+			* src is looked up once, and the probes are sorted by value and matched against its outgoing edges in one
+			* forward pass that gallops over runs of edges no probe asks for, instead of one binary search per probe.
+			*
+			* Complexity: O(log(n) + k log(n) + k log(k) + k log(e / k)), where k is the number of probes and e is the
+			* number of outgoing edges of src. The sort is skipped if dsts is already in ascending order.
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the graph")
+			* if is_node(src) is false or is_node(dst) is false for any dst in dsts.
+			*/
+			[[nodiscard]] auto is_connected(N const& src, std::span<N const> dsts) const -> std::vector<bool> {
+				[[maybe_unused]] const auto timer = time(graph_operation::is_connected);
+				const auto src_it = locate(src);
+				if (src_it == state_->index.end()) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the graph");
+				}
+				auto dst_ids = std::vector<node_id>();
+				dst_ids.reserve(dsts.size());
+				for (const auto& dst : dsts) {
+					const auto dst_it = locate(dst);
+					if (dst_it == state_->index.end()) {
+						throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the graph");
+					}
+					dst_ids.push_back(dst_it->second);
+				}
+
+				// Visit the probes in ascending order of dst, so the cursor into the edge list only moves forwards
+				auto probe_order = std::vector<std::size_t>(dsts.size());
+				std::iota(probe_order.begin(), probe_order.end(), std::size_t{0});
+				if (!std::is_sorted(dsts.begin(), dsts.end())) {
+					std::sort(probe_order.begin(), probe_order.end(), [&](std::size_t a, std::size_t b) {
+						return dsts[a] < dsts[b];
+					});
+				}
+
+				const auto order = record_order();
+				const auto& outgoing_edges = edges_of(src_it->second).outgoing;
+				auto connected = std::vector<bool>(dsts.size());
+				auto cursor = outgoing_edges.begin();
+				for (const auto i : probe_order) {
+					cursor = gallop(cursor, outgoing_edges.end(), node_key{dsts[i]}, order);
+					connected[i] = cursor != outgoing_edges.end() and cursor->node == dst_ids[i];
+				}
+				return connected;
+			}
+
+			/**
+			* Returns: A sequence of all stored nodes, sorted in ascending order.
+			* Complexity: O(n), where n is the number of stored nodes.
+			*/
+			[[nodiscard]] auto nodes() const noexcept -> std::vector<N> {
+				[[maybe_unused]] const auto timer = time(graph_operation::nodes);
+				std::vector<N> nodes_vector;
+				nodes_vector.reserve(state_->index.size());
+				std::for_each(state_->index.begin(), state_->index.end(),
+					[&nodes_vector](const auto& pair) {
+						nodes_vector.push_back(pair.first);
+					}
+				);
+				return nodes_vector;
+			};
+
+			/**
+			* Returns: A sequence of edges from src to dst, start with the unweighted edge (if exists),
+			* then the rest of the weighted edges are sorted in ascending order.
+			*
+			* Complexity: O(log n + e), where n is the number of stored nodes and eis the number of stored edges.
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::edges if src or dst node don't exist in the graph") if either of is_node(src) or is_node(dst) are false. [Note: Unlike Assignment 2, the exception message must be used verbatim. —end note]
+			*/
+			[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<std::unique_ptr<edge<N,E>>> {
+				[[maybe_unused]] const auto timer = time(graph_operation::edges);
+				// Check src and dst existence first
+				if (!is_node(src) or !is_node(dst)) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::edges if src or dst node don't exist in the graph");
+				}
+				// Edge objects are only created here, internally only records are stored
+				std::vector<std::unique_ptr<edge<N,E>>> edges_ptr_vector;
+				const auto& outgoing_edges = out_edges(src);
+				const auto [first, last] = std::equal_range(outgoing_edges.begin(), outgoing_edges.end(), node_key{dst}, record_order());
+				std::for_each(first, last, [&](const edge_record& record) {
+					if (const auto* weight = weight_of(record)) {
+						edges_ptr_vector.push_back(std::make_unique<gdwg::weighted_edge<N, E>>(src, dst, *weight));
+					} else {
+						edges_ptr_vector.push_back(std::make_unique<gdwg::unweighted_edge<N, E>>(src, dst));
+					}
+				});
+				return edges_ptr_vector;
+			};
+
+			/**
+			* Returns: An iterator pointing to an edge equivalent to the specified src, dst, and weight.
+			* If weight is std::nullopt, it searches for an unweighted_edge between src and dst.
+			* If weight has a value, it searches for a weighted_edge between src and dst with the specified weight. Returns end() if no such edge exists.
+			* In a weighted_only graph weight is an E, and an unweighted_only graph only has find(src, dst).
+			* Complexity: O(log(n) + log(e)), where n is the number of stored nodes and e is the number of outgoing edges of src,
+			* and O(log(e)) expected in hashed graphs.
+			* Assume that dst and src given are valid
+			*/
+			[[nodiscard]] auto find(N const& src, N const& dst, weight_type const& weight) const noexcept -> iterator
+			requires (Policy != edge_policy::unweighted_only) {
+				return find_value(src, dst, weight);
+			}
+
+			/**
+			* Returns: find(src, dst, std::nullopt), the unweighted edge src → dst or end().
+			* Not available in weighted_only graphs.
+			*/
+			[[nodiscard]] auto find(N const& src, N const& dst) const noexcept -> iterator
+			requires (Policy != edge_policy::weighted_only) {
+				return find_value(src, dst, weight_type());
+			}
+
+			/**
+			* Returns: A sequence whose i-th element is the iterator find returns for the i-th (src, dst, weight) probe,
+			* or end() if there is no such edge. In an unweighted_only graph probes are (src, dst) pairs.
+			*
+			* The probes are sorted into the order of the edge lists, so src is looked up once per run of probes
+			* from it and its edge list is searched in one forward pass that gallops over runs of edges no probe
+			* asks for. dst is never looked up: an edge to it can only be found if it is a node.
+			*
+			* Complexity: O(k log(k) + s log(n) + the sum over each src of k_src log(e_src / k_src)), where k is the
+			* number of probes, s is the number of distinct srcs among them, k_src is the number of probes from src and
+			* e_src is the number of outgoing edges of src. The sort is skipped if the probes are already in ascending
+			* order, and otherwise dominates when few probes share a src.
+			*/
+			template<std::ranges::input_range ProbeRange>
+			[[nodiscard]] auto find_many(ProbeRange const& probes) const -> std::vector<iterator> {
+				[[maybe_unused]] const auto timer = time(graph_operation::find);
+				using element_type = std::ranges::range_reference_t<ProbeRange const>;
+				// The batch points into the probes, so they must be stored values of the graph's own types
+				if constexpr (!std::is_lvalue_reference_v<element_type>
+				              or !std::same_as<std::remove_cvref_t<std::tuple_element_t<0, std::remove_cvref_t<element_type>>>, N>
+				              or !std::same_as<std::remove_cvref_t<std::tuple_element_t<1, std::remove_cvref_t<element_type>>>, N>) {
+					auto stored = std::vector<std::conditional_t<Policy == edge_policy::unweighted_only,
+					                                             std::pair<N, N>,
+					                                             std::tuple<N, N, weight_type>>>();
+					for (const auto& element : probes) {
+						if constexpr (Policy == edge_policy::unweighted_only) {
+							const auto& [src, dst] = element;
+							stored.emplace_back(src, dst);
+						} else {
+							const auto& [src, dst, weight] = element;
+							stored.emplace_back(src, dst, weight_type(weight));
+						}
+					}
+					return find_many(stored);
+				} else {
+					struct probe {
+						N const* src;
+						N const* dst;
+						weight_type weight;
+						std::size_t position;
+					};
+					auto batch = std::vector<probe>();
+					if constexpr (std::ranges::sized_range<ProbeRange>) {
+						batch.reserve(std::ranges::size(probes));
+					}
+					for (const auto& element : probes) {
+						if constexpr (Policy == edge_policy::unweighted_only) {
+							const auto& [src, dst] = element;
+							batch.push_back(probe{&src, &dst, weight_type(), batch.size()});
+						} else {
+							const auto& [src, dst, weight] = element;
+							batch.push_back(probe{&src, &dst, weight_type(weight), batch.size()});
+						}
+					}
+
+					// Group by src, and within a group follow the order of the edge list itself
+					const auto before = [](probe const& a, probe const& b) {
+						if (*a.src != *b.src) {
+							return *a.src < *b.src;
+						}
+						if (*a.dst != *b.dst) {
+							return *a.dst < *b.dst;
+						}
+						return a.weight < b.weight;
+					};
+					if (!std::is_sorted(batch.begin(), batch.end(), before)) {
+						std::sort(batch.begin(), batch.end(), before);
+					}
+
+					auto found = std::vector<iterator>(batch.size(), end());
+					const auto order = record_order();
+					for (auto group = batch.begin(); group != batch.end();) {
+						const auto src_it = locate(*group->src);
+						const auto& outgoing_edges = src_it == state_->index.end() ? iterator::no_edges() : edges_of(src_it->second).outgoing;
+						const auto& src = *group->src;
+						auto cursor = outgoing_edges.begin();
+						for (; group != batch.end() and *group->src == src; ++group) {
+							const auto key = record_key{*group->dst, group->weight};
+							cursor = gallop(cursor, outgoing_edges.end(), key, order);
+							if (cursor != outgoing_edges.end() and order.compare(*cursor, key) == 0) {
+								found[group->position] = iterator(src_it, static_cast<std::size_t>(cursor - outgoing_edges.begin()), this);
+							}
+						}
+					}
+					return found;
+				}
+			}
+
+			/**
+			* Returns: All nodes (found from any immediate outgoing edge) connected to src, sorted in ascending order. This returns copies of the specified data.
+			*
+			* Complexity: O(log (n) + e), where e is the number of outgoing edges associated with src.
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't exist in the graph") if is_node(src) is false. [Note: Unlike Assignment 2, the exception message must be used verbatim. —end note]
+			*/
+			[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+				[[maybe_unused]] const auto timer = time(graph_operation::connections);
+				// Check if src exists in the graph
+				if (!is_node(src)) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't exist in the graph");
+				}
+
+				// Outgoing edges are sorted by dst, so duplicates are always adjacent
+				std::vector<N> unique_dests;
+				unique_dests.reserve(edges_of(locate(src)->second).distinct_out);
+				auto last_dst = std::optional<node_id>();
+				for (const auto& record : out_edges(src)) {
+					if (last_dst != record.node) {
+						unique_dests.push_back(value_of(record.node));
+						last_dst = record.node;
+					}
+				}
+				return unique_dests;
+			};
+
+			/**
+			* Returns: A lazy sized forward range over the nodes of connections(src), as references to the values
+			* stored in the graph, without copying them. Mutating the graph invalidates the range and its iterators.
+			*
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::connections_view if src doesn't exist in the graph") if is_node(src) is false.
+			* Complexity: O(log(n)), O(1) expected in hashed graphs, and O(e) for a full pass.
+			*/
+			[[nodiscard]] auto connections_view(N const& src) const -> connections_range {
+				const auto& edges = adjacency_of(src, "Cannot call gdwg::graph<N, E>::connections_view if src doesn't exist in the graph");
+				return connections_range(state_.get(), edges.outgoing.data(), edges.outgoing.data() + edges.outgoing.size(), edges.distinct_out);
+			}
+
+			/**
+			* Returns: An immutable compressed sparse row snapshot of the graph, for read-heavy workloads.
+			* The snapshot does not change when the graph is mutated afterwards.
+			* Complexity: O(n + e), where n is the number of stored nodes and e is the number of stored edges.
+			*/
+			[[nodiscard]] auto freeze() const -> csr_graph<N, E>
+			requires (Policy == edge_policy::mixed and Index == index_policy::ordered) {
+				[[maybe_unused]] const auto timer = time(graph_operation::freeze);
+				return csr_graph<N, E>(*this);
+			}
+
+			/**
+			* Returns: A read-only view of the graph as it is now. The view and its iterators stay valid and
+			* unchanged while this graph keeps being mutated, so a long scan never has to block writers.
+			*
+			* The view shares this graph's storage. The next mutation of the graph copies the index and slot
+			* table once, and after that only the edge lists of the nodes it modifies. A version is freed when
+			* the last graph or snapshot that refers to it goes away.
+			*
+			* Taking the snapshot is a read of this graph, so it must not race with a mutator. Afterwards the
+			* snapshot may be read from any threads while this graph is mutated by its own writer.
+			*
+			* Complexity: O(1)
+			*/
+			[[nodiscard]] auto snapshot() const noexcept -> graph_snapshot<N, E, Policy, Index> {
+				return graph_snapshot<N, E, Policy, Index>(*this);
+			}
+
+			/**
+			* Returns: A view of the subgraph induced by the nodes for which pred returns true: those nodes, and every
+			* edge between two of them. Like snapshot(), the view shares this graph's storage, so it copies no values
+			* and later mutations of this graph do not affect it. materialize() turns it into a graph of its own.
+			* Complexity: O(n) calls to pred, where n is the number of stored nodes.
+			*/
+			template<std::predicate<N const&> Pred>
+			[[nodiscard]] auto subgraph(Pred pred) const -> subgraph_view<N, E, Policy, Index> {
+				auto members = std::vector<bool>(state_->nodes.size());
+				for (const auto& [value, id] : state_->index) {
+					members[id] = static_cast<bool>(std::invoke(pred, value));
+				}
+				return subgraph_view<N, E, Policy, Index>(*this, std::move(members));
+			}
+
+			/**
+			* Returns: A view of the subgraph induced by the values in nodes, as subgraph(pred). Values that are not
+			* stored nodes are ignored.
+			* Complexity: O(n + k log(n)), where k is the number of values in nodes, and O(n + k) expected in hashed graphs.
+			*/
+			template<std::ranges::input_range NodeRange>
+			requires (!std::predicate<NodeRange const&, N const&>)
+			[[nodiscard]] auto subgraph(NodeRange const& nodes) const -> subgraph_view<N, E, Policy, Index> {
+				auto members = std::vector<bool>(state_->nodes.size());
+				for (const auto& value : nodes) {
+					if (const auto it = locate(value); it != state_->index.end()) {
+						members[it->second] = true;
+					}
+				}
+				return subgraph_view<N, E, Policy, Index>(*this, std::move(members));
+			}
+
+			[[nodiscard]] auto operator==(graph const& other) const -> bool {
+				[[maybe_unused]] const auto timer = time(graph_operation::equal);
+				// Copies that have not been modified since share their storage
+				if (state_ == other.state_) {
+					return true;
+				}
+
+				// Compare the size of the two maps first
+				if (state_->index.size() != other.state_->index.size() or state_->num_edges != other.state_->num_edges) {
 					return false;
 				}
+				// Equal graphs have equal fingerprints
+				if constexpr (fingerprinted) {
+					if (state_->digest != other.state_->digest) {
+						return false;
+					}
+				}
+
+				// Create 2 iterators one from g and one from other
+				auto g_it = begin();
+				auto other_it = other.begin();
+
+				// Check nodes
+				const auto vec1 = nodes();
+				const auto vec2 = other.nodes();
+				for (size_t i = 0; i < vec1.size(); ++i) {
+					if (vec1.at(i) != vec2.at(i)) {
+						return false;  // Return false immediately if a mismatch is found
+					}
+				}
+
+				// Handle the case when one of the iterators is already at end
+				if (g_it == end() and other_it == other.end()) {
+					return true;
+				}
+				if (g_it == end() or other_it == other.end()) {
+					return false;
+				}
+
+				// Handle other case
+				while (g_it != end() and other_it != other.end()) {
+			        // Dereference iterators to get the value_type structs
+					auto value1 = *g_it;
+					auto value2 = *other_it;
+
+					// Compare the individual fields
+					if (value1.from != value2.from or value1.to != value2.to) {
+						return false; // One or more fields are not equal
+					}
+					if constexpr (Policy != edge_policy::unweighted_only) {
+						if (value1.weight != value2.weight) {
+							return false;
+						}
+					}
+					++g_it;
+        			++other_it;
+				}
+				// If one iterator is not at end, the graphs are not equal
+				return g_it == end() and other_it == other.end();
+			};
+
+			/**
+			* Returns: A 64 bit hash of the whole graph that does not depend on the order in which it was built.
+			* Equal graphs have equal fingerprints, and unequal graphs almost always differ in theirs, so replicas
+			* can be compared by exchanging eight bytes. It is the sum of the sub-fingerprints of every node, see
+			* node_fingerprint, and is kept up to date by every mutator.
+			*
+			* Available if N, and E unless the graph is unweighted_only, are hashable. The values of std::hash
+			* are only portable between builds of the same standard library, as are fingerprints.
+			*
+			* Complexity: O(1)
+			*/
+			[[nodiscard]] auto fingerprint() const noexcept -> std::uint64_t
+			requires (fingerprinted) {
+				return state_->digest;
+			}
+
+			/**
+			* Returns: The sub-fingerprint of value: the hash of value plus the hashes of its outgoing edges, each
+			* of which covers the values of both ends and the weight. Summed over every node it is fingerprint().
+			*
+			* Throws: std::runtime_error("Cannot call gdwg::graph<N, E>::node_fingerprint if src doesn't exist in the graph")
+			* if is_node(value) is false.
+			*
+			* Complexity: O(log(n)), O(1) expected in hashed graphs
+			*/
+			[[nodiscard]] auto node_fingerprint(N const& value) const -> std::uint64_t
+			requires (fingerprinted) {
+				const auto it = locate(value);
+				if (it == state_->index.end()) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::node_fingerprint if src doesn't exist in the graph");
+				}
+				return state_->nodes[it->second].digest.sum;
+			}
+
+			/**
+			* Returns: The sum of the sub-fingerprints of the nodes in [first, last), which need not be nodes.
+			* Two replicas whose fingerprints differ find the nodes they disagree on by comparing the fingerprints
+			* of ever smaller halves of their node ranges, shipping only those.
+			*
+			* Complexity: O(log(n) + k), where k is the number of nodes in the range.
+			*/
+			[[nodiscard]] auto fingerprint(N const& first, N const& last) const -> std::uint64_t
+			requires (fingerprinted) {
+				auto sum = std::uint64_t{0};
+				if (!(first < last)) {
+					return sum;
+				}
+				const auto end = state_->index.lower_bound(last);
+				for (auto it = state_->index.lower_bound(first); it != end; ++it) {
+					sum += state_->nodes[it->second].digest.sum;
+				}
+				return sum;
+			}
+
+			/**
+			* Effects: Behaves as a formatted output function of os.
+			* Returns: os.
+			*/
+			friend auto operator<<(std::ostream& os, graph const& g) -> std::ostream& {
+				if (has_default_format(os)) {
+					g.write_text([&os](char const* data, std::size_t size) {
+						os.write(data, static_cast<std::streamsize>(size));
+					});
+					return os;
+				}
+				for (const auto& [node, id] : g.state_->index) {
+					os << node << " (\n";
+					const auto& outgoing_edges = g.edges_of(id).outgoing;
+					std::for_each(outgoing_edges.begin(), outgoing_edges.end(),
+								[&os, &g, &node](const auto& record) {
+									os << "  " << g.print_record(node, record) << "\n";
+								});
+					os << ")\n";
+				}
+				return os;
+			}
+
+		private:
+			auto record_order() const -> EdgeRecordComparator {
+				if constexpr (instrumented) {
+					return EdgeRecordComparator{state_->nodes, stats_.get()};
+				} else {
+					return EdgeRecordComparator{state_->nodes, no_stats{}};
+				}
+			}
+
+			auto value_of(node_id id) const -> N const& {
+				return *state_->nodes[id].value;
+			}
+
+			// Precondition: is_node(value)
+			// Calls fn(src, record) for every outgoing record into dst, with srcs in ascending order. Used in
+			// place of the incoming list of dst while the incoming index is deferred
+			template<typename Fn>
+			auto scan_incoming(N const& dst, Fn&& fn) const -> void {
+				const auto key = node_key{dst};
+				const auto order = record_order();
+				for (const auto& [value, src] : state_->index) {
+					const auto& outgoing_edges = edges_of(src).outgoing;
+					const auto [first, last] = std::equal_range(outgoing_edges.begin(), outgoing_edges.end(), key, order);
+					for (auto it = first; it != last; ++it) {
+						fn(src, *it);
+					}
+				}
+			}
+
+			auto out_edges(N const& value) const -> edge_list const& {
+				return edges_of(locate(value)->second).outgoing;
+			}
+
+			// Writes the output of operator<< through a text_writer: each node is formatted once, and
+			// only the dst and weight of every edge line are formatted per edge
+			template<typename Sink>
+			auto write_text(Sink sink) const -> void {
+				auto writer = text_writer<Sink>(std::move(sink));
+				auto src = std::string();
+				for (const auto& [node, id] : state_->index) {
+					src.assign("  ");
+					writer.format(src, node);
+					writer.text(std::string_view(src).substr(2)).text(" (\n");
+					src.append(" -> ");
+					for (const auto& record : edges_of(id).outgoing) {
+						writer.text(src).value(value_of(record.node));
+						if (const auto* weight = weight_of(record)) {
+							writer.text(" | W | ").value(*weight).text("\n");
+						} else {
+							writer.text(" | U\n");
+						}
+					}
+					writer.text(")\n");
+				}
+				writer.flush();
+			}
+
+			// Same format as edge::print_edge, without creating an edge object
+			auto print_record(N const& src, const edge_record& record) const -> std::string {
+				const auto* weight = weight_of(record);
+				if (weight == nullptr) {
+					return to_string(src) + " -> " + to_string(value_of(record.node)) + " | U";
+				}
+				return to_string(src) + " -> " + to_string(value_of(record.node)) + " | W | " + to_string(*weight);
+			}
+
+			// Calls fn on every edge whose src has an id in [begin, end)
+			template<typename Fn>
+			auto visit_edges(std::size_t begin, std::size_t end, Fn& fn) const -> void {
+				const auto& slots = state_->nodes;
+				for (auto id = begin; id < end; ++id) {
+					if (slots[id].value == nullptr) {
+						continue;
+					}
+					const auto& src = *slots[id].value;
+					for (const auto& record : slots[id].edges->outgoing) {
+						if constexpr (Policy == edge_policy::unweighted_only) {
+							fn(src, value_of(record.node));
+						} else {
+							fn(src, value_of(record.node), std::as_const(record.weight));
+						}
+					}
+				}
+			}
+
+			// transform_weights on this graph's own storage. Every list is made unique up front, on this
+			// thread, so that the workers never allocate and only rewrite records in place.
+			template<typename Fn>
+			auto rewrite_weights(Fn& fn, std::size_t threads) -> void {
+				auto& state = writable();
+				for (auto id = node_id{0}; id < state.nodes.size(); ++id) {
+					if (state.nodes[id].value != nullptr) {
+						const auto& edges = edges_of(id);
+						if (!edges.outgoing.empty() or !edges.incoming.empty()) {
+							writable_edges(id);
+						}
+					}
+				}
+				const auto order = record_order();
+				const auto rewrite = [&fn, &order](edge_list& edges) {
+					if (edges.empty()) {
+						return;
+					}
+					for (auto& record : edges) {
+						if constexpr (Policy == edge_policy::mixed) {
+							if (record.weight) {
+								record.weight = fn(*std::as_const(record.weight));
+							}
+						} else {
+							record.weight = fn(std::as_const(record.weight));
+						}
+					}
+					// A monotonic fn keeps every list sorted
+					if (!std::is_sorted(edges.begin(), edges.end(), order)) {
+						std::sort(edges.begin(), edges.end(), order);
+					}
+					const auto duplicate = [](const edge_record& a, const edge_record& b) {
+						return a.node == b.node and a.weight == b.weight;
+					};
+					edges.erase(std::unique(edges.begin(), edges.end(), duplicate), edges.end());
+				};
+				for_each_node_block(threads, [&](std::size_t begin, std::size_t end) {
+					for (auto id = begin; id < end; ++id) {
+						if (auto* const edges = state.nodes[id].edges.get(); edges != nullptr) {
+							rewrite(edges->outgoing);
+							rewrite(edges->incoming);
+							if constexpr (fingerprinted) {
+								// Only this thread writes the slot, and the others only read the hashes of values
+								auto sum = state.nodes[id].digest.hash;
+								for (const auto& record : edges->outgoing) {
+									sum += edge_hash(static_cast<node_id>(id), record.node, record.weight);
+								}
+								state.nodes[id].digest.sum = sum;
+							}
+						}
+					}
+				});
+				// Merged duplicates drop out of the edge count, while every list keeps its dsts
+				state.num_edges = 0;
+				if constexpr (fingerprinted) {
+					state.digest = 0;
+				}
+				for (const auto& slot : state.nodes) {
+					if (slot.value != nullptr) {
+						state.num_edges += slot.edges->outgoing.size();
+						if constexpr (fingerprinted) {
+							state.digest += slot.digest.sum;
+						}
+					}
+				}
+			}
+
+			// Calls work(begin, end) on blocks of node ids covering every slot, with up to threads threads
+			// (one per hardware thread if 0) each claiming the next block as it finishes one, so that a few
+			// nodes of very high degree do not leave the other threads idle
+			template<typename Work>
+			auto for_each_node_block(std::size_t threads, Work const& work) const -> void {
+				constexpr auto block = std::size_t{256};
+				const auto count = state_->nodes.size();
+				if (threads == 0) {
+					threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+				}
+				auto next = std::atomic<std::size_t>(0);
+				run_parallel(threads, std::min(threads, (count + block - 1) / block), 1, [&](std::size_t, std::size_t, std::size_t) {
+					for (auto begin = next.fetch_add(block); begin < count; begin = next.fetch_add(block)) {
+						work(begin, std::min(count, begin + block));
+					}
+				});
+			}
+
+			// The weight of a weighted edge, or nullptr for an unweighted one
+			static auto weight_of(const edge_record& record) noexcept -> E const* {
+				if constexpr (Policy == edge_policy::mixed) {
+					return record.weight ? &*record.weight : nullptr;
+				} else if constexpr (Policy == edge_policy::weighted_only) {
+					return &record.weight;
+				} else {
+					return nullptr;
+				}
+			}
+
+			// insert_node and emplace_node, copying or moving value in
+			template<typename Value>
+			auto insert_node_value(Value&& value) noexcept -> bool {
+				[[maybe_unused]] const auto timer = time(graph_operation::insert_node);
+				const auto [it, inserted] = intern_node(std::forward<Value>(value));
+				if (inserted) {
+					note([&key = it->first] { return node_inserted{key}; });
+				}
+				return inserted;
+			}
+
+			// insert_edge for every policy, with weight already in the stored form
+			auto insert_edge_value(N const& src, N const& dst, weight_type weight) -> bool {
+				[[maybe_unused]] const auto timer = time(graph_operation::insert_edge);
+				// Check src and dst existence first
+				const auto src_it = locate(src);
+				const auto dst_it = locate(dst);
+				if (src_it == state_->index.end() or dst_it == state_->index.end()) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist");
+				}
+				if (!log_) {
+					return insert_edge_record(src_it->second, dst_it->second, std::move(weight));
+				}
+				// The ids survive writable() copying the storage, where the index iterators would not
+				const auto src_id = src_it->second;
+				const auto dst_id = dst_it->second;
+				if (!insert_edge_record(src_id, dst_id, weight)) {
+					return false;
+				}
+				note([&] { return edge_inserted{value_of(src_id), value_of(dst_id), std::move(weight)}; });
+				return true;
+			}
+
+			// erase_edge for every policy
+			auto erase_edge_value(N const& src, N const& dst, weight_type const& weight) -> bool {
+				[[maybe_unused]] const auto timer = time(graph_operation::erase_edge);
+				// Check if src and dst exist in the graph
+				const auto src_it = locate(src);
+				const auto dst_it = locate(dst);
+				if (src_it == state_->index.end() or dst_it == state_->index.end()) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they don't exist in the graph");
+				}
+				return erase_edge_record(src_it->second, dst_it->second, weight);
+			}
+
+			// find for every policy
+			auto find_value(N const& src, N const& dst, weight_type const& weight) const noexcept -> iterator {
+				[[maybe_unused]] const auto timer = time(graph_operation::find);
+				const auto node_it = locate(src);
+				if (node_it == state_->index.end() or !is_node(dst)) {
+					return end();
+				}
+				const auto& outgoing_edges = edges_of(node_it->second).outgoing;
+				const auto it = find_record(outgoing_edges, record_key{dst, weight});
+				if (it == outgoing_edges.end()) {
+					return end();
+				} else {
+					return iterator(node_it, static_cast<std::size_t>(it - outgoing_edges.begin()), this);
+				}
+			}
+
+			// Point lookup of value: through the hash table in hashed graphs, and the index otherwise.
+			// Returns state_->index.end() if value is not a node.
+			auto locate(N const& value) const -> typename node_index::iterator {
+				count(&live_stats::index_probes);
+				if constexpr (Index == index_policy::hashed) {
+					return state_->table.find(value, state_->index.end());
+				} else {
+					return state_->index.find(value);
+				}
+			}
+
+			// Adds value to the index and gives it an id, reusing a released one if possible. An rvalue N
+			// is moved into the index, and anything else convertible to N is converted once up front.
+			// Returns the index entry and whether the node is new.
+			template<typename Value>
+			auto intern_node(Value&& value) -> std::pair<typename node_index::iterator, bool> {
+				if constexpr (!std::same_as<std::remove_cvref_t<Value>, N>) {
+					return intern_node(N(std::forward<Value>(value)));
+				} else {
+					return intern_value(std::forward<Value>(value));
+				}
+			}
+
+			// intern_node once value is an N
+			template<typename Value>
+			auto intern_value(Value&& value) -> std::pair<typename node_index::iterator, bool> {
+				if (const auto it = locate(value); it != state_->index.end()) {
+					return {it, false};
+				}
+				auto& state = writable();
+				const auto it = state.index.try_emplace(std::forward<Value>(value), node_id{0}).first;
+				if constexpr (Index == index_policy::hashed) {
+					state.table.insert(it);
+				}
+				if (state.free_ids.empty()) {
+					it->second = static_cast<node_id>(state.nodes.size());
+					state.nodes.push_back(node_slot{&it->first, empty_adjacency()});
+				} else {
+					it->second = state.free_ids.back();
+					state.free_ids.pop_back();
+					state.nodes[it->second] = node_slot{&it->first, empty_adjacency()};
+				}
+				if constexpr (fingerprinted) {
+					const auto hash = node_hash(it->first);
+					state.nodes[it->second].digest = node_digest{hash, hash};
+					state.digest += hash;
+				}
+				return {it, true};
+			}
+
+			// Erases the node at node_it with all its edges, and recycles its id. Only the lists of its
+			// neighbours are touched, where the records pointing at it form one contiguous run.
+			// Precondition: node_it was found after calling writable()
+			auto remove_node(typename node_index::iterator node_it) -> void {
+				const auto id = node_it->second;
+				const auto key = node_key{node_it->first};
+				const auto order = record_order();
+				const auto erase_run = [this, &key, &order](edge_list& edges) {
+					const auto [first, last] = std::equal_range(edges.begin(), edges.end(), key, order);
+					count(&live_stats::scanned_records, static_cast<std::uint64_t>(edges.end() - last));
+					edges.erase(first, last);
+				};
+
+				// 1. Remove the mirror records from every neighbour, once per distinct neighbour
+				const auto& edges = edges_of(id);
+				for (auto it = edges.outgoing.begin(); it != edges.outgoing.end(); ++it) {
+					if (it->node != id and (it == edges.outgoing.begin() or std::prev(it)->node != it->node)) {
+						erase_run(writable_edges(it->node).incoming);
+					}
+				}
+				auto& num_edges = state_->num_edges;
+				num_edges -= edges.outgoing.size();
+				for (auto it = edges.incoming.begin(); it != edges.incoming.end(); ++it) {
+					if (it->node != id) {
+						track_edge(it->node, id, it->weight, false);
+						--num_edges;
+					}
+				}
+				for (auto it = edges.incoming.begin(); it != edges.incoming.end(); ++it) {
+					if (it->node != id and (it == edges.incoming.begin() or std::prev(it)->node != it->node)) {
+						auto& neighbour = writable_edges(it->node);
+						erase_run(neighbour.outgoing);
+						--neighbour.distinct_out;
+					}
+				}
+
+				// 2. Finally, erase the node itself and put its id on the free list
+				release_node(node_it);
+			}
+
+			// Erases the index entry at node_it and recycles its id. Precondition: no other list refers to it,
+			// and node_it was found after calling writable()
+			auto release_node(typename node_index::iterator node_it) -> void {
+				const auto id = node_it->second;
+				auto& state = writable();
+				if constexpr (Index == index_policy::hashed) {
+					state.table.erase(node_it->first);
+				}
+				if constexpr (fingerprinted) {
+					// Takes the node's outgoing edges with it, whether or not they were erased already
+					state.digest -= state.nodes[id].digest.sum;
+				}
+				state.index.erase(node_it);
+				state.nodes[id] = node_slot{nullptr, nullptr};
+				state.free_ids.push_back(id);
+			}
+
+			// Returns the record equivalent to key, or edges.end() if there is none
+			auto find_record(const edge_list& edges, const record_key& key) const -> typename edge_list::const_iterator {
+				const auto order = record_order();
+				const auto it = std::lower_bound(edges.begin(), edges.end(), key, order);
+				if (it != edges.end() and order.compare(*it, key) == 0) {
+					return it;
+				}
+				return edges.end();
+			}
+
+			// std::lower_bound of key in [first, last) that probes first, first + 1, first + 3, first + 7, ... before
+			// bisecting, so that a run of k ascending keys over e records costs O(k log(e / k)) comparisons
+			template<typename Key>
+			static auto gallop(typename edge_list::const_iterator first,
+			                   typename edge_list::const_iterator last,
+			                   Key const& key,
+			                   EdgeRecordComparator const& order) -> typename edge_list::const_iterator {
+				auto step = std::ptrdiff_t{1};
+				while (last - first >= step and order(first[step - 1], key)) {
+					first += step;
+					step *= 2;
+				}
+				return std::lower_bound(first, first + std::min(step, last - first), key, order);
+			}
+
+			// Adds src → dst to both edge lists, keeping them sorted. Returns false on duplicates.
+			auto insert_edge_record(node_id src, node_id dst, weight_type weight) -> bool {
+				// Check for a duplicate before copying any shared list
+				const auto order = record_order();
+				const auto& current_edges = edges_of(src).outgoing;
+				const auto out_key = record_key{value_of(dst), weight};
+				const auto out_offset = std::lower_bound(current_edges.begin(), current_edges.end(), out_key, order) - current_edges.begin();
+				if (out_offset != std::ssize(current_edges) and order.compare(current_edges[static_cast<std::size_t>(out_offset)], out_key) == 0) {
+					return false;
+				}
+				// Records to the same dst are adjacent, so dst is new to the list unless a neighbour of the slot is one
+				const auto at = static_cast<std::size_t>(out_offset);
+				const auto new_dst = (at == current_edges.size() or current_edges[at].node != dst)
+				                     and (at == 0 or current_edges[at - 1].node != dst);
+				auto& src_edges = writable_edges(src);
+				auto& outgoing_edges = src_edges.outgoing;
+				const auto out_pos = outgoing_edges.begin() + out_offset;
+
+				if (!state_->incoming_indexed) {
+					if constexpr (instrumented) {
+						count(&live_stats::allocations, outgoing_edges.size() == outgoing_edges.capacity() ? 1U : 0U);
+						count(&live_stats::scanned_records, static_cast<std::uint64_t>(outgoing_edges.end() - out_pos));
+					}
+					track_edge(src, dst, weight, true);
+					outgoing_edges.insert(out_pos, edge_record{dst, std::move(weight)});
+					++state_->num_edges;
+					if (new_dst) {
+						++src_edges.distinct_out;
+					}
+					return true;
+				}
+
+				// Outgoing and incoming lists always hold the same edges, so a duplicate check on one is enough
+				auto& incoming_edges = writable_edges(dst).incoming;
+				const auto in_pos = std::lower_bound(incoming_edges.begin(), incoming_edges.end(),
+					record_key{value_of(src), weight}, order);
+				if constexpr (instrumented) {
+					count(&live_stats::allocations, (incoming_edges.size() == incoming_edges.capacity() ? 1U : 0U)
+					                                + (outgoing_edges.size() == outgoing_edges.capacity() ? 1U : 0U));
+					count(&live_stats::scanned_records, static_cast<std::uint64_t>((incoming_edges.end() - in_pos) + (outgoing_edges.end() - out_pos)));
+				}
+				incoming_edges.insert(in_pos, edge_record{src, weight});
+				track_edge(src, dst, weight, true);
+				outgoing_edges.insert(out_pos, edge_record{dst, std::move(weight)});
+				++state_->num_edges;
+				if (new_dst) {
+					++src_edges.distinct_out;
+				}
+				return true;
+			}
+
+			// The bulk-load path of insert_edges: adds every record of outgoing_batch, owned by its src, that is
+			// not already stored. Returns the number of edges added.
+			auto load_records(std::vector<pending_record>& outgoing_batch) -> std::size_t {
+				// Merge into outgoing lists first, then mirror exactly the edges that were new into incoming lists
+				auto added = merge_records(&adjacency::outgoing, outgoing_batch);
+				const auto count = added.size();
+				state_->num_edges += count;
+				for (auto& pending : added) {
+					track_edge(pending.owner, pending.record.node, pending.record.weight, true);
+					note([this, &pending] {
+						return edge_inserted{value_of(pending.owner), value_of(pending.record.node), pending.record.weight};
+					});
+					pending = pending_record{pending.record.node, edge_record{pending.owner, std::move(pending.record.weight)}};
+				}
+				if (state_->incoming_indexed) {
+					merge_records(&adjacency::incoming, added);
+				}
+				return count;
+			}
+
+			// Sorts and deduplicates batch, then merges it into the side list of each owner in one linear pass
+			// per list, skipping records already present. Returns the records that were actually added.
+			auto merge_records(edge_list adjacency::*side, std::vector<pending_record>& batch) -> std::vector<pending_record> {
+				// Rank of every id in node order, so sorting compares integers instead of node values
+				auto rank = std::vector<node_id>(state_->nodes.size());
+				auto next_rank = node_id{0};
+				for (const auto& [value, id] : state_->index) {
+					rank[id] = next_rank++;
+				}
+				const auto order = [&rank](const edge_record& a, const edge_record& b) {
+					if (a.node != b.node) {
+						return rank[a.node] < rank[b.node];
+					}
+					return a.weight < b.weight;
+				};
+				const auto same_record = [](const edge_record& a, const edge_record& b) {
+					return a.node == b.node and a.weight == b.weight;
+				};
+				std::sort(batch.begin(), batch.end(), [&order](const pending_record& a, const pending_record& b) {
+					return a.owner != b.owner ? a.owner < b.owner : order(a.record, b.record);
+				});
+				batch.erase(std::unique(batch.begin(), batch.end(), [&same_record](const pending_record& a, const pending_record& b) {
+					return a.owner == b.owner and same_record(a.record, b.record);
+				}), batch.end());
+
+				auto added = std::vector<pending_record>();
+				for (auto group = batch.begin(); group != batch.end();) {
+					const auto owner = group->owner;
+					const auto group_end = std::find_if(group, batch.end(), [owner](const pending_record& p) { return p.owner != owner; });
+					auto& owner_edges = writable_edges(owner);
+					auto& edges = owner_edges.*side;
+					auto merged = edge_list(edges.get_allocator());
+					merged.reserve(edges.size() + static_cast<std::size_t>(group_end - group));
+					auto existing = edges.begin();
+					for (; group != group_end; ++group) {
+						while (existing != edges.end() and order(*existing, group->record)) {
+							merged.push_back(std::move(*existing++));
+						}
+						if (existing != edges.end() and same_record(*existing, group->record)) {
+							continue;
+						}
+						added.push_back(*group);
+						merged.push_back(std::move(group->record));
+					}
+					std::move(existing, edges.end(), std::back_inserter(merged));
+					count(&live_stats::allocations);
+					count(&live_stats::scanned_records, merged.size());
+					edges = std::move(merged);
+					if (side == &adjacency::outgoing) {
+						owner_edges.distinct_out = count_distinct(edges);
+					}
+				}
+				return added;
+			}
+
+			// Removes src → dst from both edge lists. Returns false if there is no such edge.
+			auto erase_edge_record(node_id src, node_id dst, const weight_type& weight) -> bool {
+				// Look both records up before erasing anything, weight may refer to one of them.
+				// Positions are kept as offsets, since the lists are only copied once the edge is known to exist.
+				const auto& current_out = edges_of(src).outgoing;
+				const auto out_it = find_record(current_out, record_key{value_of(dst), weight});
+				if (out_it == current_out.end()) {
+					return false;
+				}
+				const auto out_offset = out_it - current_out.begin();
+				note([&] { return edge_erased{value_of(src), value_of(dst), weight}; });
+				track_edge(src, dst, weight, false);
+				count(&live_stats::scanned_records, current_out.size() - static_cast<std::size_t>(out_offset));
+				if (state_->incoming_indexed) {
+					const auto& current_in = edges_of(dst).incoming;
+					const auto in_it = find_record(current_in, record_key{value_of(src), weight});
+					assert(in_it != current_in.end());
+					const auto in_offset = in_it - current_in.begin();
+					count(&live_stats::scanned_records, current_in.size() - static_cast<std::size_t>(in_offset));
+					auto& incoming_edges = writable_edges(dst).incoming;
+					incoming_edges.erase(incoming_edges.begin() + in_offset);
+				}
+				auto& src_edges = writable_edges(src);
+				auto& outgoing_edges = src_edges.outgoing;
+				outgoing_edges.erase(outgoing_edges.begin() + out_offset);
+				--state_->num_edges;
+				const auto at = static_cast<std::size_t>(out_offset);
+				if ((at == outgoing_edges.size() or outgoing_edges[at].node != dst)
+				    and (at == 0 or outgoing_edges[at - 1].node != dst)) {
+					--src_edges.distinct_out;
+				}
+				return true;
+			}
+
+			// Re-sorts the records pointing at id after its value changed. Those records form one
+			// contiguous run in every list, so the run is rotated into its new place.
+			auto restore_order(edge_list& edges, node_id id) -> void {
+				const auto is_id = [id](const edge_record& record) { return record.node == id; };
+				const auto first = std::find_if(edges.begin(), edges.end(), is_id);
+				if (first == edges.end()) {
+					return;
+				}
+				const auto last = std::find_if_not(first, edges.end(), is_id);
+				const auto sorts_before = [this, id](const edge_record& record) {
+					return value_of(record.node) < value_of(id);
+				};
+				if (const auto pos = std::partition_point(edges.begin(), first, sorts_before); pos != first) {
+					std::rotate(pos, first, last);
+				} else {
+					std::rotate(first, last, std::partition_point(last, edges.end(), sorts_before));
+				}
+			}
+
+			// Restores the order of every list holding a record that points at id
+			auto restore_order_around(node_id id) -> void {
+				// Own id's lists first, so the loops below never see them replaced by a copy
+				const auto& edges = writable_edges(id);
+				auto last_node = std::optional<node_id>();
+				for (const auto& record : edges.outgoing) {
+					if (std::exchange(last_node, record.node) != record.node) {
+						restore_order(writable_edges(record.node).incoming, id);
+					}
+				}
+				last_node.reset();
+				for (const auto& record : edges.incoming) {
+					if (std::exchange(last_node, record.node) != record.node) {
+						restore_order(writable_edges(record.node).outgoing, id);
+					}
+				}
+			}
+
+			// Moves every edge of the node at old_it onto new_id, then erases the old node.
+			// Self loops on the old node become self loops on new_id, and duplicates are dropped.
+			auto move_node_data(typename node_index::iterator old_it, node_id new_id) -> void {
+				const auto old_id = old_it->second;
+				const auto redirect = [old_id, new_id](edge_record record) {
+					if (record.node == old_id) {
+						record.node = new_id;
+					}
+					return record;
+				};
+
+				// Copy the records out first, remove_node invalidates the lists
+				const auto& old_edges = edges_of(old_id);
+				auto outgoing_edges = edge_list();
+				auto incoming_edges = edge_list();
+				std::transform(old_edges.outgoing.begin(), old_edges.outgoing.end(), std::back_inserter(outgoing_edges), redirect);
+				std::transform(old_edges.incoming.begin(), old_edges.incoming.end(), std::back_inserter(incoming_edges), redirect);
+				remove_node(old_it);
+
+				// Handle outgoing edges
+				for (auto& record : outgoing_edges) {
+					insert_edge_record(new_id, record.node, std::move(record.weight));
+				}
+
+				// Handle incoming edges
+				for (auto& record : incoming_edges) {
+					insert_edge_record(record.node, new_id, std::move(record.weight));
+				}
+			}
+
+			// splitmix64's finaliser, a bijection that spreads every input bit over the whole result
+			static constexpr auto mix(std::uint64_t x) noexcept -> std::uint64_t {
+				x += 0x9E3779B97F4A7C15ULL;
+				x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+				x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+				return x ^ (x >> 31);
+			}
+
+			static auto node_hash(N const& value) -> std::uint64_t {
+				return mix(static_cast<std::uint64_t>(std::hash<N>{}(value)));
+			}
+
+			// Unweighted edges hash alike in every policy, so do weighted ones
+			static auto weight_hash(weight_type const& weight) -> std::uint64_t {
+				constexpr auto unweighted = std::uint64_t{0x5851F42D4C957F2DULL};
+				if constexpr (Policy == edge_policy::unweighted_only) {
+					return unweighted;
+				} else if constexpr (Policy == edge_policy::weighted_only) {
+					return static_cast<std::uint64_t>(std::hash<E>{}(weight));
+				} else {
+					return weight ? static_cast<std::uint64_t>(std::hash<E>{}(*weight)) : unweighted;
+				}
+			}
+
+			// The hash of src → dst, from the values of both ends, so that it is equal in every graph holding the edge
+			auto edge_hash(node_id src, node_id dst, weight_type const& weight) const -> std::uint64_t {
+				return mix(state_->nodes[src].digest.hash ^ mix(state_->nodes[dst].digest.hash ^ mix(weight_hash(weight))));
+			}
+
+			// Adds src → dst to, or removes it from, the fingerprint and the sub-fingerprint of src.
+			// Precondition: writable() was called
+			auto track_edge(node_id src, node_id dst, weight_type const& weight, bool inserted) -> void {
+				if constexpr (fingerprinted) {
+					const auto hash = edge_hash(src, dst, weight);
+					auto& state = *state_;
+					if (inserted) {
+						state.digest += hash;
+						state.nodes[src].digest.sum += hash;
+					} else {
+						state.digest -= hash;
+						state.nodes[src].digest.sum -= hash;
+					}
+				}
+			}
+
+			// track_edge for every edge into or out of id, self loops once
+			auto track_incident(node_id id, bool inserted) -> void {
+				const auto& edges = edges_of(id);
+				for (const auto& record : edges.outgoing) {
+					track_edge(id, record.node, record.weight, inserted);
+				}
+				for (const auto& record : edges.incoming) {
+					if (record.node != id) {
+						track_edge(record.node, id, record.weight, inserted);
+					}
+				}
+			}
+
+			// The number of distinct nodes in a sorted edge list
+			static auto count_distinct(const edge_list& edges) noexcept -> std::size_t {
+				auto count = std::size_t{0};
+				for (auto i = std::size_t{0}; i < edges.size(); ++i) {
+					if (i == 0 or edges[i].node != edges[i - 1].node) {
+						++count;
+					}
+				}
+				return count;
+			}
+
+			// Recomputes the edge counts and digests from scratch, for code that fills the storage directly
+			auto rebuild_derived() -> void {
+				auto& counted = writable();
+				counted.num_edges = 0;
+				for (auto& slot : counted.nodes) {
+					if (slot.value != nullptr and !slot.edges->outgoing.empty()) {
+						// Precondition: lists with edges are not shared with another graph yet
+						slot.edges->distinct_out = count_distinct(slot.edges->outgoing);
+						counted.num_edges += slot.edges->outgoing.size();
+					}
+				}
+				if constexpr (fingerprinted) {
+					auto& state = writable();
+					for (auto& slot : state.nodes) {
+						if (slot.value != nullptr) {
+							slot.digest.hash = node_hash(*slot.value);
+						}
+					}
+					state.digest = 0;
+					for (auto id = node_id{0}; id < state.nodes.size(); ++id) {
+						if (state.nodes[id].value != nullptr) {
+							auto sum = state.nodes[id].digest.hash;
+							for (const auto& record : edges_of(id).outgoing) {
+								sum += edge_hash(id, record.node, record.weight);
+							}
+							state.nodes[id].digest.sum = sum;
+							state.digest += sum;
+						}
+					}
+				}
+			}
+
+			// Storage of default constructed and moved-from graphs. Permanently shared, so the first
+			// mutation always replaces it.
+			static auto empty_storage() noexcept -> std::shared_ptr<storage> {
+				static const auto empty = std::make_shared<storage>();
+				return empty;
+			}
+
+			// Edge lists of nodes without edges, shared until the node's first edge is added
+			static auto empty_adjacency() -> std::shared_ptr<adjacency> {
+				static const auto empty = std::make_shared<adjacency>();
+				return empty;
+			}
+
+			// Whether p is the only owner of its object, so that it may be modified in place
+			template<typename T>
+			static auto is_unique(std::shared_ptr<T> const& p) noexcept -> bool {
+				if (p.use_count() != 1) {
+					return false;
+				}
+				// Pairs with the release of the last other owner, whose reads must happen before our writes
+				std::atomic_thread_fence(std::memory_order_acquire);
+				return true;
+			}
+
+			// Copy-on-write: gives this graph its own index and slot table, allocated from alloc_, before they
+			// are modified. Edge lists stay shared until writable_edges is called for their node.
+			// Invalidates every iterator and index iterator if the storage was shared.
+			auto writable() -> storage& {
+				if (!is_unique(state_)) {
+					count(&live_stats::allocations);
+					state_ = std::allocate_shared<storage>(alloc_, *state_, alloc_);
+				}
+				return *state_;
+			}
+
+			// Copy-on-write access to the edge lists of id. Precondition: id is a live node
+			auto writable_edges(node_id id) -> adjacency& {
+				auto& edges = writable().nodes[id].edges;
+				if (!is_unique(edges)) {
+					count(&live_stats::allocations);
+					edges = std::allocate_shared<adjacency>(alloc_, *edges, alloc_);
+				}
+				return *edges;
+			}
+
+			// Read-only access to the edge lists of id. Precondition: id is a live node
+			auto edges_of(node_id id) const -> adjacency const& {
+				return *state_->nodes[id].edges;
+			}
+
+			// The edge lists of value, or throws std::runtime_error(message) if it is not a node
+			auto adjacency_of(N const& value, char const* message) const -> adjacency const& {
+				const auto it = locate(value);
+				if (it == state_->index.end()) {
+					throw std::runtime_error(message);
+				}
+				return edges_of(it->second);
+			}
+
+			// Adds n to one of the counters of stats()
+			auto count(std::atomic<std::uint64_t> live_stats::*counter, std::uint64_t n = 1) const noexcept -> void {
+				if constexpr (instrumented) {
+					(stats_.get()->*counter).fetch_add(n, std::memory_order_relaxed);
+				} else {
+					static_cast<void>(counter);
+					static_cast<void>(n);
+				}
+			}
+
+			// Times the calling member as op, when instrumented: [[maybe_unused]] const auto timer = time(op);
+			auto time(graph_operation op) const noexcept {
+				if constexpr (instrumented) {
+					return operation_timer(stats_.get(), op);
+				} else {
+					static_cast<void>(op);
+					return no_stats{};
+				}
+			}
+
+			static auto make_stats() -> std::conditional_t<instrumented, std::unique_ptr<live_stats>, no_stats> {
+				if constexpr (instrumented) {
+					return std::make_unique<live_stats>();
+				} else {
+					return no_stats{};
+				}
+			}
+
+			// Records the event make() returns if mutations are being recorded
+			template<typename Make>
+			auto note(Make const& make) noexcept -> void {
+				if (log_) {
+					log_->record(make);
+				}
+			}
+
+			// Never reassigned: like a std::pmr container, a graph keeps its resource for life
+			allocator_type alloc_;
+			std::shared_ptr<storage> state_ = empty_storage();
+			// Belongs to this graph object: copies and moves do not take it with them
+			std::unique_ptr<mutation_log> log_;
+			// So do the counters, which start at zero in every graph
+			[[no_unique_address]] std::conditional_t<instrumented, std::unique_ptr<live_stats>, no_stats> stats_ = make_stats();
+
+			friend class csr_graph<N, E>;
+			friend class graph_traversal<N, E>;
+			friend class graph_io<N, E>;
+			friend class subgraph_view<N, E, Policy, Index>;
+	};
+
+	template<typename N, typename E, edge_policy Policy, index_policy Index>
+	class graph<N, E, Policy, Index>::iterator {
+		private:
+			using graph_iterator = typename node_index::const_iterator;
+			// Index into the outgoing edges of current_node_, which unlike a vector iterator
+			// stays valid when the list reallocates
+			graph_iterator current_node_;
+			std::size_t current_edge_;
+			// Raw graph ptr
+			const graph* graph_ptr_;
+			// Outgoing edges of current_node_, or no_edges() at end. Saves going through the node's slot on every step
+			edge_list const* edges_;
+
+			// Create a iterator based on given entities
+			explicit iterator(graph_iterator node,
+							std::size_t edge,
+							const graph* g_ptr) :
+			current_node_(node), current_edge_(edge), graph_ptr_(g_ptr),
+			edges_(node == g_ptr->state_->index.end() ? &no_edges() : &edges_at(node)) {};
+
+			// Store inside private because we are not required to implement this operator
+			// So I do not want accidentally to write my test which include this operator
+			// If my test using = operator is ever used against other people code, it will not work !
+			auto operator=(iterator const& other) noexcept -> iterator& {
+				if (this != &other) {
+					current_node_ = other.current_node_;
+					current_edge_ = other.current_edge_;
+					graph_ptr_ = other.graph_ptr_;
+					edges_ = other.edges_;
+				}
+				return *this;
+			}
+
+			// Public factory method for begin iterator
+			static iterator begin(const graph* g) noexcept {
+				if (g->state_->index.empty()) {
+					return end(g);
+				}
+				auto it = iterator(g->state_->index.begin(), 0, g);
+				it.skip_empty_nodes();
+				return it;
+			}
+
+			static iterator end(const graph *g) noexcept {
+				return iterator(g->state_->index.end(), 0, g);
+			}
+
+			static auto no_edges() noexcept -> edge_list const& {
+				static const auto empty = edge_list();
+				return empty;
+			}
+
+			// Outgoing edges of the node at it. Precondition: it is not end
+			auto edges_at(graph_iterator it) const noexcept -> edge_list const& {
+				return graph_ptr_->edges_of(it->second).outgoing;
+			}
+
+			// Moves forward past the end of the current node's edges, skipping nodes without outgoing edges
+			auto skip_empty_nodes() noexcept -> void {
+				while (current_edge_ == edges_->size()) {
+					++current_node_;
+					if (current_node_ == graph_ptr_->state_->index.end()) {
+						*this = iterator::end(graph_ptr_);
+						return;
+					}
+					edges_ = &edges_at(current_node_);
+					current_edge_ = 0;
+				}
+			}
+
+			struct weighted_value {
+				N from;
+				N to;
+				weight_type weight;
+			};
+
+			struct unweighted_value {
+				N from;
+				N to;
+			};
+
+		public:
+			// {from, to, weight}, or {from, to} in an unweighted_only graph
+			using value_type = std::conditional_t<Policy == edge_policy::unweighted_only, unweighted_value, weighted_value>;
+			using reference = value_type;
+			using pointer = void;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::bidirectional_iterator_tag;
+
+			// Iterator constructor
+			iterator() : current_node_(), current_edge_(0), graph_ptr_(nullptr), edges_(&no_edges()) {}
+
+			iterator(const iterator& other)
+				: current_node_(other.current_node_)
+				, current_edge_(other.current_edge_)
+				, graph_ptr_(other.graph_ptr_)
+				, edges_(other.edges_) {}
+
+			// Iterator source
+			auto operator*() const noexcept -> reference {
+				// Dereferencing an end vector case
+				// throw error
+
+				const auto& record = (*edges_)[current_edge_];
+				if constexpr (Policy == edge_policy::unweighted_only) {
+					return value_type{current_node_->first, graph_ptr_->value_of(record.node)};
+				} else {
+					return value_type{current_node_->first, graph_ptr_->value_of(record.node), record.weight};
+				}
+			};
+
+			// Iterator traversal
+			// Precondition: never add after end
+			auto operator++() noexcept -> iterator& {
+				++current_edge_;
+				skip_empty_nodes();
+				return *this;
+			}
+
+			// Precondition: never add after end
+			auto operator++(int) noexcept -> iterator {
+				auto temp = *this;
+				++*this;
+				return temp;
+			};
+
+			// Precondition: never minus before start
+			auto operator--() -> iterator& {
+				// Check if we're at the end iterator
+				if (*this == iterator::end(graph_ptr_)) {
+
+					if (graph_ptr_->state_->index.empty()) {
+						throw std::out_of_range("Cannot decrement end iterator of an empty graph");
+					}
+
+					// Move to the last valid edge
+					current_node_ = std::prev(graph_ptr_->state_->index.end());
+					while (edges_at(current_node_).empty()) {
+						if (current_node_ == graph_ptr_->state_->index.begin()) {
+							throw std::out_of_range("Cannot decrement: all nodes are empty");
+						}
+
+						--current_node_;
+					}
+					edges_ = &edges_at(current_node_);
+					current_edge_ = edges_->size() - 1;
+					return *this;
+				}
+
+				// Check if we're at the beginning of the graph
+				if (current_node_ == graph_ptr_->state_->index.begin() and current_edge_ == 0) {
+					throw std::out_of_range("Cannot decrement iterator before beginning");
+				}
+
+				if (current_edge_ == 0) {
+					// Move to the previous node
+					do {
+						--current_node_;
+					} while (edges_at(current_node_).empty() and current_node_ != graph_ptr_->state_->index.begin());
+
+					// Set to the last edge of the non-empty node we found
+					edges_ = &edges_at(current_node_);
+					current_edge_ = edges_->size() - 1;
+				} else {
+					--current_edge_;
+				}
+				return *this;
+			}
+
+			auto operator--(int) noexcept -> iterator {
+				auto temp = *this;
+				--*this;
+				return temp;
+			};
+
+			// Iterator comparison. Positions are always normalised, end being (index.end(), 0) and every
+			// other position naming an existing edge, so comparing them never reads a node or an edge.
+			auto operator==(iterator const& other) const noexcept -> bool {
+				return graph_ptr_ == other.graph_ptr_ and current_node_ == other.current_node_
+				       and current_edge_ == other.current_edge_;
+			};
+
+		friend class graph;
+	};
+
+	/**
+	* The edges of a graph in storage order, returned by graph::edges_unordered(). A forward range and a
+	* std::ranges::view, whose iterators step through the node slots and their edge lists by position.
+	*/
+	template<typename N, typename E, edge_policy Policy, index_policy Index>
+	class graph<N, E, Policy, Index>::unordered_edges : public std::ranges::view_interface<unordered_edges> {
+		public:
+			class iterator {
+				public:
+					using value_type = typename graph::iterator::value_type;
+					using reference = value_type;
+					using pointer = void;
+					using difference_type = std::ptrdiff_t;
+					using iterator_category = std::forward_iterator_tag;
+
+					iterator() = default;
+
+					auto operator*() const -> reference {
+						const auto& slot = state_->nodes[slot_];
+						const auto& record = slot.edges->outgoing[edge_];
+						if constexpr (Policy == edge_policy::unweighted_only) {
+							return {*slot.value, *state_->nodes[record.node].value};
+						} else {
+							return {*slot.value, *state_->nodes[record.node].value, record.weight};
+						}
+					}
+
+					auto operator++() noexcept -> iterator& {
+						++edge_;
+						settle();
+						return *this;
+					}
+
+					auto operator++(int) noexcept -> iterator {
+						auto temp = *this;
+						++*this;
+						return temp;
+					}
+
+					auto operator==(iterator const& other) const noexcept -> bool {
+						return state_ == other.state_ and slot_ == other.slot_ and edge_ == other.edge_;
+					}
+
+				private:
+					iterator(storage const* state, std::size_t slot) noexcept : state_(state), slot_(slot) {
+						settle();
+					}
+
+					// Moves past the end of the current slot's edges, and past free slots and slots without edges
+					auto settle() noexcept -> void {
+						const auto& slots = state_->nodes;
+						while (slot_ < slots.size()
+						       and (slots[slot_].edges == nullptr or edge_ == slots[slot_].edges->outgoing.size())) {
+							++slot_;
+							edge_ = 0;
+						}
+					}
+
+					storage const* state_ = nullptr;
+					std::size_t slot_ = 0;
+					std::size_t edge_ = 0;
+
+				friend class unordered_edges;
+			};
+
+			unordered_edges() = default;
+
+			[[nodiscard]] auto begin() const noexcept -> iterator {
+				return iterator(state_, 0);
+			}
+
+			[[nodiscard]] auto end() const noexcept -> iterator {
+				return iterator(state_, state_->nodes.size());
+			}
+
+		private:
+			explicit unordered_edges(storage const* state) noexcept : state_(state) {}
+
+			storage const* state_ = empty_storage().get();
+
+		friend class graph;
+	};
+
+	/**
+	* The range returned by graph::connections_view: the distinct dsts of a node's outgoing edges, in order,
+	* as references to the graph's node values. Each step skips the run of records sharing a dst.
+	*/
+	template<typename N, typename E, edge_policy Policy, index_policy Index>
+	class graph<N, E, Policy, Index>::connections_range : public std::ranges::view_interface<connections_range> {
+		public:
+			class iterator {
+				public:
+					using value_type = N;
+					using reference = N const&;
+					using pointer = N const*;
+					using difference_type = std::ptrdiff_t;
+					using iterator_category = std::forward_iterator_tag;
+
+					iterator() = default;
+
+					auto operator*() const noexcept -> reference {
+						return *state_->nodes[pos_->node].value;
+					}
+
+					auto operator->() const noexcept -> pointer {
+						return state_->nodes[pos_->node].value;
+					}
+
+					auto operator++() noexcept -> iterator& {
+						const auto node = pos_->node;
+						do {
+							++pos_;
+						} while (pos_ != last_ and pos_->node == node);
+						return *this;
+					}
+
+					auto operator++(int) noexcept -> iterator {
+						auto temp = *this;
+						++*this;
+						return temp;
+					}
+
+					auto operator==(iterator const& other) const noexcept -> bool {
+						return pos_ == other.pos_;
+					}
+
+				private:
+					iterator(storage const* state, edge_record const* pos, edge_record const* last) noexcept
+					: state_(state), pos_(pos), last_(last) {}
+
+					storage const* state_ = nullptr;
+					edge_record const* pos_ = nullptr;
+					edge_record const* last_ = nullptr;
+
+				friend class connections_range;
+			};
+
+			connections_range() = default;
+
+			[[nodiscard]] auto begin() const noexcept -> iterator {
+				return iterator(state_, first_, last_);
+			}
+
+			[[nodiscard]] auto end() const noexcept -> iterator {
+				return iterator(state_, last_, last_);
+			}
+
+			// Returns: The number of distinct dsts, in O(1)
+			[[nodiscard]] auto size() const noexcept -> std::size_t {
+				return size_;
+			}
+
+		private:
+			connections_range(storage const* state, edge_record const* first, edge_record const* last, std::size_t size) noexcept
+			: state_(state), first_(first), last_(last), size_(size) {}
+
+			storage const* state_ = nullptr;
+			edge_record const* first_ = nullptr;
+			edge_record const* last_ = nullptr;
+			std::size_t size_ = 0;
+
+		friend class graph;
+	};
+
+	/**
+	* A read-only version of a graph, returned by graph::snapshot().
+	*
+	* Holds its own reference to the graph's storage, so mutating the original graph never invalidates it
+	* or its iterators. The read API of graph is reached through operator-> and operator*, and the snapshot
+	* itself is a range over the edges. Like graph, a snapshot must outlive its iterators.
+	*/
+	template<typename N, typename E, edge_policy Policy, index_policy Index>
+	class graph_snapshot {
+		public:
+			using iterator = typename graph<N, E, Policy, Index>::iterator;
+
+			[[nodiscard]] auto begin() const -> iterator {
+				return graph_.begin();
+			}
+
+			[[nodiscard]] auto end() const -> iterator {
+				return graph_.end();
+			}
+
+			[[nodiscard]] auto operator*() const noexcept -> graph<N, E, Policy, Index> const& {
+				return graph_;
+			}
+
+			[[nodiscard]] auto operator->() const noexcept -> graph<N, E, Policy, Index> const* {
+				return &graph_;
+			}
+
+			friend auto operator<<(std::ostream& os, graph_snapshot const& s) -> std::ostream& {
+				return os << s.graph_;
+			}
+
+		private:
+			explicit graph_snapshot(graph<N, E, Policy, Index> const& g) noexcept : graph_(g) {}
+
+			graph<N, E, Policy, Index> graph_;
+
+		friend class graph<N, E, Policy, Index>;
+	};
+
+	/**
+	* The subgraph of a graph induced by a set of its nodes, returned by graph::subgraph(): those nodes, and
+	* every edge whose src and dst are both among them.
+	*
+	* Like graph_snapshot, it shares the graph's storage instead of copying any value, and mutating the
+	* original graph afterwards never changes or invalidates it. The members are a bitset over the graph's
+	* node ids. It offers the read API of graph, and is a forward range over its edges in the order graph
+	* iterates them, with the same value_type as graph::iterator. A view must outlive its iterators.
+	*/
+	template<typename N, typename E, edge_policy Policy, index_policy Index>
+	class subgraph_view {
+		using graph_type = graph<N, E, Policy, Index>;
+		using node_id = typename graph_type::node_id;
+		using node_index = typename graph_type::node_index;
+		using edge_list = typename graph_type::edge_list;
+		using weight_type = typename graph_type::weight_type;
+
+		public:
+			class iterator {
+				public:
+					using value_type = typename graph_type::iterator::value_type;
+					using reference = value_type;
+					using pointer = void;
+					using difference_type = std::ptrdiff_t;
+					using iterator_category = std::forward_iterator_tag;
+
+					iterator() = default;
+
+					auto operator*() const -> reference {
+						const auto& record = (*edges_)[edge_];
+						if constexpr (Policy == edge_policy::unweighted_only) {
+							return {node_->first, view_->graph_.value_of(record.node)};
+						} else {
+							return {node_->first, view_->graph_.value_of(record.node), record.weight};
+						}
+					}
+
+					auto operator++() noexcept -> iterator& {
+						++edge_;
+						settle();
+						return *this;
+					}
+
+					auto operator++(int) noexcept -> iterator {
+						auto temp = *this;
+						++*this;
+						return temp;
+					}
+
+					// Positions are normalised like those of graph::iterator, end being (index.end(), 0)
+					auto operator==(iterator const& other) const noexcept -> bool {
+						return view_ == other.view_ and node_ == other.node_ and edge_ == other.edge_;
+					}
+
+				private:
+					iterator(subgraph_view const* view, typename node_index::const_iterator node, std::size_t edge) noexcept
+					: view_(view), node_(node), edges_(&view->edges_at(node)), edge_(edge) {
+						settle();
+					}
+
+					// Moves to the next member → member edge at or after the current position, skipping nodes
+					// that are not members or have no such edge
+					auto settle() noexcept -> void {
+						const auto end = view_->state().index.end();
+						while (node_ != end) {
+							if (view_->contains(node_->second)) {
+								while (edge_ < edges_->size() and !view_->contains((*edges_)[edge_].node)) {
+									++edge_;
+								}
+								if (edge_ < edges_->size()) {
+									return;
+								}
+							}
+							++node_;
+							edges_ = &view_->edges_at(node_);
+							edge_ = 0;
+						}
+					}
+
+					subgraph_view const* view_ = nullptr;
+					typename node_index::const_iterator node_;
+					edge_list const* edges_ = nullptr;
+					std::size_t edge_ = 0;
+
+				friend class subgraph_view;
+			};
+
+			[[nodiscard]] auto begin() const noexcept -> iterator {
+				return iterator(this, state().index.begin(), 0);
+			}
+
+			[[nodiscard]] auto end() const noexcept -> iterator {
+				return iterator(this, state().index.end(), 0);
+			}
+
+			/**
+			* Returns: true if value is a node of the subgraph, and false otherwise.
+			* Complexity: O(log(n)), and O(1) expected in hashed graphs.
+			*/
+			[[nodiscard]] auto is_node(N const& value) const -> bool {
+				const auto it = graph_.locate(value);
+				return it != state().index.end() and contains(it->second);
+			}
+
+			/**
+			* Returns: true if the subgraph has no nodes, and false otherwise.
+			*/
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return num_nodes_ == 0;
+			}
+
+			/**
+			* Returns: The number of nodes of the subgraph, in O(1).
+			*/
+			[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+				return num_nodes_;
+			}
+
+			/**
+			* Returns: A sequence of the nodes of the subgraph, sorted in ascending order.
+			* Complexity: O(n), where n is the number of nodes of the graph.
+			*/
+			[[nodiscard]] auto nodes() const -> std::vector<N> {
+				auto result = std::vector<N>();
+				result.reserve(num_nodes_);
+				for (const auto& [value, id] : state().index) {
+					if (contains(id)) {
+						result.push_back(value);
+					}
+				}
+				return result;
+			}
 
-				// Create 2 iterators one from g and one from other
-				auto g_it = begin();
-				auto other_it = other.begin();
+			/**
+			* Returns: true if an edge src → dst exists in the subgraph, and false otherwise.
+			* Complexity: O(log(n) + log(e)), where e is the number of outgoing edges of src in the graph.
+			* Throws: std::runtime_error("Cannot call gdwg::subgraph_view<N, E>::is_connected if src or dst node don't exist in the subgraph")
+			* if either of is_node(src) or is_node(dst) are false.
+			*/
+			[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+				if (!is_node(src) or !is_node(dst)) {
+					throw std::runtime_error("Cannot call gdwg::subgraph_view<N, E>::is_connected if src or dst node don't exist in the subgraph");
+				}
+				return graph_.is_connected(src, dst);
+			}
 
-				// Check nodes
-				const auto vec1 = nodes();
-				const auto vec2 = other.nodes();
-				for (size_t i = 0; i < vec1.size(); ++i) {
-					if (vec1.at(i) != vec2.at(i)) {
-						return false;  // Return false immediately if a mismatch is found
+			/**
+			* Returns: All nodes of the subgraph connected to src by an outgoing edge, sorted in ascending order.
+			* Complexity: O(log(n) + e), where e is the number of outgoing edges of src in the graph.
+			* Throws: std::runtime_error("Cannot call gdwg::subgraph_view<N, E>::connections if src doesn't exist in the subgraph")
+			* if is_node(src) is false.
+			*/
+			[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+				const auto src_it = graph_.locate(src);
+				if (src_it == state().index.end() or !contains(src_it->second)) {
+					throw std::runtime_error("Cannot call gdwg::subgraph_view<N, E>::connections if src doesn't exist in the subgraph");
+				}
+				// Records to the same dst are adjacent, and members are tested by id rather than looked up
+				auto result = std::vector<N>();
+				auto last_dst = std::optional<node_id>();
+				for (const auto& record : graph_.edges_of(src_it->second).outgoing) {
+					if (std::exchange(last_dst, record.node) != record.node and contains(record.node)) {
+						result.push_back(graph_.value_of(record.node));
 					}
 				}
-				 
-				// Handle the case when one of the iterators is already at end
-				if (g_it == end() and other_it == other.end()) {
-					return true;
+				return result;
+			}
+
+			/**
+			* Returns: An iterator to the edge src → dst with weight in the subgraph, or end() if there is none.
+			* In a weighted_only graph weight is an E, and an unweighted_only graph only has find(src, dst).
+			* Complexity: O(log(n) + log(e)), where e is the number of outgoing edges of src in the graph.
+			*/
+			[[nodiscard]] auto find(N const& src, N const& dst, weight_type const& weight) const -> iterator
+			requires (Policy != edge_policy::unweighted_only) {
+				return find_value(src, dst, weight);
+			}
+
+			/**
+			* Returns: find(src, dst, std::nullopt), the unweighted edge src → dst or end().
+			* Not available in weighted_only graphs.
+			*/
+			[[nodiscard]] auto find(N const& src, N const& dst) const -> iterator
+			requires (Policy != edge_policy::weighted_only) {
+				return find_value(src, dst, weight_type());
+			}
+
+			/**
+			* Returns: A graph equal to the subgraph, which copies each of its nodes and weights once. The edges are
+			* loaded through the bulk path of insert_edges, from records that are already in order.
+			* Complexity: O(n + k log(k) + m), where n is the number of nodes of the graph, k the number of nodes of
+			* the subgraph and m the number of edges leaving them in the graph.
+			*/
+			[[nodiscard]] auto materialize(typename graph_type::allocator_type alloc = {}) const -> graph_type {
+				auto result = graph_type(alloc);
+				auto remap = std::vector<node_id>(members_.size());
+				for (const auto& [value, id] : state().index) {
+					if (contains(id)) {
+						remap[id] = result.intern_node(value).first->second;
+					}
 				}
-				if (g_it == end() or other_it == other.end()) {
-					return false;
+				auto batch = std::vector<typename graph_type::pending_record>();
+				for (const auto& [value, id] : state().index) {
+					if (!contains(id)) {
+						continue;
+					}
+					for (const auto& record : graph_.edges_of(id).outgoing) {
+						if (contains(record.node)) {
+							batch.push_back({remap[id], {remap[record.node], record.weight}});
+						}
+					}
 				}
+				result.load_records(batch);
+				return result;
+			}
 
-				// Handle other case
-				while (g_it != end() and other_it != end()) {
-			        // Dereference iterators to get the value_type structs
-					auto value1 = *g_it;
-					auto value2 = *other_it;
+		private:
+			subgraph_view(graph_type const& g, std::vector<bool> members)
+			: graph_(g), members_(std::move(members)), num_nodes_(static_cast<std::size_t>(std::count(members_.begin(), members_.end(), true))) {}
 
-					// Compare the individual fields
-					if (value1.from != value2.from or
-						value1.to != value2.to or
-						value1.weight != value2.weight) {
-						return false; // One or more fields are not equal
+			auto state() const noexcept -> typename graph_type::storage const& {
+				return *graph_.state_;
+			}
+
+			auto contains(node_id id) const noexcept -> bool {
+				return members_[id];
+			}
+
+			// Outgoing edges of the node at it, or none at end
+			auto edges_at(typename node_index::const_iterator it) const noexcept -> edge_list const& {
+				static const auto no_edges = edge_list();
+				return it == state().index.end() ? no_edges : graph_.edges_of(it->second).outgoing;
+			}
+
+			auto find_value(N const& src, N const& dst, weight_type const& weight) const -> iterator {
+				const auto src_it = graph_.locate(src);
+				if (src_it == state().index.end() or !contains(src_it->second) or !is_node(dst)) {
+					return end();
+				}
+				const auto& outgoing_edges = graph_.edges_of(src_it->second).outgoing;
+				const auto it = graph_.find_record(outgoing_edges, typename graph_type::record_key{dst, weight});
+				if (it == outgoing_edges.end()) {
+					return end();
+				}
+				return iterator(this, src_it, static_cast<std::size_t>(it - outgoing_edges.begin()));
+			}
+
+			// Shares the storage of the graph it was taken from, as graph_snapshot does
+			graph_type graph_;
+			std::vector<bool> members_;
+			std::size_t num_nodes_;
+
+		friend class graph<N, E, Policy, Index>;
+	};
+
+	/**
+	* An immutable compressed sparse row (CSR) snapshot of a graph, built by graph::freeze().
+	*
+	* Nodes are stored in a sorted array and referred to by their position in it. The outgoing
+	* edges of the node at position i are [offsets_[i], offsets_[i + 1]) in the parallel
+	* dsts_ and weights_ arrays, in the same order graph iterates them. It offers the read
+	* API of graph, and its iterator has the same value_type as graph::iterator.
+	*/
+	template<typename N, typename E>
+	class csr_graph {
+		using position = std::uint32_t;
+
+		public:
+			// Forward declaration of iterator
+			class iterator;
+
+			/**
+			* Default constructor for csr_graph, an empty snapshot
+			*/
+			csr_graph() noexcept : offsets_{0} {};
+
+			/**
+			* Effects: Builds a snapshot of the nodes and edges currently in g.
+			* Complexity: O(n + e), where n is the number of stored nodes and e is the number of stored edges.
+			*/
+			explicit csr_graph(graph<N, E> const& g) {
+				// The node index is already sorted, so positions follow its order
+				auto positions = std::vector<position>(g.state_->nodes.size());
+				nodes_.reserve(g.state_->index.size());
+				for (const auto& [node, id] : g.state_->index) {
+					positions[id] = static_cast<position>(nodes_.size());
+					nodes_.push_back(node);
+				}
+
+				offsets_.reserve(nodes_.size() + 1);
+				offsets_.push_back(0);
+				for (const auto& [node, id] : g.state_->index) {
+					for (const auto& record : g.edges_of(id).outgoing) {
+						dsts_.push_back(positions[record.node]);
+						weights_.push_back(record.weight);
 					}
-					++g_it;
-        			++other_it;
+					offsets_.push_back(dsts_.size());
 				}
-				// If one iterator is not at end, the graphs are not equal
-				return g_it == end() and other_it == other.end();
-			};
+			}
 
 			/**
-			* Effects: Behaves as a formatted output function of os.
+			* Returns: true if a node equivalent to value exists in the snapshot, and false otherwise.
+			* Complexity: O(log n) time.
+			*/
+			[[nodiscard]] auto is_node(N const& value) const noexcept -> bool {
+				return position_of(value).has_value();
+			}
+
+			/**
+			* Returns: true if there are no nodes in the snapshot, and false otherwise
+			*/
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return nodes_.empty();
+			}
+
+			/**
+			* Returns: All stored nodes, sorted in ascending order.
+			* Complexity: O(1), the snapshot already stores them this way.
+			*/
+			[[nodiscard]] auto nodes() const noexcept -> std::vector<N> const& {
+				return nodes_;
+			}
+
+			/**
+			* Returns: true if an edge src → dst exists in the snapshot, and false otherwise.
+			* Complexity: O(log(n) + log(e)), where e is the number of outgoing edges of src.
+			* Throws: std::runtime_error("Cannot call gdwg::csr_graph<N, E>::is_connected if src or dst node don't exist in the graph")
+			* if either of is_node(src) or is_node(dst) are false.
+			*/
+			[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+				const auto src_pos = position_of(src);
+				const auto dst_pos = position_of(dst);
+				if (!src_pos or !dst_pos) {
+					throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::is_connected if src or dst node don't exist in the graph");
+				}
+				const auto [first, last] = edges_to(*src_pos, *dst_pos);
+				return first != last;
+			}
+
+			/**
+			* Returns: A sequence of edges from src to dst, start with the unweighted edge (if exists),
+			* then the rest of the weighted edges are sorted in ascending order.
+			* Throws: std::runtime_error("Cannot call gdwg::csr_graph<N, E>::edges if src or dst node don't exist in the graph")
+			* if either of is_node(src) or is_node(dst) are false.
+			*/
+			[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<std::unique_ptr<edge<N,E>>> {
+				const auto src_pos = position_of(src);
+				const auto dst_pos = position_of(dst);
+				if (!src_pos or !dst_pos) {
+					throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::edges if src or dst node don't exist in the graph");
+				}
+				std::vector<std::unique_ptr<edge<N,E>>> edges_ptr_vector;
+				const auto [first, last] = edges_to(*src_pos, *dst_pos);
+				for (auto i = first; i < last; ++i) {
+					if (weights_[i]) {
+						edges_ptr_vector.push_back(std::make_unique<gdwg::weighted_edge<N, E>>(src, dst, *weights_[i]));
+					} else {
+						edges_ptr_vector.push_back(std::make_unique<gdwg::unweighted_edge<N, E>>(src, dst));
+					}
+				}
+				return edges_ptr_vector;
+			}
+
+			/**
+			* Returns: An iterator pointing to an edge equivalent to the specified src, dst, and weight,
+			* or end() if no such edge exists.
+			* Complexity: O(log(n) + log(e)), where e is the number of outgoing edges of src.
+			*/
+			[[nodiscard]] auto find(N const& src, N const& dst, std::optional<E> weight = std::nullopt) const noexcept -> iterator {
+				const auto src_pos = position_of(src);
+				const auto dst_pos = position_of(dst);
+				if (!src_pos or !dst_pos) {
+					return end();
+				}
+				const auto [first, last] = edges_to(*src_pos, *dst_pos);
+				const auto weights_begin = weights_.begin() + static_cast<std::ptrdiff_t>(first);
+				const auto weights_end = weights_.begin() + static_cast<std::ptrdiff_t>(last);
+				const auto it = std::lower_bound(weights_begin, weights_end, weight);
+				if (it == weights_end or *it != weight) {
+					return end();
+				}
+				return iterator(this, *src_pos, static_cast<std::size_t>(it - weights_.begin()));
+			}
+
+			/**
+			* Returns: All nodes connected to src by an outgoing edge, sorted in ascending order.
+			* Complexity: O(log (n) + e), where e is the number of outgoing edges of src.
+			* Throws: std::runtime_error("Cannot call gdwg::csr_graph<N, E>::connections if src doesn't exist in the graph") if is_node(src) is false.
+			*/
+			[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+				const auto src_pos = position_of(src);
+				if (!src_pos) {
+					throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::connections if src doesn't exist in the graph");
+				}
+				std::vector<N> unique_dests;
+				for (auto i = offsets_[*src_pos]; i < offsets_[*src_pos + 1]; ++i) {
+					if (i == offsets_[*src_pos] or dsts_[i] != dsts_[i - 1]) {
+						unique_dests.push_back(nodes_[dsts_[i]]);
+					}
+				}
+				return unique_dests;
+			}
+
+			// Returns: An iterator pointing to the first edge in the snapshot.
+			[[nodiscard]] auto begin() const noexcept -> iterator {
+				auto it = iterator(this, 0, 0);
+				it.skip_empty_nodes();
+				return it;
+			}
+
+			// Returns: An iterator denoting the end of the iterable list that begin() points to.
+			[[nodiscard]] auto end() const noexcept -> iterator {
+				return iterator(this, nodes_.size(), dsts_.size());
+			}
+
+			[[nodiscard]] auto operator==(csr_graph const& other) const -> bool {
+				return nodes_ == other.nodes_ and offsets_ == other.offsets_ and
+					dsts_ == other.dsts_ and weights_ == other.weights_;
+			}
+
+			/**
+			* Effects: Behaves as a formatted output function of os, in the same format as graph.
 			* Returns: os.
 			*/
-			friend auto operator<<(std::ostream& os, graph const& g) -> std::ostream& {
-				for (const auto& [node, edge_sets] : g.g_) {
-					os << node << " (\n";
-					const auto& outgoing_edges = edge_sets.first;
-					std::for_each(outgoing_edges.begin(), outgoing_edges.end(),
-								[&os](const auto& edge) {
-									os << "  " << edge->print_edge() << "\n";
-								});
+			friend auto operator<<(std::ostream& os, csr_graph const& g) -> std::ostream& {
+				for (std::size_t n = 0; n < g.nodes_.size(); ++n) {
+					os << g.nodes_[n] << " (\n";
+					for (auto i = g.offsets_[n]; i < g.offsets_[n + 1]; ++i) {
+						os << "  " << to_string(g.nodes_[n]) << " -> " << to_string(g.nodes_[g.dsts_[i]]);
+						if (g.weights_[i]) {
+							os << " | W | " << to_string(*g.weights_[i]) << "\n";
+						} else {
+							os << " | U\n";
+						}
+					}
 					os << ")\n";
 				}
 				return os;
 			}
 
 		private:
-			// The graph will be a map with key is node
-			// for each key, we store a pair of set of edges where
-			// the first set is outgoing edges and the second set is incomming edges
-			// reflexive edge will be stored on both of the set
-			std::map<N, edge_ptr_set_pair> g_;
+			auto position_of(N const& value) const noexcept -> std::optional<std::size_t> {
+				const auto it = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+				if (it == nodes_.end() or *it != value) {
+					return std::nullopt;
+				}
+				return static_cast<std::size_t>(it - nodes_.begin());
+			}
+
+			// Returns the range of edge indices src → dst, every weight included
+			auto edges_to(std::size_t src, std::size_t dst) const noexcept -> std::pair<std::size_t, std::size_t> {
+				const auto row_begin = dsts_.begin() + static_cast<std::ptrdiff_t>(offsets_[src]);
+				const auto row_end = dsts_.begin() + static_cast<std::ptrdiff_t>(offsets_[src + 1]);
+				const auto [first, last] = std::equal_range(row_begin, row_end, static_cast<position>(dst));
+				return {static_cast<std::size_t>(first - dsts_.begin()), static_cast<std::size_t>(last - dsts_.begin())};
+			}
+
+			std::vector<N> nodes_;
+			std::vector<std::size_t> offsets_;
+			std::vector<position> dsts_;
+			std::vector<std::optional<E>> weights_;
 	};
 
 	template<typename N, typename E>
-	class graph<N, E>::iterator {
+	class csr_graph<N, E>::iterator {
 		private:
-			using graph_iterator = typename std::map<N, edge_ptr_set_pair>::const_iterator;
-			using edge_iterator = typename edge_ptr_set::const_iterator;
-			graph_iterator current_node_;
-			edge_iterator current_edge_;
-			// Raw graph ptr
-			const graph* graph_ptr_;
+			const csr_graph* graph_ptr_;
+			// Position of the source node, and index of the edge in the parallel arrays
+			std::size_t current_node_;
+			std::size_t current_edge_;
 
-			// Create a iterator based on given entities
-			explicit iterator(graph_iterator node, 
-							edge_iterator edge, 
-							const graph* g_ptr) : 
-			current_node_(node), current_edge_(edge), graph_ptr_(g_ptr) {};
+			explicit iterator(const csr_graph* g_ptr, std::size_t node, std::size_t edge) noexcept
+			: graph_ptr_(g_ptr), current_node_(node), current_edge_(edge) {};
 
-			// Store inside private because we are not required to implement this operator
-			// So I do not want accidentally to write my test which include this operator
-			// If my test using = operator is ever used against other people code, it will not work !
-			auto operator=(iterator const& other) noexcept -> iterator& {
-				if (this != &other) {
-					current_node_ = other.current_node_;
-					current_edge_ = other.current_edge_;
-					graph_ptr_ = other.graph_ptr_;
+			// Moves current_node_ forward to the node owning current_edge_
+			auto skip_empty_nodes() noexcept -> void {
+				const auto& offsets = graph_ptr_->offsets_;
+				while (current_node_ < graph_ptr_->nodes_.size() and current_edge_ == offsets[current_node_ + 1]) {
+					++current_node_;
 				}
-				return *this;
-			}
-			
-			// Public factory method for begin iterator
-			static iterator begin(const graph* g) noexcept {
-				if (g->g_.empty()) {
-					return end(g);
-				}
-				auto node_it = g->g_.begin();
-				while (node_it != g->g_.end() and node_it->second.first.empty()) {
-					++node_it;
-				}
-				if (node_it == g->g_.end()) {
-					return end(g);
-				}
-				return iterator(node_it, node_it->second.first.begin(), g);
-			}
-
-			static iterator end(const graph *g) noexcept {
-				return iterator(g->g_.end(), edge_iterator(), g);
 			}
 
 		public:
-			using value_type = struct {
-				N from;
-				N to;
-				std::optional<E> weight;
-			};
+			using value_type = typename graph<N, E>::iterator::value_type;
 			using reference = value_type;
 			using pointer = void;
 			using difference_type = std::ptrdiff_t;
 			using iterator_category = std::bidirectional_iterator_tag;
 
 			// Iterator constructor
-			iterator() : current_node_(), current_edge_(), graph_ptr_(nullptr) {}
-			
-			iterator(const iterator& other)
-				: current_node_(other.current_node_)
-				, current_edge_(other.current_edge_)
-				, graph_ptr_(other.graph_ptr_) {}
+			iterator() noexcept : graph_ptr_(nullptr), current_node_(0), current_edge_(0) {}
 
 			// Iterator source
 			auto operator*() const noexcept -> reference {
-				// Dereferencing an end vector case
-				// throw error
-
-				const auto& edge = *current_edge_;
-				return  value_type {
-					// current_node_->first;
-					edge->get_nodes().first,
-					edge->get_nodes().second,
-					edge->is_weighted() ? std::optional<E>{edge->get_weight()} : std::nullopt
+				const auto& g = *graph_ptr_;
+				return value_type {
+					g.nodes_[current_node_],
+					g.nodes_[g.dsts_[current_edge_]],
+					g.weights_[current_edge_]
 				};
-			};
+			}
 
 			// Iterator traversal
 			// Precondition: never add after end
 			auto operator++() noexcept -> iterator& {
 				++current_edge_;
-				if (current_edge_ == current_node_->second.first.end()) {
-					do {
-						++current_node_;
-						if (current_node_ == graph_ptr_->g_.end()) {
-							*this = iterator::end(graph_ptr_);
-							return *this;
-						}
-					} while (current_node_->second.first.empty());
-					current_edge_ = current_node_->second.first.begin();
-				}
+				skip_empty_nodes();
 				return *this;
 			}
 
-			// Precondition: never add after end
 			auto operator++(int) noexcept -> iterator {
 				auto temp = *this;
 				++*this;
 				return temp;
-			};
+			}
 
 			// Precondition: never minus before start
-			auto operator--() -> iterator& {
-				// Check if we're at the end iterator
-				if (*this == iterator::end(graph_ptr_)) {
-
-					if (graph_ptr_->g_.empty()) {
-						throw std::out_of_range("Cannot decrement end iterator of an empty graph");
-					}
-
-					// Move to the last valid edge
-					current_node_ = std::prev(graph_ptr_->g_.end());
-					while (current_node_->second.first.empty()) {
-						if (current_node_ == graph_ptr_->g_.begin()) {
-							throw std::out_of_range("Cannot decrement: all nodes are empty");
-						}
-
-						--current_node_;
-					}
-					current_edge_ = std::prev(current_node_->second.first.end());
-					return *this;
-				}
-
-				// Check if we're at the beginning of the graph
-				if (current_node_ == graph_ptr_->g_.begin() and current_edge_ == current_node_->second.first.begin()) {
-					throw std::out_of_range("Cannot decrement iterator before beginning");
-				}
-
-				if (current_edge_ == current_node_->second.first.begin()) {
-					// Move to the previous node
-					do {
-						--current_node_;
-					} while (current_node_->second.first.empty() and current_node_ != graph_ptr_->g_.begin());
-
-					// Set to the last edge of the non-empty node we found
-					current_edge_ = std::prev(current_node_->second.first.end());
-				} else {
-					--current_edge_;
+			auto operator--() noexcept -> iterator& {
+				--current_edge_;
+				while (current_edge_ < graph_ptr_->offsets_[current_node_]) {
+					--current_node_;
 				}
 				return *this;
 			}
-			
+
 			auto operator--(int) noexcept -> iterator {
 				auto temp = *this;
 				--*this;
 				return temp;
-			};
+			}
 
-			// Iterator comparison
+			// Iterator comparison, by position only
 			auto operator==(iterator const& other) const noexcept -> bool {
-				if (graph_ptr_ != other.graph_ptr_) {
-					return false;
-				}
-
-				// Check if both current_node_ iterators are at end
-				if (current_node_ == graph_ptr_->g_.end() and other.current_node_ == other.graph_ptr_->g_.end()) {
-					return true;
-				}
-
-				// If only one is at end, they're not equal
-				if (current_node_ == graph_ptr_->g_.end() or other.current_node_ == other.graph_ptr_->g_.end()) {
-					return false;
-				}
-
-				// Compare dereferenced current_node_
-				if (*current_node_ != *other.current_node_) {
-					return false;
-				}
-
-				// Check if both current_edge_ iterators are at end
-				if (current_edge_ == current_node_->second.first.end() and 
-					other.current_edge_ == other.current_node_->second.first.end()) {
-					return true;
-				}
-
-				// If only one is at end, they're not equal
-				if (current_edge_ == current_node_->second.first.end() or 
-					other.current_edge_ == other.current_node_->second.first.end()) {
-					return false;
-				}
-				
-				// Compare dereferenced current_edge_
-				return **current_edge_ == **other.current_edge_;
-			};
+				return graph_ptr_ == other.graph_ptr_ and current_edge_ == other.current_edge_;
+			}
 
-		friend class graph;
+		friend class csr_graph;
 	};
 
 } // namespace gdwg
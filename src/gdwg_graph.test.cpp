@@ -1,7 +1,30 @@
+// Instrumented, so that the tests of stats() see real counts. The other test programs cover the default build.
+#define GDWG_INSTRUMENT 1
 #include "gdwg_graph.h"
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
 TEST_CASE("Default construction of graph") {
     SECTION("Create a graph object") {
         // Create an instance of graph
@@ -124,6 +147,330 @@ TEST_CASE("Copy assignment operator tests") {
     }
 }
 
+TEST_CASE("Copies do not share edges with the original") {
+    auto g1 = gdwg::graph<std::string, int>{"A", "B", "C"};
+    g1.insert_edge("A", "B", 1);
+    g1.insert_edge("B", "C");
+    g1.insert_edge("C", "C", 3);
+
+    auto g2 = g1;
+    REQUIRE(g1 == g2);
+
+    SECTION("Mutating the copy leaves the original untouched") {
+        REQUIRE(g2.erase_edge("A", "B", 1));
+        REQUIRE(g2.replace_node("C", "D"));
+        REQUIRE(g1.is_connected("A", "B"));
+        REQUIRE(g1.is_node("C"));
+        REQUIRE(g2.is_connected("D", "D"));
+        REQUIRE(g2.edges("B", "D").size() == 1);
+    }
+
+    SECTION("The copy outlives the original") {
+        auto g3 = gdwg::graph<std::string, int>(g1);
+        g1.clear();
+        REQUIRE(g3.nodes() == std::vector<std::string>{"A", "B", "C"});
+        REQUIRE(g3.connections("A") == std::vector<std::string>{"B"});
+        REQUIRE(g3.erase_node("B"));
+        REQUIRE(g3.connections("A").empty());
+    }
+
+    SECTION("Copy assignment replaces existing content") {
+        auto g3 = gdwg::graph<std::string, int>{"X"};
+        g3 = g1;
+        REQUIRE(g3 == g1);
+        REQUIRE_FALSE(g3.is_node("X"));
+    }
+}
+
+TEST_CASE("Copy-on-write copies stay independent under every mutation") {
+    auto original = gdwg::graph<int, int>{1, 2, 3, 4};
+    original.insert_edge(1, 2, 1);
+    original.insert_edge(2, 3, 2);
+    original.insert_edge(3, 1, 3);
+    original.insert_edge(4, 4, std::nullopt);
+    auto const pristine = original;
+    auto original_out = std::ostringstream{};
+    original_out << original;
+
+    auto const unchanged = [&] {
+        auto out = std::ostringstream{};
+        out << original;
+        return out.str() == original_out.str() and original == pristine;
+    };
+
+    auto copy = original;
+    SECTION("insert_node and insert_edge") {
+        REQUIRE(copy.insert_node(5));
+        REQUIRE(copy.insert_edge(5, 1, 4));
+        REQUIRE(copy.insert_edges(std::vector<std::tuple<int, int, std::optional<int>>>{{2, 5, 1}}) == 1);
+        REQUIRE(copy.is_connected(2, 5));
+    }
+    SECTION("erase_edge by value and by iterator") {
+        REQUIRE(copy.erase_edge(1, 2, 1));
+        auto const next = copy.erase_edge(copy.begin());
+        REQUIRE(next != copy.end());
+        REQUIRE((*next).from == 3);
+        REQUIRE(copy.erase_edge(copy.begin(), copy.end()) == copy.end());
+        REQUIRE(copy.begin() == copy.end());
+    }
+    SECTION("replace_node and merge_replace_node") {
+        REQUIRE(copy.replace_node(1, 9));
+        copy.merge_replace_node(2, 3);
+        REQUIRE(copy.is_connected(9, 3));
+        REQUIRE(copy.is_connected(3, 3));
+    }
+    SECTION("erase_node, erase_nodes and clear") {
+        REQUIRE(copy.erase_node(2));
+        REQUIRE(copy.erase_nodes(std::vector<int>{3}) == 1);
+        REQUIRE(copy.connections(1).empty());
+        copy.clear();
+        REQUIRE(copy.empty());
+    }
+    SECTION("Mutating the original leaves the copy untouched") {
+        auto snapshot = original;
+        original.erase_node(1);
+        original.insert_edge(2, 4, 7);
+        REQUIRE(snapshot == pristine);
+        REQUIRE(snapshot.is_connected(3, 1));
+        REQUIRE_FALSE(snapshot.is_connected(2, 4));
+        original = pristine;
+    }
+    REQUIRE(unchanged());
+}
+
+namespace {
+    // Forwards to the default resource and counts the bytes still allocated through it
+    class counting_resource : public std::pmr::memory_resource {
+    public:
+        std::size_t outstanding = 0;
+        std::size_t allocations = 0;
+
+    private:
+        auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+            outstanding += bytes;
+            ++allocations;
+            return std::pmr::get_default_resource()->allocate(bytes, alignment);
+        }
+
+        auto do_deallocate(void* p, std::size_t bytes, std::size_t alignment) -> void override {
+            outstanding -= bytes;
+            std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+        }
+
+        auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override {
+            return this == &other;
+        }
+    };
+
+    template<typename Graph, typename... Args>
+    concept can_insert_edge = requires(Graph g, Args... args) { g.insert_edge(args...); };
+}
+
+TEST_CASE("Graphs allocate their storage from their memory resource") {
+    auto resource = counting_resource{};
+    auto g = gdwg::graph<std::string, int>(&resource);
+    REQUIRE(g.get_allocator().resource() == &resource);
+    g.insert_node("a");
+    g.insert_node("b");
+    g.insert_edge("a", "b", 1);
+    g.insert_edge("b", "a");
+    auto const after_build = resource.allocations;
+    REQUIRE(after_build > 0);
+
+    SECTION("Copies stay in the resource and detach into it") {
+        auto copy = g;
+        REQUIRE(copy.get_allocator() == g.get_allocator());
+        copy.insert_edge("a", "a", 2);
+        REQUIRE(resource.allocations > after_build);
+        REQUIRE_FALSE(g.is_connected("a", "a"));
+    }
+
+    SECTION("erase_nodes leaves shared storage alone when it erases nothing") {
+        g.defer_incoming_index();
+        auto const snapshot = g.snapshot();
+        auto const before = resource.allocations;
+        REQUIRE(g.erase_nodes(std::vector<std::string>{}) == 0);
+        REQUIRE(g.erase_nodes(std::vector<std::string>{"z", "y"}) == 0);
+        REQUIRE(resource.allocations == before);
+        REQUIRE_FALSE(g.has_incoming_index());
+
+        REQUIRE(g.erase_nodes(std::vector<std::string>{"z", "a"}) == 1);
+        REQUIRE(resource.allocations > before);
+        REQUIRE(g.has_incoming_index());
+        REQUIRE(snapshot->is_node("a"));
+        REQUIRE(g.nodes() == std::vector<std::string>{"b"});
+    }
+
+    SECTION("Copying with an allocator moves every byte to the new resource") {
+        auto arena = counting_resource{};
+        {
+            auto moved = gdwg::graph<std::string, int>(g, &arena);
+            REQUIRE(moved == g);
+            REQUIRE(arena.outstanding > 0);
+            g.clear();
+            REQUIRE(resource.outstanding == 0);
+            REQUIRE(moved.is_connected("a", "b"));
+            REQUIRE(moved.is_connected("b", "a"));
+
+            auto pool = std::pmr::unsynchronized_pool_resource{};
+            auto pooled = gdwg::graph<std::string, int>(std::move(moved), &pool);
+            REQUIRE(pooled.is_connected("a", "b"));
+            REQUIRE(pooled.get_allocator().resource() == &pool);
+        }
+        REQUIRE(arena.outstanding == 0);
+    }
+
+    SECTION("Assignment keeps the allocator of the target") {
+        auto other = gdwg::graph<std::string, int>{};
+        other = g;
+        REQUIRE(other.get_allocator().resource() == std::pmr::get_default_resource());
+        REQUIRE(other == g);
+        g.clear();
+        other.erase_edge("a", "b", 1);
+        REQUIRE(resource.outstanding > 0);
+        other.clear();
+        REQUIRE(resource.outstanding == 0);
+    }
+
+    SECTION("A monotonic arena serves a graph that is built once") {
+        auto arena = std::pmr::monotonic_buffer_resource{};
+        auto built = gdwg::graph<int, int>(&arena);
+        for (auto i = 0; i < 100; ++i) {
+            built.insert_node(i);
+        }
+        for (auto i = 0; i < 100; ++i) {
+            built.insert_edge(i, (i + 1) % 100, i);
+        }
+        REQUIRE(built.connections(99) == std::vector<int>{0});
+    }
+}
+
+namespace {
+    // The output format of operator<<, built from edges() and print_edge
+    template<typename N, typename E>
+    auto reference_output(gdwg::graph<N, E> const& g) -> std::string {
+        auto out = std::string();
+        for (auto const& src : g.nodes()) {
+            out += gdwg::to_string(src) + " (\n";
+            for (auto const& dst : g.connections(src)) {
+                for (auto const& e : g.edges(src, dst)) {
+                    out += "  " + e->print_edge() + "\n";
+                }
+            }
+            out += ")\n";
+        }
+        return out;
+    }
+
+    template<typename N, typename E>
+    auto stream_output(gdwg::graph<N, E> const& g, std::ios_base::fmtflags extra = {}) -> std::string {
+        auto out = std::ostringstream{};
+        out.setf(extra);
+        out << g;
+        return out.str();
+    }
+}
+
+TEST_CASE("operator<< output is byte for byte the print_edge format") {
+    SECTION("Floating point weights") {
+        auto g = gdwg::graph<int, double>{-3, 0, 7, 1000000};
+        auto const weights = std::vector<double>{0.0, -0.0, 2.5, 1.0 / 3.0, 1e-5, 123456789.0, 1e21, -4.25e-300,
+            std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN()};
+        for (auto const w : weights) {
+            g.insert_edge(-3, 7, w);
+        }
+        g.insert_edge(1000000, 0);
+        g.insert_edge(0, 0, 100000.0);
+        REQUIRE(stream_output(g) == reference_output(g));
+        // showbase has no effect on this output, but disables the buffered path
+        REQUIRE(stream_output(g, std::ios_base::showbase) == stream_output(g));
+    }
+
+    SECTION("Characters, strings and floats keep their stream formatting") {
+        auto chars = gdwg::graph<char, float>{'a', 'b'};
+        chars.insert_edge('a', 'b', 0.1f);
+        chars.insert_edge('b', 'a', 3.0e10f);
+        REQUIRE(stream_output(chars) == reference_output(chars));
+
+        auto strings = gdwg::graph<std::string, long long>{"", "x y", "long node name"};
+        strings.insert_edge("x y", "", -9000000000LL);
+        strings.insert_edge("", "long node name");
+        REQUIRE(stream_output(strings) == reference_output(strings));
+    }
+
+    SECTION("Large graphs cross several buffer blocks") {
+        auto g = gdwg::graph<int, int>{};
+        for (auto i = 0; i < 3000; ++i) {
+            g.insert_node(i);
+        }
+        for (auto i = 0; i < 3000; ++i) {
+            g.insert_edge(i, (i * 31) % 3000, i - 1500);
+            g.insert_edge(i, (i + 1) % 3000);
+        }
+        REQUIRE(stream_output(g) == reference_output(g));
+    }
+}
+
+TEST_CASE("snapshot iterators survive mutation of the graph") {
+    auto g = gdwg::graph<int, int>{};
+    for (auto i = 0; i < 200; ++i) {
+        g.insert_node(i);
+    }
+    for (auto i = 0; i < 200; ++i) {
+        g.insert_edge(i, (i * 7 + 3) % 200, i);
+        g.insert_edge(i, (i + 1) % 200);
+    }
+    auto const pristine = g;
+    auto const snapshot = g.snapshot();
+    REQUIRE(*snapshot == g);
+
+    SECTION("Iterators keep walking the old version") {
+        auto it = snapshot.begin();
+        ++it;
+        g.erase_node((*it).from);
+        g.insert_edge(5, 6, 99);
+        g.clear();
+        auto count = std::size_t{1};
+        for (; it != snapshot.end(); ++it) {
+            ++count;
+        }
+        REQUIRE(count == 400);
+        REQUIRE(*snapshot == pristine);
+        REQUIRE(snapshot->is_connected(0, 3));
+    }
+
+    SECTION("Readers on other threads scan while the owner keeps writing") {
+        auto expected = std::ostringstream{};
+        expected << pristine;
+        auto scans = std::vector<std::string>(2);
+        auto readers = std::vector<std::thread>();
+        for (auto& scan : scans) {
+            readers.emplace_back([&snapshot, &scan] {
+                for (auto pass = 0; pass < 5; ++pass) {
+                    auto out = std::ostringstream{};
+                    out << snapshot;
+                    scan = out.str();
+                }
+            });
+        }
+        for (auto i = 0; i < 200; ++i) {
+            g.replace_node(i, 1000 + i);
+            g.insert_edge(1000 + i, 1000 + i / 2, -i);
+        }
+        for (auto i = 0; i < 200; i += 10) {
+            g.erase_node(1000 + i);
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        for (auto const& scan : scans) {
+            REQUIRE(scan == expected.str());
+        }
+        REQUIRE(*snapshot == pristine);
+        REQUIRE_FALSE(g == pristine);
+    }
+}
+
 TEST_CASE("Edge print_edge function") {
     SECTION("Weighted edge string representation") {
         gdwg::weighted_edge<int, int> e1(1, 2, 10);
@@ -216,6 +563,18 @@ TEST_CASE("Edge get_nodes function") {
     }
 }
 
+TEST_CASE("Edge src and dst accessors") {
+    gdwg::weighted_edge<std::string, int> e1("A", "B", 2);
+    REQUIRE(e1.src() == "A");
+    REQUIRE(e1.dst() == "B");
+    // References into the edge itself, not copies
+    REQUIRE(&e1.src() == &e1.src());
+
+    gdwg::unweighted_edge<int, int> e2(3, 4);
+    REQUIRE(e2.src() == 3);
+    REQUIRE(e2.dst() == 4);
+}
+
 TEST_CASE("Insert node into graph") {
     gdwg::graph<int, int> g;
 
@@ -320,6 +679,66 @@ TEST_CASE("Insert edge tests") {
     }
 }
 
+TEST_CASE("insert_edges batch tests") {
+	using edge_tuple = std::tuple<int, int, std::optional<int>>;
+	auto g = gdwg::graph<int, int>{1, 2, 3, 4};
+	g.insert_edge(1, 2, 5);
+
+	SECTION("Batch matches one insert_edge per element") {
+		auto const batch = std::vector<edge_tuple>{{3, 1, 2}, {1, 2, 5}, {1, 1, std::nullopt}, {3, 1, 2}, {1, 2, std::nullopt}, {4, 3, 1}};
+		auto expected = g;
+		for (auto const& [src, dst, weight] : batch) {
+			expected.insert_edge(src, dst, weight);
+		}
+		REQUIRE(g.insert_edges(batch) == 4);
+		REQUIRE(g == expected);
+		REQUIRE(g.connections(1) == std::vector<int>{1, 2});
+		REQUIRE(g.is_connected(4, 3));
+		auto out = std::ostringstream{};
+		auto expected_out = std::ostringstream{};
+		out << g;
+		expected_out << expected;
+		REQUIRE(out.str() == expected_out.str());
+		REQUIRE(g.insert_edges(batch) == 0);
+	}
+
+	SECTION("Missing node throws and inserts nothing") {
+		auto const batch = std::vector<edge_tuple>{{1, 3, 1}, {1, 9, 1}};
+		auto const before = g;
+		REQUIRE_THROWS_WITH(g.insert_edges(batch),
+		                    "Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does not exist");
+		REQUIRE(g == before);
+	}
+
+	SECTION("Edges of another graph can be loaded as iterator values") {
+		auto other = gdwg::graph<int, int>{1, 2, 3, 4};
+		other.insert_edge(4, 1, 3);
+		other.insert_edge(2, 2, std::nullopt);
+		other.insert_edge(1, 2, 5);
+		auto values = std::vector<gdwg::graph<int, int>::iterator::value_type>();
+		for (auto const& value : other) {
+			values.push_back(value);
+		}
+		REQUIRE(g.insert_edges(values) == 2);
+		REQUIRE(g.is_connected(4, 1));
+		REQUIRE(g.is_connected(2, 2));
+		REQUIRE(g.find(1, 2, 5) != g.end());
+	}
+}
+
+TEST_CASE("Constructor from node and edge ranges") {
+	auto const nodes = std::vector<std::string>{"c", "a", "b"};
+	auto const edges = std::vector<std::tuple<std::string, std::string, std::optional<int>>>{{"a", "b", 1}, {"c", "a", std::nullopt}};
+	auto const g = gdwg::graph<std::string, int>(nodes, edges);
+	REQUIRE(g.nodes() == std::vector<std::string>{"a", "b", "c"});
+	REQUIRE(g.is_connected("a", "b"));
+	REQUIRE(g.is_connected("c", "a"));
+	REQUIRE(g.edges("c", "a").size() == 1);
+
+	auto const missing = std::vector<std::tuple<std::string, std::string, std::optional<int>>>{{"a", "z", 1}};
+	REQUIRE_THROWS_AS((gdwg::graph<std::string, int>(nodes, missing)), std::runtime_error);
+}
+
 TEST_CASE("Replace node tests") {
     // Create a graph with integer nodes and integer edge weights
     gdwg::graph<int, int> g;
@@ -786,6 +1205,46 @@ TEST_CASE("erase_node functionality") {
     }
 }
 
+TEST_CASE("erase_node only leaves edges between surviving nodes") {
+	auto g = gdwg::graph<int, int>{1, 2, 3, 4, 5};
+	g.insert_edge(1, 2, 1);
+	g.insert_edge(2, 1, 2);
+	g.insert_edge(2, 2, 3);
+	g.insert_edge(2, 3, std::nullopt);
+	g.insert_edge(2, 3, 4);
+	g.insert_edge(3, 4, 5);
+	g.insert_edge(4, 2, 6);
+	g.insert_edge(5, 1, 7);
+
+	SECTION("erase_node") {
+		REQUIRE(g.erase_node(2));
+		auto expected = gdwg::graph<int, int>{1, 3, 4, 5};
+		expected.insert_edge(3, 4, 5);
+		expected.insert_edge(5, 1, 7);
+		REQUIRE(g == expected);
+
+		// Neighbours' incoming lists must no longer refer to the erased node
+		g.merge_replace_node(4, 1);
+		REQUIRE(g.is_connected(3, 1));
+		REQUIRE(g.edges(5, 1).size() == 1);
+		REQUIRE(g.insert_node(2));
+		REQUIRE(g.connections(2).empty());
+	}
+
+	SECTION("erase_nodes matches erase_node on each value") {
+		auto expected = g;
+		expected.erase_node(2);
+		expected.erase_node(4);
+		auto const values = std::vector<int>{4, 9, 2, 4};
+		REQUIRE(g.erase_nodes(values) == 2);
+		REQUIRE(g == expected);
+		REQUIRE(g.nodes() == std::vector<int>{1, 3, 5});
+		REQUIRE(g.erase_nodes(values) == 0);
+		g.replace_node(1, 6);
+		REQUIRE(g.is_connected(5, 6));
+	}
+}
+
 TEST_CASE("erase_edge functionality") {
     gdwg::graph<std::string, int> g;
 
@@ -1350,6 +1809,38 @@ TEST_CASE("Graphs with same number of nodes but different node names should not
     REQUIRE_FALSE(g1 == g2); // The graphs have different node names, so they should not be equal
 }
 
+namespace {
+    // No std::hash specialisation, so graphs of it have no fingerprint to reject unequal graphs early
+    struct unhashed {
+        int value;
+        auto operator<=>(unhashed const&) const = default;
+    };
+
+    auto operator<<(std::ostream& os, unhashed const& w) -> std::ostream& {
+        return os << w.value;
+    }
+}
+
+TEST_CASE("Graphs with weights that cannot be hashed compare edge by edge") {
+    auto g1 = gdwg::graph<int, unhashed>{1, 2, 3};
+    auto g2 = g1;
+    REQUIRE(g1.insert_edge(1, 2, unhashed{1}));
+    REQUIRE(g1.insert_edge(2, 3, unhashed{2}));
+    REQUIRE(g1.insert_edge(3, 1, unhashed{3}));
+    REQUIRE(g2.insert_edge(1, 2, unhashed{1}));
+
+    // The graph with more edges must not be walked past the end of the other
+    REQUIRE_FALSE(g1 == g2);
+    REQUIRE_FALSE(g2 == g1);
+
+    REQUIRE(g2.insert_edge(2, 3, unhashed{2}));
+    REQUIRE(g2.insert_edge(3, 1, unhashed{4}));
+    REQUIRE_FALSE(g1 == g2);
+    REQUIRE(g2.erase_edge(3, 1, unhashed{4}));
+    REQUIRE(g2.insert_edge(3, 1, unhashed{3}));
+    REQUIRE(g1 == g2);
+}
+
 TEST_CASE("Graph output operator test") {
     SECTION("Graph with isolated nodes") {
         gdwg::graph<std::string, double> g;
@@ -1596,6 +2087,54 @@ TEST_CASE("Additional Graph find function tests") {
 
 }
 
+TEST_CASE("Edge lookup on a node with many outgoing edges") {
+    auto g = gdwg::graph<std::string, int>{"hub", "a", "b", "c"};
+    for (int w = 0; w < 100; ++w) {
+        REQUIRE(g.insert_edge("hub", "b", w));
+    }
+    REQUIRE(g.insert_edge("hub", "b"));
+    REQUIRE(g.insert_edge("hub", "c", 7));
+
+    SECTION("find hits the exact weight and misses others") {
+        auto it = g.find("hub", "b", 42);
+        REQUIRE(it != g.end());
+        REQUIRE((*it).weight == 42);
+        REQUIRE((*g.find("hub", "b")).weight == std::nullopt);
+        REQUIRE(g.find("hub", "b", 100) == g.end());
+        REQUIRE(g.find("hub", "c") == g.end());
+        REQUIRE(g.find("hub", "a", 42) == g.end());
+    }
+
+    SECTION("duplicates are rejected") {
+        REQUIRE_FALSE(g.insert_edge("hub", "b", 42));
+        REQUIRE_FALSE(g.insert_edge("hub", "b"));
+        REQUIRE(g.insert_edge("b", "hub", 42));
+    }
+
+    SECTION("is_connected only matches the destination") {
+        REQUIRE(g.is_connected("hub", "b"));
+        REQUIRE(g.is_connected("hub", "c"));
+        REQUIRE_FALSE(g.is_connected("hub", "a"));
+        REQUIRE_FALSE(g.is_connected("b", "hub"));
+    }
+
+    SECTION("edges returns the unweighted edge first then ascending weights") {
+        auto edges = g.edges("hub", "b");
+        REQUIRE(edges.size() == 101);
+        REQUIRE(edges.front()->get_weight() == std::nullopt);
+        REQUIRE(edges[1]->get_weight() == 0);
+        REQUIRE(edges.back()->get_weight() == 99);
+    }
+
+    SECTION("erase_edge removes exactly one edge from both sides") {
+        REQUIRE(g.erase_edge("hub", "b", 42));
+        REQUIRE_FALSE(g.erase_edge("hub", "b", 42));
+        REQUIRE(g.find("hub", "b", 42) == g.end());
+        REQUIRE(g.edges("hub", "b").size() == 100);
+        REQUIRE(g.insert_edge("hub", "b", 42));
+    }
+}
+
 TEST_CASE("erase_edge iterator i") {
     SECTION("erase_edge iterator i at the beginning") {
         auto g = gdwg::graph<int, std::string>{1, 2, 3};
@@ -1678,6 +2217,1446 @@ TEST_CASE("erase_edge range of iterators [i, s)") {
 }
 
 
+TEST_CASE("erase_edge range within a single node's edges") {
+    auto g = gdwg::graph<int, int>{1, 2, 3};
+    g.insert_edge(1, 2, 1);
+    g.insert_edge(1, 2, 2);
+    g.insert_edge(1, 3, 3);
+    g.insert_edge(1, 3, 4);
+    g.insert_edge(2, 3, 5);
+
+    auto start_it = g.find(1, 2, 2);
+    auto end_it = g.find(1, 3, 4);
+    auto it = g.erase_edge(start_it, end_it);
+    REQUIRE(it == g.find(1, 3, 4));
+    REQUIRE(g.edges(1, 2).size() == 1);
+    REQUIRE(g.edges(1, 3).size() == 1);
+    REQUIRE((*g.begin()).weight == 1);
+
+    // Erasing through to the end
+    REQUIRE(g.erase_edge(g.begin(), g.end()) == g.end());
+    REQUIRE(g.begin() == g.end());
+}
+
+TEST_CASE("replace_node keeps both sides of every edge consistent") {
+    auto g = gdwg::graph<int, int>{1, 2, 3};
+    g.insert_edge(1, 2, 10);
+    g.insert_edge(3, 1, 20);
+    g.insert_edge(1, 1, 30);
+
+    REQUIRE(g.replace_node(1, 5));
+    REQUIRE(g.erase_node(2));
+    REQUIRE(g.erase_node(3));
+
+    std::ostringstream oss;
+    oss << g;
+    REQUIRE(oss.str() == "5 (\n  5 -> 5 | W | 30\n)\n");
+    REQUIRE(g.erase_edge(5, 5, 30));
+    REQUIRE(g.begin() == g.end());
+}
+
+TEST_CASE("replace_node moves the node to its new sorted position") {
+    auto g = gdwg::graph<int, int>{1, 2, 3, 5};
+    g.insert_edge(3, 1, 7);
+    g.insert_edge(3, 1);
+    g.insert_edge(3, 2, 8);
+    g.insert_edge(3, 5, 9);
+    g.insert_edge(2, 1);
+    g.insert_edge(1, 1, 6);
+    g.insert_edge(1, 5);
+
+    REQUIRE(g.replace_node(1, 4));
+    REQUIRE(g.connections(3) == std::vector<int>{2, 4, 5});
+
+    std::ostringstream oss;
+    oss << g;
+    REQUIRE(oss.str() == R"(2 (
+  2 -> 4 | U
+)
+3 (
+  3 -> 2 | W | 8
+  3 -> 4 | U
+  3 -> 4 | W | 7
+  3 -> 5 | W | 9
+)
+4 (
+  4 -> 4 | W | 6
+  4 -> 5 | U
+)
+5 (
+)
+)");
+
+    // Incoming lists were kept in order too, erasing through them must still work
+    REQUIRE(g.erase_edge(3, 4, 7));
+    REQUIRE(g.erase_node(4));
+    REQUIRE(g.connections(3) == std::vector<int>{2, 5});
+    REQUIRE(g.connections(2).empty());
+}
+
+TEST_CASE("Erased nodes can be inserted again") {
+    auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
+    g.insert_edge("A", "B", 1);
+    g.insert_edge("C", "A", 2);
+    REQUIRE(g.erase_node("A"));
+    REQUIRE(g.insert_node("D"));
+    REQUIRE(g.insert_node("A"));
+    REQUIRE_FALSE(g.is_connected("A", "B"));
+    REQUIRE_FALSE(g.is_connected("C", "A"));
+    REQUIRE(g.insert_edge("D", "A", 3));
+    REQUIRE(g.insert_edge("A", "D", 4));
+    REQUIRE(g.nodes() == std::vector<std::string>{"A", "B", "C", "D"});
+    REQUIRE(g.connections("D") == std::vector<std::string>{"A"});
+    REQUIRE((*g.begin()).to == "D");
+}
+
+TEST_CASE("freeze produces an equivalent csr_graph") {
+    auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D"};
+    g.insert_edge("A", "B", 3);
+    g.insert_edge("A", "B");
+    g.insert_edge("A", "C", 1);
+    g.insert_edge("C", "A", 2);
+    g.insert_edge("C", "C");
+    const auto csr = g.freeze();
+
+    SECTION("Nodes and queries match the graph") {
+        REQUIRE(csr.nodes() == g.nodes());
+        REQUIRE(csr.is_node("D"));
+        REQUIRE_FALSE(csr.is_node("E"));
+        REQUIRE_FALSE(csr.empty());
+        REQUIRE(csr.is_connected("A", "C"));
+        REQUIRE_FALSE(csr.is_connected("B", "A"));
+        REQUIRE(csr.connections("A") == g.connections("A"));
+        REQUIRE(csr.connections("D").empty());
+        auto edges = csr.edges("A", "B");
+        REQUIRE(edges.size() == 2);
+        REQUIRE(edges[0]->get_weight() == std::nullopt);
+        REQUIRE(edges[1]->get_weight() == 3);
+    }
+
+    SECTION("Iteration matches the graph") {
+        auto g_it = g.begin();
+        for (auto const& [from, to, weight] : csr) {
+            REQUIRE(g_it != g.end());
+            REQUIRE(from == (*g_it).from);
+            REQUIRE(to == (*g_it).to);
+            REQUIRE(weight == (*g_it).weight);
+            ++g_it;
+        }
+        REQUIRE(g_it == g.end());
+        auto last = csr.end();
+        --last;
+        REQUIRE((*last).from == "C");
+        REQUIRE((*last).to == "C");
+        --last;
+        REQUIRE((*last).to == "A");
+    }
+
+    SECTION("find returns iterators into the snapshot") {
+        auto it = csr.find("A", "B", 3);
+        REQUIRE(it != csr.end());
+        REQUIRE((*it).weight == 3);
+        ++it;
+        REQUIRE((*it).to == "C");
+        REQUIRE(csr.find("A", "B", 4) == csr.end());
+        REQUIRE(csr.find("A", "E") == csr.end());
+    }
+
+    SECTION("Output is identical to the graph") {
+        std::ostringstream expected;
+        expected << g;
+        std::ostringstream actual;
+        actual << csr;
+        REQUIRE(actual.str() == expected.str());
+    }
+
+    SECTION("The snapshot is unaffected by later mutation") {
+        g.erase_node("A");
+        REQUIRE(csr.is_connected("A", "B"));
+        REQUIRE_FALSE(csr == g.freeze());
+        REQUIRE(g.freeze().nodes() == std::vector<std::string>{"B", "C", "D"});
+    }
+
+    SECTION("Exceptions") {
+        REQUIRE_THROWS_WITH(csr.is_connected("A", "E"),
+            "Cannot call gdwg::csr_graph<N, E>::is_connected if src or dst node don't exist in the graph");
+        REQUIRE_THROWS_WITH(csr.connections("E"),
+            "Cannot call gdwg::csr_graph<N, E>::connections if src doesn't exist in the graph");
+    }
+}
+
+TEST_CASE("freeze of graphs without edges") {
+    const auto empty = gdwg::graph<int, int>{}.freeze();
+    REQUIRE(empty.empty());
+    REQUIRE(empty.begin() == empty.end());
+
+    const auto isolated = gdwg::graph<int, int>{1, 2, 3}.freeze();
+    REQUIRE(isolated.begin() == isolated.end());
+    REQUIRE(isolated.nodes().size() == 3);
+}
+
+TEST_CASE("Graphs restricted to one kind of edge") {
+    SECTION("weighted_only graphs take and return plain weights") {
+        using weighted = gdwg::graph<std::string, double, gdwg::edge_policy::weighted_only>;
+        static_assert(std::same_as<weighted::weight_type, double>);
+        static_assert(!can_insert_edge<weighted, std::string, std::string>);
+        static_assert(can_insert_edge<weighted, std::string, std::string, double>);
+        static_assert(std::same_as<decltype(weighted::iterator::value_type::weight), double>);
+
+        auto g = weighted{"a", "b", "c"};
+        REQUIRE(g.insert_edge("a", "b", 2.5));
+        REQUIRE(g.insert_edge("a", "b", 1.0));
+        REQUIRE_FALSE(g.insert_edge("a", "b", 1.0));
+        REQUIRE(g.insert_edges(std::vector<std::tuple<std::string, std::string, double>>{{"c", "a", 3.0}, {"b", "b", 4.0}}) == 2);
+        REQUIRE(g.find("a", "b", 2.5) != g.end());
+        REQUIRE((*g.find("c", "a", 3.0)).weight == 3.0);
+
+        auto const edges = g.edges("a", "b");
+        REQUIRE(edges.size() == 2);
+        REQUIRE(edges[0]->is_weighted());
+        REQUIRE(edges[0]->get_weight() == 1.0);
+        REQUIRE(edges[1]->print_edge() == "a -> b | W | 2.5");
+
+        auto out = std::ostringstream{};
+        out << g;
+        REQUIRE(out.str() == "a (\n  a -> b | W | 1\n  a -> b | W | 2.5\n)\nb (\n  b -> b | W | 4\n)\nc (\n  c -> a | W | 3\n)\n");
+
+        auto copy = g;
+        REQUIRE(copy.erase_edge("a", "b", 1.0));
+        REQUIRE_FALSE(copy.erase_edge("a", "b", 1.0));
+        REQUIRE(copy != g);
+        copy.replace_node("a", "z");
+        REQUIRE(copy.is_connected("z", "b"));
+        REQUIRE(g.snapshot()->is_connected("a", "b"));
+    }
+
+    SECTION("unweighted_only graphs store no weights") {
+        using unweighted = gdwg::graph<int, int, gdwg::edge_policy::unweighted_only>;
+        static_assert(!can_insert_edge<unweighted, int, int, int>);
+        static_assert(!can_insert_edge<unweighted, int, int, std::optional<int>>);
+        static_assert(can_insert_edge<unweighted, int, int>);
+
+        auto g = unweighted{1, 2, 3};
+        REQUIRE(g.insert_edge(1, 2));
+        REQUIRE_FALSE(g.insert_edge(1, 2));
+        REQUIRE(g.insert_edge(2, 2));
+        REQUIRE(g.insert_edges(std::vector<std::pair<int, int>>{{3, 1}, {1, 2}, {1, 3}}) == 2);
+        REQUIRE(g.find(3, 1) != g.end());
+        REQUIRE(g.find(1, 1) == g.end());
+        REQUIRE(g.connections(1) == std::vector<int>{2, 3});
+
+        auto visited = std::vector<std::pair<int, int>>();
+        for (auto const& [from, to] : g) {
+            visited.emplace_back(from, to);
+        }
+        REQUIRE(visited == std::vector<std::pair<int, int>>{{1, 2}, {1, 3}, {2, 2}, {3, 1}});
+
+        auto const edges = g.edges(1, 2);
+        REQUIRE(edges.size() == 1);
+        REQUIRE_FALSE(edges[0]->is_weighted());
+        auto out = std::ostringstream{};
+        out << g;
+        REQUIRE(out.str() == "1 (\n  1 -> 2 | U\n  1 -> 3 | U\n)\n2 (\n  2 -> 2 | U\n)\n3 (\n  3 -> 1 | U\n)\n");
+
+        auto copy = g;
+        REQUIRE(copy == g);
+        REQUIRE(copy.erase_edge(1, 2));
+        REQUIRE_FALSE(copy.erase_edge(1, 2));
+        REQUIRE(copy != g);
+        REQUIRE(copy.erase_edge(copy.find(2, 2)) == copy.find(3, 1));
+        copy.merge_replace_node(3, 1);
+        REQUIRE(copy.is_connected(1, 1));
+    }
+
+    SECTION("Restricted graphs allocate less per edge") {
+        auto mixed_resource = counting_resource{};
+        auto unweighted_resource = counting_resource{};
+        auto mixed = gdwg::graph<int, double>(&mixed_resource);
+        auto unweighted = gdwg::graph<int, double, gdwg::edge_policy::unweighted_only>(&unweighted_resource);
+        for (auto i = 0; i < 64; ++i) {
+            mixed.insert_node(i);
+            unweighted.insert_node(i);
+        }
+        auto const mixed_nodes = mixed_resource.outstanding;
+        auto const unweighted_nodes = unweighted_resource.outstanding;
+        for (auto i = 0; i < 64; ++i) {
+            for (auto j = 0; j < 64; j += 4) {
+                mixed.insert_edge(i, j);
+                unweighted.insert_edge(i, j);
+            }
+        }
+        // Records shrink from 24 bytes to 4, next to the same per-node list headers
+        REQUIRE((unweighted_resource.outstanding - unweighted_nodes) * 3 < (mixed_resource.outstanding - mixed_nodes));
+    }
+}
+
+TEST_CASE("Hashed graphs behave exactly like ordered graphs") {
+    using hashed = gdwg::graph<int, int, gdwg::edge_policy::mixed, gdwg::index_policy::hashed>;
+    auto ordered_graph = gdwg::graph<int, int>{};
+    auto hashed_graph = hashed{};
+    auto const same = [&] {
+        REQUIRE(ordered_graph.nodes() == hashed_graph.nodes());
+        auto ordered_out = std::ostringstream{};
+        auto hashed_out = std::ostringstream{};
+        ordered_out << ordered_graph;
+        hashed_out << hashed_graph;
+        REQUIRE(ordered_out.str() == hashed_out.str());
+        for (auto value = -1; value <= 200; ++value) {
+            REQUIRE(ordered_graph.is_node(value) == hashed_graph.is_node(value));
+        }
+    };
+
+    // A fixed pseudo random sequence of every kind of mutation, repeated on both graphs
+    auto state = 12345U;
+    auto const next = [&state](unsigned bound) {
+        state = state * 1103515245U + 12345U;
+        return static_cast<int>((state >> 16) % bound);
+    };
+    for (auto round = 0; round < 3000; ++round) {
+        auto const a = next(200);
+        auto const b = next(200);
+        switch (next(10)) {
+        case 0:
+        case 1:
+        case 2:
+            REQUIRE(ordered_graph.insert_node(a) == hashed_graph.insert_node(a));
+            break;
+        case 3:
+            REQUIRE(ordered_graph.erase_node(a) == hashed_graph.erase_node(a));
+            break;
+        case 4:
+            if (ordered_graph.is_node(a)) {
+                REQUIRE(ordered_graph.replace_node(a, b) == hashed_graph.replace_node(a, b));
+            }
+            break;
+        case 5:
+            if (ordered_graph.is_node(a) and ordered_graph.is_node(b)) {
+                ordered_graph.merge_replace_node(a, b);
+                hashed_graph.merge_replace_node(a, b);
+            }
+            break;
+        case 6:
+            REQUIRE(ordered_graph.erase_nodes(std::vector<int>{a, b, a + 1}) == hashed_graph.erase_nodes(std::vector<int>{a, b, a + 1}));
+            break;
+        default:
+            if (ordered_graph.is_node(a) and ordered_graph.is_node(b)) {
+                REQUIRE(ordered_graph.insert_edge(a, b, b % 3) == hashed_graph.insert_edge(a, b, b % 3));
+                REQUIRE(ordered_graph.is_connected(b, a) == hashed_graph.is_connected(b, a));
+                REQUIRE((ordered_graph.find(a, b, b % 3) == ordered_graph.end()) == (hashed_graph.find(a, b, b % 3) == hashed_graph.end()));
+            }
+            break;
+        }
+        if (round % 500 == 0) {
+            same();
+        }
+    }
+    same();
+
+    SECTION("Copies rebuild their own table") {
+        auto copy = hashed_graph;
+        auto const before = hashed_graph.nodes();
+        for (auto const value : before) {
+            REQUIRE(copy.erase_node(value));
+        }
+        REQUIRE(copy.empty());
+        REQUIRE(hashed_graph.nodes() == before);
+        for (auto const value : before) {
+            REQUIRE(hashed_graph.is_node(value));
+            REQUIRE(copy.insert_node(value));
+        }
+        REQUIRE(copy.nodes() == before);
+
+        auto arena = std::pmr::monotonic_buffer_resource{};
+        auto const moved = hashed(hashed_graph, &arena);
+        REQUIRE(moved == hashed_graph);
+        REQUIRE(moved.is_node(before.front()));
+    }
+
+    SECTION("String nodes") {
+        auto g = gdwg::graph<std::string, int, gdwg::edge_policy::mixed, gdwg::index_policy::hashed>{"b", "a", "c"};
+        REQUIRE(g.insert_edge("a", "b", 1));
+        REQUIRE(g.replace_node("a", "z"));
+        REQUIRE_FALSE(g.is_node("a"));
+        REQUIRE(g.is_connected("z", "b"));
+        REQUIRE(g.nodes() == std::vector<std::string>{"b", "c", "z"});
+        g.clear();
+        REQUIRE_FALSE(g.is_node("b"));
+    }
+}
+
+TEST_CASE("edges_unordered visits every edge once") {
+    using graph_type = gdwg::graph<std::string, int>;
+    using range_type = decltype(std::declval<graph_type const&>().edges_unordered());
+    static_assert(std::ranges::forward_range<range_type>);
+    static_assert(std::ranges::view<range_type>);
+
+    auto g = graph_type{"d", "a", "c", "b", "e"};
+    g.insert_edge("d", "a", 1);
+    g.insert_edge("a", "b");
+    g.insert_edge("a", "b", 2);
+    g.insert_edge("c", "c", 3);
+    g.insert_edge("b", "d");
+    g.erase_node("e");
+    g.insert_node("f");
+
+    using edge_tuple = std::tuple<std::string, std::string, std::optional<int>>;
+    auto const from_iterator = [](auto const& range) {
+        auto result = std::vector<edge_tuple>();
+        for (auto const& [from, to, weight] : range) {
+            result.emplace_back(from, to, weight);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    REQUIRE(from_iterator(g.edges_unordered()) == from_iterator(g));
+    REQUIRE(std::ranges::distance(g.edges_unordered()) == 5);
+    REQUIRE(std::ranges::count_if(g.edges_unordered(), [](auto const& e) { return e.weight.has_value(); }) == 3);
+
+    SECTION("Empty graphs and graphs without edges") {
+        REQUIRE(graph_type{}.edges_unordered().empty());
+        REQUIRE(graph_type{"a", "b"}.edges_unordered().empty());
+        auto const unattached = range_type{};
+        REQUIRE(unattached.begin() == unattached.end());
+    }
+
+    SECTION("Unweighted graphs") {
+        auto u = gdwg::graph<int, int, gdwg::edge_policy::unweighted_only>{1, 2};
+        u.insert_edge(2, 1);
+        auto const first = *u.edges_unordered().begin();
+        REQUIRE(first.from == 2);
+        REQUIRE(first.to == 1);
+    }
+}
+
+TEST_CASE("Iterators compare by position") {
+    auto g = gdwg::graph<int, int>{1, 2, 3};
+    g.insert_edge(1, 2, 5);
+    g.insert_edge(1, 2, 6);
+    g.insert_edge(3, 1);
+
+    auto it = g.begin();
+    REQUIRE(it == g.find(1, 2, 5));
+    REQUIRE(it != g.find(1, 2, 6));
+    REQUIRE(std::next(it, 3) == g.end());
+    REQUIRE(std::prev(g.end()) == g.find(3, 1));
+
+    // Iterators of equal graphs are never equal to each other
+    auto const copy = g;
+    REQUIRE(copy.begin() != g.begin());
+    REQUIRE(copy.end() != g.end());
+    REQUIRE(gdwg::graph<int, int>::iterator() == gdwg::graph<int, int>::iterator());
+}
+
+TEST_CASE("Whole graph passes on several threads") {
+    auto g = gdwg::graph<int, int>{};
+    for (auto i = 0; i < 2000; ++i) {
+        g.insert_node(i);
+    }
+    for (auto i = 0; i < 2000; ++i) {
+        g.insert_edge(i, (i * 7) % 2000, i % 5);
+        g.insert_edge(i, (i * 7) % 2000);
+        g.insert_edge(0, i, i);
+    }
+    g.erase_node(1999);
+
+    SECTION("for_each_edge visits every edge once") {
+        auto sequential = 0L;
+        auto count = std::size_t{0};
+        g.for_each_edge([&](int const& src, int const& dst, std::optional<int> const& weight) {
+            sequential += src + dst + weight.value_or(100);
+            ++count;
+        });
+        auto expected = 0L;
+        auto expected_count = std::size_t{0};
+        for (auto const& [from, to, weight] : g) {
+            expected += from + to + weight.value_or(100);
+            ++expected_count;
+        }
+        REQUIRE(sequential == expected);
+        REQUIRE(count == expected_count);
+
+        for (auto const threads : {std::size_t{1}, std::size_t{4}, std::size_t{0}}) {
+            auto parallel = std::atomic<long>(0);
+            g.parallel_for_each_edge([&](int const& src, int const& dst, std::optional<int> const& weight) {
+                parallel.fetch_add(src + dst + weight.value_or(100), std::memory_order_relaxed);
+            }, threads);
+            REQUIRE(parallel.load() == expected);
+        }
+        REQUIRE_THROWS_WITH(g.parallel_for_each_edge([](int const& src, int const&, std::optional<int> const&) {
+            if (src == 1500) {
+                throw std::runtime_error("stop");
+            }
+        }, 4), "stop");
+    }
+
+    SECTION("transform_weights rewrites weights and merges the edges it makes equal") {
+        auto small = gdwg::graph<int, int>{1, 2};
+        small.insert_edge(1, 2, 1);
+        small.insert_edge(1, 2, 2);
+        small.insert_edge(1, 2, 3);
+        small.insert_edge(1, 2);
+        small.insert_edge(2, 1, 5);
+        auto const before = small;
+        small.transform_weights([](int w) { return w < 3 ? 0 : -w; });
+        auto expected = gdwg::graph<int, int>{1, 2};
+        expected.insert_edge(1, 2, 0);
+        expected.insert_edge(1, 2, -3);
+        expected.insert_edge(1, 2);
+        expected.insert_edge(2, 1, -5);
+        REQUIRE(small == expected);
+        REQUIRE(small.edges(1, 2).size() == 3);
+        REQUIRE(before.find(1, 2, 3) != before.end());
+
+        // Every list stays mirrored: erasing the node removes its incoming records too
+        small.erase_node(2);
+        REQUIRE(small.begin() == small.end());
+    }
+
+    SECTION("parallel_transform_weights matches transform_weights") {
+        auto sequential = g;
+        sequential.transform_weights([](int w) { return (w * 31) % 7; });
+        for (auto const threads : {std::size_t{1}, std::size_t{3}, std::size_t{0}}) {
+            auto parallel = g;
+            parallel.parallel_transform_weights([](int w) { return (w * 31) % 7; }, threads);
+            REQUIRE(parallel == sequential);
+        }
+
+        auto throwing = g;
+        REQUIRE_THROWS_WITH(throwing.parallel_transform_weights([](int w) {
+            if (w == 1234) {
+                throw std::runtime_error("bad weight");
+            }
+            return w + 1;
+        }, 4), "bad weight");
+        REQUIRE(throwing == g);
+    }
+
+    SECTION("weighted_only graphs") {
+        auto w = gdwg::graph<std::string, double, gdwg::edge_policy::weighted_only>{"a", "b"};
+        w.insert_edge("a", "b", 1.5);
+        w.insert_edge("b", "a", 2.5);
+        w.transform_weights([](double x) { return x * 2; });
+        REQUIRE(w.find("a", "b", 3.0) != w.end());
+        auto total = 0.0;
+        w.for_each_edge([&total](std::string const&, std::string const&, double const& weight) { total += weight; });
+        REQUIRE(total == 8.0);
+    }
+
+    SECTION("parallel_equal agrees with operator==") {
+        auto edges = std::vector<std::tuple<int, int, std::optional<int>>>();
+        g.for_each_edge([&edges](int const& src, int const& dst, std::optional<int> const& weight) {
+            edges.emplace_back(src, dst, weight);
+        });
+        auto copy = gdwg::graph<int, int>(g.nodes(), edges);
+        for (auto const threads : {std::size_t{1}, std::size_t{4}, std::size_t{0}}) {
+            REQUIRE(g.parallel_equal(copy, threads));
+            REQUIRE(g.parallel_equal(g, threads));
+        }
+        copy.erase_edge(1000, (1000 * 7) % 2000);
+        REQUIRE_FALSE(g.parallel_equal(copy, 4));
+        REQUIRE_FALSE(g == copy);
+        copy.insert_edge(1000, (1000 * 7) % 2000);
+        REQUIRE(g.parallel_equal(copy, 4));
+        copy.replace_node(1998, 5000);
+        REQUIRE_FALSE(g.parallel_equal(copy, 4));
+    }
+}
+
+namespace {
+    struct unhashable {
+        int value;
+        friend auto operator<=>(unhashable const&, unhashable const&) = default;
+    };
+
+    template<typename G>
+    concept has_fingerprint = requires(G const& g) { g.fingerprint(); };
+}
+
+TEST_CASE("Fingerprints follow every mutation") {
+    // Built in a different order from g, so ids and list layouts differ
+    auto const rebuilt = [](auto const& g) {
+        auto copy = std::remove_cvref_t<decltype(g)>();
+        auto nodes = g.nodes();
+        std::reverse(nodes.begin(), nodes.end());
+        for (auto const& node : nodes) {
+            copy.insert_node(node);
+        }
+        auto edges = std::vector<std::tuple<std::string, std::string, std::optional<int>>>();
+        g.for_each_edge([&edges](std::string const& src, std::string const& dst, std::optional<int> const& weight) {
+            edges.emplace_back(src, dst, weight);
+        });
+        for (auto it = edges.rbegin(); it != edges.rend(); ++it) {
+            copy.insert_edge(std::get<0>(*it), std::get<1>(*it), std::get<2>(*it));
+        }
+        return copy;
+    };
+
+    auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+    g.insert_edge("a", "b", 1);
+    g.insert_edge("a", "b");
+    g.insert_edge("b", "c", 2);
+    g.insert_edge("c", "a", 3);
+    g.insert_edge("d", "d", 4);
+    g.insert_edge("d", "a");
+    auto const original = g.fingerprint();
+    REQUIRE(gdwg::graph<std::string, int>().fingerprint() == 0);
+    REQUIRE(rebuilt(g).fingerprint() == original);
+
+    SECTION("every mutator keeps the fingerprint equal to a rebuilt graph's") {
+        auto const check = [&] {
+            REQUIRE(g.fingerprint() == rebuilt(g).fingerprint());
+            REQUIRE(g.fingerprint() != original);
+        };
+        g.insert_node("e");
+        check();
+        g.insert_edge("e", "a", 5);
+        check();
+        g.erase_edge("a", "b");
+        check();
+        g.replace_node("a", "z");
+        check();
+        g.merge_replace_node("b", "c");
+        check();
+        g.erase_node("d");
+        check();
+        g.insert_edges(std::vector<std::tuple<std::string, std::string, std::optional<int>>>{{"c", "e", 6}, {"e", "z", std::nullopt}});
+        check();
+        g.erase_nodes(std::vector<std::string>{"c", "q"});
+        check();
+        g.erase_edge(g.begin());
+        check();
+        g.transform_weights([](int w) { return w * 10; });
+        check();
+        g.clear();
+        REQUIRE(g.fingerprint() == 0);
+    }
+
+    SECTION("undoing a mutation restores the fingerprint") {
+        g.insert_edge("b", "a", 9);
+        g.erase_edge("b", "a", 9);
+        REQUIRE(g.fingerprint() == original);
+        g.replace_node("c", "x");
+        g.replace_node("x", "c");
+        REQUIRE(g.fingerprint() == original);
+        g.insert_node("e");
+        g.erase_node("e");
+        REQUIRE(g.fingerprint() == original);
+        auto const copy = g;
+        g.erase_node("d");
+        REQUIRE(copy.fingerprint() == original);
+    }
+
+    SECTION("weights and directions are part of the fingerprint") {
+        auto flipped = gdwg::graph<std::string, int>{"a", "b"};
+        auto forward = flipped;
+        forward.insert_edge("a", "b", 1);
+        flipped.insert_edge("b", "a", 1);
+        REQUIRE(forward.fingerprint() != flipped.fingerprint());
+        auto heavier = gdwg::graph<std::string, int>{"a", "b"};
+        heavier.insert_edge("a", "b", 2);
+        REQUIRE(forward.fingerprint() != heavier.fingerprint());
+        auto unweighted = gdwg::graph<std::string, int>{"a", "b"};
+        unweighted.insert_edge("a", "b");
+        REQUIRE(forward.fingerprint() != unweighted.fingerprint());
+    }
+
+    SECTION("sub-fingerprints narrow a difference down to a node") {
+        auto replica = rebuilt(g);
+        replica.insert_edge("c", "d", 7);
+        REQUIRE(replica.fingerprint() != g.fingerprint());
+        REQUIRE(g.node_fingerprint("a") + g.node_fingerprint("b") == g.fingerprint("a", "c"));
+        REQUIRE(g.fingerprint("a", "zz") == g.fingerprint());
+        REQUIRE(g.fingerprint("c", "a") == 0);
+
+        // Bisect the sorted node list for the one node whose sub-fingerprint differs
+        auto const nodes = g.nodes();
+        auto first = std::size_t{0};
+        auto last = nodes.size();
+        while (last - first > 1) {
+            auto const middle = first + (last - first) / 2;
+            if (g.fingerprint(nodes[first], nodes[middle]) != replica.fingerprint(nodes[first], nodes[middle])) {
+                last = middle;
+            } else {
+                first = middle;
+            }
+        }
+        REQUIRE(nodes[first] == "c");
+        REQUIRE(g.node_fingerprint("c") != replica.node_fingerprint("c"));
+        REQUIRE_THROWS_WITH(g.node_fingerprint("q"),
+                            "Cannot call gdwg::graph<N, E>::node_fingerprint if src doesn't exist in the graph");
+    }
+
+    SECTION("every policy fingerprints the same edges alike") {
+        auto hashed = gdwg::graph<std::string, int, gdwg::edge_policy::mixed, gdwg::index_policy::hashed>{"a", "b", "c", "d"};
+        g.for_each_edge([&hashed](std::string const& src, std::string const& dst, std::optional<int> const& weight) {
+            hashed.insert_edge(src, dst, weight);
+        });
+        REQUIRE(hashed.fingerprint() == original);
+
+        auto weighted = gdwg::graph<std::string, int, gdwg::edge_policy::weighted_only>{"a", "b"};
+        auto unweighted = gdwg::graph<std::string, int, gdwg::edge_policy::unweighted_only>{"a", "b"};
+        auto mixed = gdwg::graph<std::string, int>{"a", "b"};
+        weighted.insert_edge("a", "b", 3);
+        unweighted.insert_edge("b", "a");
+        mixed.insert_edge("a", "b", 3);
+        REQUIRE(weighted.fingerprint() == mixed.fingerprint());
+        mixed.erase_edge("a", "b", 3);
+        mixed.insert_edge("b", "a");
+        REQUIRE(unweighted.fingerprint() == mixed.fingerprint());
+    }
+
+    STATIC_REQUIRE(has_fingerprint<gdwg::graph<std::string, int>>);
+    STATIC_REQUIRE_FALSE(has_fingerprint<gdwg::graph<unhashable, int>>);
+    STATIC_REQUIRE_FALSE(has_fingerprint<gdwg::graph<int, unhashable>>);
+    STATIC_REQUIRE(has_fingerprint<gdwg::graph<int, unhashable, gdwg::edge_policy::unweighted_only>>);
+}
+
+TEST_CASE("Mutation logs replay onto replicas") {
+    using graph = gdwg::graph<int, int>;
+    auto g = graph{};
+    for (auto i = 0; i < 32; ++i) {
+        g.insert_node(i);
+    }
+    g.insert_edge(0, 1, 5);
+    auto replica = g;
+    REQUIRE(g.pending_mutations() == 0);
+    REQUIRE(g.drain_mutations().empty());
+    g.record_mutations(64);
+
+    SECTION("events name the mutator and its arguments") {
+        g.insert_node(40);
+        g.insert_node(40);
+        g.insert_edge(40, 1, 2);
+        g.insert_edge(40, 1, 2);
+        g.erase_edge(40, 1, 3);
+        g.replace_node(40, 41);
+        g.merge_replace_node(41, 1);
+        g.erase_node(1);
+        g.clear();
+        REQUIRE(g.pending_mutations() == 6);
+        auto const events = g.drain_mutations();
+        REQUIRE(events.size() == 6);
+        REQUIRE(std::get<graph::node_inserted>(events[0]).value == 40);
+        auto const& edge = std::get<graph::edge_inserted>(events[1]);
+        REQUIRE(std::tuple(edge.from, edge.to, edge.weight) == std::tuple(40, 1, std::optional<int>(2)));
+        REQUIRE(std::get<graph::node_replaced>(events[2]).new_value == 41);
+        REQUIRE(std::get<graph::node_merged>(events[3]).old_value == 41);
+        REQUIRE(std::get<graph::node_erased>(events[4]).value == 1);
+        REQUIRE(std::holds_alternative<graph::cleared>(events[5]));
+        REQUIRE(g.pending_mutations() == 0);
+    }
+
+    SECTION("draining in batches keeps a replica equal to the graph") {
+        auto rng = std::mt19937(7);
+        auto pick = std::uniform_int_distribution<int>(0, 39);
+        for (auto round = 0; round < 200; ++round) {
+            for (auto i = 0; i < 10; ++i) {
+                auto const a = pick(rng);
+                auto const b = pick(rng);
+                auto const weight = a % 3 == 0 ? std::nullopt : std::optional<int>(b % 4);
+                switch ((a + b) % 9) {
+                case 0: g.insert_node(a); break;
+                case 1: g.erase_node(a); break;
+                case 2:
+                    if (g.is_node(a)) {
+                        g.replace_node(a, b);
+                    }
+                    break;
+                case 3:
+                    if (g.is_node(a) and g.is_node(b)) {
+                        g.merge_replace_node(a, b);
+                    }
+                    break;
+                case 4:
+                    if (g.begin() != g.end()) {
+                        g.erase_edge(g.begin());
+                    }
+                    break;
+                case 5:
+                    if (g.is_node(a) and g.is_node(b)) {
+                        g.erase_edge(a, b, weight);
+                    }
+                    break;
+                default:
+                    if (g.is_node(a) and g.is_node(b)) {
+                        g.insert_edge(a, b, weight);
+                    }
+                    break;
+                }
+            }
+            if (round % 50 == 0) {
+                g.insert_node(0);
+                g.insert_node(2);
+                g.insert_node(3);
+                g.insert_edges(std::vector<std::tuple<int, int, std::optional<int>>>{{0, 0, 1}, {2, 3, std::nullopt}});
+                g.erase_nodes(std::vector<int>{5, 6});
+            }
+            for (auto batch = g.drain_mutations(7); !batch.empty(); batch = g.drain_mutations(7)) {
+                for (auto const& event : batch) {
+                    replica.apply(event);
+                }
+            }
+            REQUIRE(replica == g);
+            REQUIRE(replica.fingerprint() == g.fingerprint());
+        }
+    }
+
+    SECTION("a full log collapses into a reset until it is drained") {
+        g.record_mutations(3);
+        for (auto i = 100; i < 110; ++i) {
+            g.insert_node(i);
+        }
+        REQUIRE(g.pending_mutations() == 1);
+        auto events = g.drain_mutations();
+        REQUIRE(events.size() == 1);
+        REQUIRE(std::holds_alternative<graph::reset>(events[0]));
+        REQUIRE_THROWS_WITH(replica.apply(events[0]), "Cannot call gdwg::graph<N, E>::apply on a reset mutation");
+
+        // Recording resumes, and wraps around the ring
+        for (auto round = 0; round < 5; ++round) {
+            g.insert_node(200 + round);
+            g.insert_node(300 + round);
+            events = g.drain_mutations(1);
+            REQUIRE(std::get<graph::node_inserted>(events[0]).value == 200 + round);
+            events = g.drain_mutations();
+            REQUIRE(std::get<graph::node_inserted>(events[0]).value == 300 + round);
+        }
+    }
+
+    SECTION("whole-graph changes record resets, and logs stay with their graph") {
+        g.transform_weights([](int w) { return w + 1; });
+        auto const copy = g;
+        g = replica;
+        REQUIRE(g.drain_mutations().size() == 2);
+        REQUIRE(copy.pending_mutations() == 0);
+
+        auto moved = std::move(g);
+        moved.insert_node(50);
+        REQUIRE(moved.pending_mutations() == 0);
+        auto const events = g.drain_mutations();
+        REQUIRE(events.size() == 1);
+        REQUIRE(std::holds_alternative<graph::cleared>(events[0]));
+
+        g.stop_recording_mutations();
+        g.insert_node(1);
+        REQUIRE(g.pending_mutations() == 0);
+    }
+}
+
+TEST_CASE("Degree and edge counts track every mutator") {
+    auto g = gdwg::graph<int, int>{};
+    // Recounts everything by iterating, to compare with the maintained counts
+    auto const check = [&g] {
+        auto edges = std::size_t{0};
+        for (auto it = g.begin(); it != g.end(); ++it) {
+            ++edges;
+        }
+        REQUIRE(g.num_edges() == edges);
+        REQUIRE(g.num_nodes() == g.nodes().size());
+        auto total_in = std::size_t{0};
+        for (auto const& node : g.nodes()) {
+            auto const connections = g.connections(node);
+            auto const view = g.connections_view(node);
+            REQUIRE(g.distinct_out_neighbours(node) == connections.size());
+            REQUIRE(std::ranges::size(view) == connections.size());
+            REQUIRE(std::ranges::equal(view, connections));
+            auto out = std::size_t{0};
+            for (auto const& dst : connections) {
+                out += g.edges(node, dst).size();
+            }
+            REQUIRE(g.out_degree(node) == out);
+            total_in += g.in_degree(node);
+        }
+        REQUIRE(total_in == edges);
+    };
+    check();
+
+    for (auto i = 0; i < 24; ++i) {
+        g.insert_node(i);
+    }
+    auto rng = std::mt19937(11);
+    auto pick = std::uniform_int_distribution<int>(0, 27);
+    for (auto step = 0; step < 600; ++step) {
+        auto const a = pick(rng);
+        auto const b = pick(rng);
+        auto const weight = b % 3 == 0 ? std::nullopt : std::optional<int>(a % 3);
+        switch (step % 11) {
+        case 0: g.insert_node(a); break;
+        case 1: g.erase_node(a); break;
+        case 2:
+            if (g.is_node(a)) {
+                g.merge_replace_node(a, g.is_node(b) ? b : a);
+            }
+            break;
+        case 3:
+            if (g.is_node(a)) {
+                g.replace_node(a, b);
+            }
+            break;
+        case 4:
+            if (g.is_node(a) and g.is_node(b)) {
+                g.erase_edge(a, b, weight);
+            }
+            break;
+        case 5:
+            if (g.begin() != g.end()) {
+                g.erase_edge(g.begin());
+            }
+            break;
+        case 6:
+            g.erase_nodes(std::vector<int>{a, b});
+            break;
+        case 7: {
+            auto batch = std::vector<std::tuple<int, int, std::optional<int>>>();
+            for (auto const& src : g.nodes()) {
+                batch.emplace_back(src, g.nodes().front(), weight);
+                batch.emplace_back(src, g.nodes().back(), std::nullopt);
+            }
+            g.insert_edges(batch);
+            break;
+        }
+        default:
+            if (g.is_node(a) and g.is_node(b)) {
+                g.insert_edge(a, b, weight);
+            }
+            break;
+        }
+        if (step % 20 == 0) {
+            check();
+        }
+    }
+    check();
+
+    SECTION("copies keep their own counts") {
+        auto copy = g;
+        auto const edges = g.num_edges();
+        copy.insert_node(100);
+        copy.insert_edge(100, 100, 1);
+        REQUIRE(copy.num_edges() == edges + 1);
+        REQUIRE(g.num_edges() == edges);
+        copy.clear();
+        REQUIRE(copy.num_edges() == 0);
+        REQUIRE(copy.num_nodes() == 0);
+    }
+
+    SECTION("transform_weights drops merged edges from the count") {
+        g.transform_weights([](int) { return 0; });
+        check();
+    }
+
+    SECTION("missing nodes throw") {
+        REQUIRE_THROWS_WITH(g.out_degree(-1), "Cannot call gdwg::graph<N, E>::out_degree if src doesn't exist in the graph");
+        REQUIRE_THROWS_WITH(g.in_degree(-1), "Cannot call gdwg::graph<N, E>::in_degree if dst doesn't exist in the graph");
+        REQUIRE_THROWS_WITH(g.distinct_out_neighbours(-1),
+                            "Cannot call gdwg::graph<N, E>::distinct_out_neighbours if src doesn't exist in the graph");
+        REQUIRE_THROWS_WITH(g.connections_view(-1),
+                            "Cannot call gdwg::graph<N, E>::connections_view if src doesn't exist in the graph");
+    }
+
+    SECTION("connections_view refers to the stored values") {
+        auto strings = gdwg::graph<std::string, int, gdwg::edge_policy::unweighted_only, gdwg::index_policy::hashed>{"a", "b", "c"};
+        strings.insert_edge("a", "c");
+        strings.insert_edge("a", "b");
+        strings.insert_edge("a", "a");
+        auto const view = strings.connections_view("a");
+        STATIC_REQUIRE(std::ranges::forward_range<decltype(view)>);
+        STATIC_REQUIRE(std::ranges::sized_range<decltype(view)>);
+        STATIC_REQUIRE(std::same_as<std::ranges::range_reference_t<decltype(view)>, std::string const&>);
+        REQUIRE(std::ranges::equal(view, std::vector<std::string>{"a", "b", "c"}));
+        REQUIRE(&*view.begin() == &*strings.connections_view("a").begin());
+        REQUIRE(view.begin()->size() == 1);
+        REQUIRE(strings.connections_view("b").empty());
+        REQUIRE(strings.num_edges() == 3);
+        REQUIRE(strings.in_degree("a") == 1);
+    }
+}
+
+TEST_CASE("stats counts the work of each operation") {
+    STATIC_REQUIRE(gdwg::instrumented);
+    using op = gdwg::graph_operation;
+    auto g = gdwg::graph<std::string, int>{};
+    auto const calls = [&g](op operation) { return g.stats()[operation].calls; };
+    REQUIRE(g.stats().index_probes == 0);
+    REQUIRE(calls(op::insert_node) == 0);
+
+    for (auto const* node : {"a", "b", "c", "d"}) {
+        g.insert_node(node);
+    }
+    g.insert_edge("a", "b", 1);
+    g.insert_edge("a", "c", 2);
+    g.insert_edge("a", "b");
+    auto const built = g.stats();
+    REQUIRE(built[op::insert_node].calls == 4);
+    REQUIRE(built[op::insert_edge].calls == 3);
+    REQUIRE(built.index_probes >= 10);
+    REQUIRE(built.comparisons > 0);
+    REQUIRE(built.allocations > 0);
+    for (auto const& latency : built.operations) {
+        auto bucketed = std::uint64_t{0};
+        for (auto const count : latency.buckets) {
+            bucketed += count;
+        }
+        REQUIRE(bucketed == latency.calls);
+    }
+
+    SECTION("members called by other members are not timed again") {
+        REQUIRE(g.is_connected("a", "b"));
+        REQUIRE(calls(op::is_connected) == 1);
+        REQUIRE(calls(op::is_node) == 0);
+        g.erase_edge(g.begin(), g.end());
+        REQUIRE(calls(op::erase_edge) == 1);
+        REQUIRE(g.stats().scanned_records > built.scanned_records);
+    }
+
+    SECTION("copies count on their own and reset_stats starts over") {
+        auto copy = g;
+        REQUIRE(copy.stats()[op::insert_edge].calls == 0);
+        auto const allocations = copy.stats().allocations;
+        copy.insert_edge("d", "a", 4);
+        REQUIRE(copy.stats().allocations > allocations);
+        REQUIRE(calls(op::insert_edge) == 3);
+        g.reset_stats();
+        REQUIRE(calls(op::insert_edge) == 0);
+        REQUIRE(g.stats().index_probes == 0);
+    }
+
+    SECTION("stats are written as name value lines") {
+        auto out = std::ostringstream();
+        out << g.stats();
+        auto const text = out.str();
+        REQUIRE(text.find("index_probes " + std::to_string(built.index_probes) + "\n") == 0);
+        REQUIRE(text.find("insert_edge.calls 3\n") != std::string::npos);
+        REQUIRE(text.find("erase_node.calls") == std::string::npos);
+        REQUIRE(gdwg::operation_name(op::merge_replace_node) == "merge_replace_node");
+    }
+
+    SECTION("concurrent readers all count") {
+        auto threads = std::vector<std::thread>();
+        for (auto t = 0; t < 4; ++t) {
+            threads.emplace_back([&g] {
+                for (auto i = 0; i < 100; ++i) {
+                    static_cast<void>(g.is_connected("a", "c"));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(calls(op::is_connected) == 400);
+    }
+}
+
+TEST_CASE("Batched queries agree with one call per probe") {
+    auto g = gdwg::graph<int, int>{};
+    for (auto i = 0; i < 40; ++i) {
+        g.insert_node(i);
+    }
+    auto rng = std::mt19937(5);
+    auto pick = std::uniform_int_distribution<int>(0, 39);
+    for (auto i = 0; i < 400; ++i) {
+        auto const src = pick(rng) % 8;
+        auto const dst = pick(rng);
+        if (dst % 4 == 0) {
+            g.insert_edge(src, dst);
+        } else {
+            g.insert_edge(src, dst, dst % 3);
+        }
+    }
+
+    SECTION("is_connected answers each dst in the order given") {
+        for (auto src = 0; src < 10; ++src) {
+            auto dsts = std::vector<int>();
+            for (auto i = 0; i < 30; ++i) {
+                dsts.push_back(pick(rng));
+            }
+            dsts.push_back(dsts.front());
+            auto const connected = g.is_connected(src, dsts);
+            REQUIRE(connected.size() == dsts.size());
+            for (auto i = std::size_t{0}; i < dsts.size(); ++i) {
+                REQUIRE(connected[i] == g.is_connected(src, dsts[i]));
+            }
+            std::ranges::sort(dsts);
+            auto const sorted = g.is_connected(src, dsts);
+            for (auto i = std::size_t{0}; i < dsts.size(); ++i) {
+                REQUIRE(sorted[i] == g.is_connected(src, dsts[i]));
+            }
+        }
+        REQUIRE(g.is_connected(0, std::vector<int>{}).empty());
+    }
+
+    SECTION("find_many returns the iterator find does, or end") {
+        using probe = std::tuple<int, int, std::optional<int>>;
+        auto probes = std::vector<probe>();
+        for (auto i = 0; i < 300; ++i) {
+            auto const dst = pick(rng);
+            probes.emplace_back(pick(rng) % 10, dst, dst % 4 == 0 ? std::nullopt : std::optional<int>(pick(rng) % 3));
+        }
+        probes.emplace_back(-1, 0, 1);
+        probes.emplace_back(0, -1, std::nullopt);
+        auto const found = g.find_many(probes);
+        REQUIRE(found.size() == probes.size());
+        auto hits = 0;
+        for (auto i = std::size_t{0}; i < probes.size(); ++i) {
+            auto const& [src, dst, weight] = probes[i];
+            REQUIRE(found[i] == g.find(src, dst, weight));
+            if (found[i] != g.end()) {
+                ++hits;
+                REQUIRE((*found[i]).from == src);
+                REQUIRE((*found[i]).to == dst);
+            }
+        }
+        REQUIRE(hits > 0);
+        REQUIRE(g.find_many(std::vector<probe>{}).empty());
+    }
+
+    SECTION("missing nodes") {
+        REQUIRE_THROWS_WITH(g.is_connected(-1, std::vector<int>{}),
+                            "Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the graph");
+        REQUIRE_THROWS_WITH(g.is_connected(0, std::vector<int>{1, -1}),
+                            "Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist in the graph");
+    }
+
+    SECTION("other policies") {
+        auto strings = gdwg::graph<std::string, int, gdwg::edge_policy::unweighted_only, gdwg::index_policy::hashed>{"a", "b", "c"};
+        strings.insert_edge("a", "c");
+        strings.insert_edge("b", "a");
+        REQUIRE(strings.is_connected("a", std::vector<std::string>{"c", "a", "b", "c"}) == std::vector<bool>{true, false, false, true});
+        auto const found = strings.find_many(std::vector<std::pair<std::string, std::string>>{{"b", "a"}, {"a", "b"}, {"a", "c"}});
+        REQUIRE(found[0] == strings.find("b", "a"));
+        REQUIRE(found[1] == strings.end());
+        REQUIRE(found[2] == strings.find("a", "c"));
+        // Probes that are not stored as node values are copied first
+        auto const converted = strings.find_many(std::vector<std::pair<char const*, char const*>>{{"a", "c"}, {"c", "a"}});
+        REQUIRE(converted[0] == strings.find("a", "c"));
+        REQUIRE(converted[1] == strings.end());
+    }
+}
+
+namespace {
+    // Counts its copies, so tests can check that insertion moves values all the way into storage
+    struct counted {
+        inline static auto copies = 0;
+        std::string value;
+
+        explicit counted(std::string v) : value(std::move(v)) {}
+        counted(counted const& other) : value(other.value) {
+            ++copies;
+        }
+        counted(counted&&) noexcept = default;
+        auto operator=(counted const& other) -> counted& {
+            value = other.value;
+            ++copies;
+            return *this;
+        }
+        auto operator=(counted&&) noexcept -> counted& = default;
+        ~counted() = default;
+
+        friend auto operator<=>(counted const& a, counted const& b) = default;
+        friend auto operator<<(std::ostream& os, counted const& c) -> std::ostream& {
+            return os << c.value;
+        }
+    };
+}
+
+TEST_CASE("Insertion moves nodes and weights into storage") {
+    auto g = gdwg::graph<counted, counted>{};
+    counted::copies = 0;
+    REQUIRE(g.insert_node(counted("a")));
+    REQUIRE(g.emplace_node("b"));
+    auto c = counted("c");
+    REQUIRE(g.insert_node(std::move(c)));
+    REQUIRE(counted::copies == 0);
+    REQUIRE(g.nodes().size() == 3);
+    counted::copies = 0;
+
+    SECTION("duplicates are not moved from") {
+        auto a = counted("a");
+        REQUIRE_FALSE(g.insert_node(std::move(a)));
+        REQUIRE(a.value == "a");
+        REQUIRE_FALSE(g.emplace_node("b"));
+        REQUIRE(counted::copies == 0);
+    }
+
+    SECTION("a moved weight is copied once, into the mirror record") {
+        REQUIRE(g.insert_edge(counted("a"), counted("b"), counted("w")));
+        REQUIRE(counted::copies == 1);
+        REQUIRE(g.insert_edge(counted("a"), counted("b")));
+        REQUIRE_FALSE(g.insert_edge(counted("a"), counted("b"), counted("w")));
+        REQUIRE(counted::copies == 1);
+        REQUIRE(g.find(counted("a"), counted("b"), counted("w")) != g.end());
+    }
+
+    SECTION("edges copies each value once") {
+        g.insert_edge(counted("a"), counted("b"), counted("w"));
+        counted::copies = 0;
+        auto const edges = g.edges(counted("a"), counted("b"));
+        REQUIRE(counted::copies == 3);
+        REQUIRE(edges.front()->print_edge() == "a -> b | W | w");
+    }
+
+    SECTION("the range constructor moves from move iterators") {
+        auto values = std::vector<counted>();
+        values.emplace_back("x");
+        values.emplace_back("y");
+        auto const moved = gdwg::graph<counted, counted>(std::make_move_iterator(values.begin()),
+                                                         std::make_move_iterator(values.end()));
+        REQUIRE(counted::copies == 0);
+        REQUIRE(moved.is_node(counted("x")));
+        REQUIRE(moved.is_node(counted("y")));
+    }
+
+    SECTION("values convertible to N are converted once") {
+        auto strings = gdwg::graph<std::string, int>{};
+        REQUIRE(strings.emplace_node(std::size_t{3}, 'z'));
+        REQUIRE(strings.is_node("zzz"));
+        auto const names = std::vector<char const*>{"p", "q", "p"};
+        auto const converted = gdwg::graph<std::string, int>(names.begin(), names.end());
+        REQUIRE(converted.nodes() == std::vector<std::string>{"p", "q"});
+    }
+}
+
+TEST_CASE("subgraph_view is the induced subgraph without copying") {
+    auto g = gdwg::graph<int, int>{};
+    for (auto i = 0; i < 30; ++i) {
+        g.insert_node(i);
+    }
+    auto rng = std::mt19937(17);
+    auto pick = std::uniform_int_distribution<int>(0, 29);
+    for (auto i = 0; i < 200; ++i) {
+        auto const src = pick(rng);
+        auto const dst = pick(rng);
+        if (dst % 5 == 0) {
+            g.insert_edge(src, dst);
+        } else {
+            g.insert_edge(src, dst, dst % 3);
+        }
+    }
+    // Erased and reused ids leave the slot table out of order
+    g.erase_node(4);
+    g.erase_node(11);
+    g.insert_node(42);
+    g.insert_edge(42, 2, 7);
+    g.insert_edge(2, 42);
+
+    auto const member = [](int n) { return n % 3 != 1; };
+    auto expected = gdwg::graph<int, int>{};
+    for (auto const& node : g.nodes()) {
+        if (member(node)) {
+            expected.insert_node(node);
+        }
+    }
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        auto const& [from, to, weight] = *it;
+        if (member(from) and member(to)) {
+            expected.insert_edge(from, to, weight);
+        }
+    }
+
+    auto const view = g.subgraph(member);
+    STATIC_REQUIRE(std::ranges::forward_range<decltype(view)>);
+
+    SECTION("the view reads like the induced graph") {
+        REQUIRE(view.nodes() == expected.nodes());
+        REQUIRE(view.num_nodes() == expected.num_nodes());
+        REQUIRE_FALSE(view.empty());
+        auto it = view.begin();
+        for (auto e = expected.begin(); e != expected.end(); ++e, ++it) {
+            REQUIRE(it != view.end());
+            REQUIRE((*it).from == (*e).from);
+            REQUIRE((*it).to == (*e).to);
+            REQUIRE((*it).weight == (*e).weight);
+        }
+        REQUIRE(it == view.end());
+        for (auto src = 0; src < 43; ++src) {
+            REQUIRE(view.is_node(src) == expected.is_node(src));
+            if (!expected.is_node(src)) {
+                continue;
+            }
+            REQUIRE(view.connections(src) == expected.connections(src));
+            for (auto const& dst : expected.nodes()) {
+                REQUIRE(view.is_connected(src, dst) == expected.is_connected(src, dst));
+                for (auto const weight : {std::optional<int>(), std::optional<int>(1), std::optional<int>(2)}) {
+                    REQUIRE((view.find(src, dst, weight) == view.end()) == (expected.find(src, dst, weight) == expected.end()));
+                }
+            }
+        }
+        auto const found = view.find(42, 2, 7);
+        REQUIRE(found != view.end());
+        REQUIRE((*found).from == 42);
+        REQUIRE(std::next(found) == std::ranges::next(view.begin(), std::ranges::distance(view.begin(), found) + 1));
+        REQUIRE(view.find(0, 4) == view.end());
+    }
+
+    SECTION("materialize builds an equal graph") {
+        auto const built = view.materialize();
+        REQUIRE(built == expected);
+        REQUIRE(built.num_edges() == expected.num_edges());
+        REQUIRE(built.fingerprint() == expected.fingerprint());
+        for (auto const& node : built.nodes()) {
+            REQUIRE(built.out_degree(node) == expected.out_degree(node));
+            REQUIRE(built.in_degree(node) == expected.in_degree(node));
+        }
+        auto arena = std::pmr::monotonic_buffer_resource();
+        REQUIRE(view.materialize(&arena) == expected);
+    }
+
+    SECTION("mutating the graph does not change the view") {
+        g.erase_node(0);
+        g.insert_edge(2, 3, 9);
+        g.clear();
+        REQUIRE(view.nodes() == expected.nodes());
+        REQUIRE(view.materialize() == expected);
+    }
+
+    SECTION("a node list selects the same subgraph") {
+        auto nodes = expected.nodes();
+        nodes.push_back(-5);
+        REQUIRE(g.subgraph(nodes).materialize() == expected);
+        auto const none = g.subgraph(std::vector<int>{});
+        REQUIRE(none.empty());
+        REQUIRE(none.begin() == none.end());
+    }
+
+    SECTION("missing nodes") {
+        REQUIRE_THROWS_WITH(view.connections(1),
+                            "Cannot call gdwg::subgraph_view<N, E>::connections if src doesn't exist in the subgraph");
+        REQUIRE_THROWS_WITH(view.is_connected(0, 1),
+                            "Cannot call gdwg::subgraph_view<N, E>::is_connected if src or dst node don't exist in the subgraph");
+    }
+
+    SECTION("other policies") {
+        auto strings = gdwg::graph<std::string, int, gdwg::edge_policy::unweighted_only, gdwg::index_policy::hashed>{"a", "b", "c"};
+        strings.insert_edge("a", "b");
+        strings.insert_edge("b", "c");
+        strings.insert_edge("c", "a");
+        auto const pair = strings.subgraph([](std::string const& s) { return s != "c"; });
+        REQUIRE(pair.nodes() == std::vector<std::string>{"a", "b"});
+        REQUIRE(pair.connections("b").empty());
+        REQUIRE(pair.find("a", "b") != pair.end());
+        auto const built = pair.materialize();
+        REQUIRE(built.nodes() == std::vector<std::string>{"a", "b"});
+        REQUIRE(built.num_edges() == 1);
+        REQUIRE(built.is_connected("a", "b"));
+    }
+}
+
+TEST_CASE("A deferred incoming index is rebuilt on demand") {
+    using graph = gdwg::graph<int, int>;
+    auto rng = std::mt19937(3030);
+    auto pick = std::uniform_int_distribution<int>(0, 39);
+    auto eager = graph();
+    for (auto i = 0; i < 40; ++i) {
+        eager.insert_node(i);
+    }
+    for (auto i = 0; i < 200; ++i) {
+        eager.insert_edge(pick(rng), pick(rng), i % 4 == 0 ? std::nullopt : std::optional<int>(i % 5));
+    }
+
+    auto const in_edges_by_scan = [](graph const& g, int dst) {
+        auto expected = std::vector<graph::iterator::value_type>();
+        for (auto const& [from, to, weight] : g) {
+            if (to == dst) {
+                expected.push_back({from, to, weight});
+            }
+        }
+        return expected;
+    };
+    auto const equal_edges = [](std::vector<graph::iterator::value_type> const& a, std::vector<graph::iterator::value_type> const& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](auto const& x, auto const& y) {
+            return x.from == y.from and x.to == y.to and x.weight == y.weight;
+        });
+    };
+
+    auto deferred = eager;
+    deferred.defer_incoming_index();
+    REQUIRE_FALSE(deferred.has_incoming_index());
+    REQUIRE(eager.has_incoming_index());
+    REQUIRE(deferred == eager);
+    REQUIRE(deferred.fingerprint() == eager.fingerprint());
+
+    SECTION("edge mutations leave the index deferred") {
+        for (auto i = 0; i < 300; ++i) {
+            auto const src = pick(rng);
+            auto const dst = pick(rng);
+            auto const weight = i % 3 == 0 ? std::nullopt : std::optional<int>(i % 5);
+            if (i % 3 == 1) {
+                REQUIRE(deferred.erase_edge(src, dst, weight) == eager.erase_edge(src, dst, weight));
+            } else {
+                REQUIRE(deferred.insert_edge(src, dst, weight) == eager.insert_edge(src, dst, weight));
+            }
+        }
+        auto batch = std::vector<std::tuple<int, int, std::optional<int>>>();
+        for (auto i = 0; i < 100; ++i) {
+            batch.emplace_back(pick(rng), pick(rng), i % 7);
+        }
+        REQUIRE(deferred.insert_edges(batch) == eager.insert_edges(batch));
+        REQUIRE_FALSE(deferred.has_incoming_index());
+        REQUIRE(deferred == eager);
+        REQUIRE(deferred.fingerprint() == eager.fingerprint());
+        REQUIRE(deferred.num_edges() == eager.num_edges());
+
+        // The const queries scan the outgoing lists instead
+        auto const& view = deferred;
+        for (auto const node : eager.nodes()) {
+            REQUIRE(view.in_degree(node) == eager.in_degree(node));
+            REQUIRE(equal_edges(view.in_edges(node), in_edges_by_scan(eager, node)));
+        }
+        REQUIRE_FALSE(deferred.has_incoming_index());
+    }
+
+    SECTION("node mutations rebuild it first") {
+        // Rebuilding on a copy leaves the storage it shared deferred
+        auto copy = deferred;
+        REQUIRE(copy.erase_node(3));
+        REQUIRE(copy.has_incoming_index());
+        REQUIRE_FALSE(deferred.has_incoming_index());
+        REQUIRE(deferred == eager);
+
+        deferred.merge_replace_node(4, 5);
+        eager.merge_replace_node(4, 5);
+        REQUIRE(deferred.has_incoming_index());
+        REQUIRE(deferred == eager);
+
+        REQUIRE(deferred.replace_node(6, 100));
+        REQUIRE(eager.replace_node(6, 100));
+        REQUIRE(deferred.erase_nodes(std::vector<int>{7, 8, 9}) == eager.erase_nodes(std::vector<int>{7, 8, 9}));
+        REQUIRE(deferred == eager);
+        REQUIRE(deferred.fingerprint() == eager.fingerprint());
+        for (auto const node : eager.nodes()) {
+            REQUIRE(deferred.in_degree(node) == eager.in_degree(node));
+            REQUIRE(equal_edges(deferred.in_edges(node), in_edges_by_scan(eager, node)));
+        }
+    }
+
+    SECTION("the non-const in_edges rebuilds it") {
+        REQUIRE(equal_edges(deferred.in_edges(0), in_edges_by_scan(eager, 0)));
+        REQUIRE(deferred.has_incoming_index());
+        REQUIRE(equal_edges(deferred.in_edges(0), eager.in_edges(0)));
+        // The rebuilt lists are maintained from then on
+        deferred.insert_edge(1, 0, 42);
+        eager.insert_edge(1, 0, 42);
+        deferred.erase_edge(1, 0, 42);
+        eager.erase_edge(1, 0, 42);
+        deferred.erase_node(1);
+        eager.erase_node(1);
+        REQUIRE(deferred == eager);
+        for (auto const node : eager.nodes()) {
+            REQUIRE(equal_edges(deferred.in_edges(node), eager.in_edges(node)));
+        }
+        REQUIRE_THROWS_WITH(deferred.in_edges(99), "Cannot call gdwg::graph<N, E>::in_edges if dst doesn't exist in the graph");
+    }
+
+    SECTION("clear and copies") {
+        auto arena = std::pmr::monotonic_buffer_resource();
+        auto const moved = graph(deferred, &arena);
+        REQUIRE_FALSE(moved.has_incoming_index());
+        REQUIRE(moved == eager);
+        deferred.clear();
+        REQUIRE(deferred.has_incoming_index());
+        REQUIRE(deferred.empty());
+    }
+}
+
 TEST_CASE("basic test") {
 	// These are commented out right now
 	//  because withour your implementation
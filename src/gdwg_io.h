@@ -0,0 +1,1024 @@
+#ifndef GDWG_IO_H
+#define GDWG_IO_H
+#include "gdwg_graph.h"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <stop_token>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gdwg {
+	// Node and weight types the binary format can store: trivially copyable types are written as raw
+	// bytes, std::string nodes as a table of offsets followed by their characters.
+	template<typename T>
+	concept binary_value = std::is_trivially_copyable_v<T>;
+
+	template<typename N>
+	concept binary_node = binary_value<N> or std::same_as<N, std::string>;
+
+	/**
+	* A read-only, memory-mapped view of a file written by gdwg::save.
+	*/
+	class file_mapping {
+	public:
+		file_mapping() noexcept = default;
+
+		// Throws: std::runtime_error("Cannot call gdwg::<caller> on a path that cannot be read") if path cannot be mapped.
+		// An empty file maps to no bytes, for the caller to reject.
+		file_mapping(std::filesystem::path const& path, char const* caller) {
+			const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				throw std::runtime_error(std::string("Cannot call gdwg::") + caller + " on a path that cannot be read");
+			}
+			struct stat info {};
+			if (::fstat(fd, &info) != 0) {
+				::close(fd);
+				throw std::runtime_error(std::string("Cannot call gdwg::") + caller + " on a path that cannot be read");
+			}
+			size_ = static_cast<std::size_t>(info.st_size);
+			if (size_ == 0) {
+				::close(fd);
+				return;
+			}
+			auto* const address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if (address == MAP_FAILED) {
+				size_ = 0;
+				throw std::runtime_error(std::string("Cannot call gdwg::") + caller + " on a path that cannot be read");
+			}
+			data_ = static_cast<std::byte const*>(address);
+		}
+
+		file_mapping(file_mapping&& other) noexcept
+		: data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+		auto operator=(file_mapping&& other) noexcept -> file_mapping& {
+			std::swap(data_, other.data_);
+			std::swap(size_, other.size_);
+			return *this;
+		}
+
+		file_mapping(file_mapping const&) = delete;
+		auto operator=(file_mapping const&) -> file_mapping& = delete;
+
+		~file_mapping() {
+			if (data_ != nullptr) {
+				::munmap(const_cast<std::byte*>(data_), size_);
+			}
+		}
+
+		[[nodiscard]] auto bytes() const noexcept -> std::span<std::byte const> {
+			return {data_, size_};
+		}
+
+	private:
+		std::byte const* data_ = nullptr;
+		std::size_t size_ = 0;
+	};
+
+	/**
+	* The binary graph format, and conversions between it and graph.
+	*
+	* A file is a 64 byte header followed by five sections, each starting on a 64 byte boundary:
+	* the nodes in ascending order, the CSR row offsets (num_nodes + 1 std::uint64_t), the position of
+	* every edge's dst in the node table (std::uint32_t), a weighted flag per edge (std::uint8_t), and
+	* a weight per edge (E, zero bytes for unweighted edges). Rows follow graph's iteration order, so
+	* loading never sorts and every array can be used in place once the file is mapped.
+	* Values are stored in native byte order, which the header records, and the header tags the node and
+	* weight types with their kind (integral, floating point, string or other) and signedness next to their
+	* sizes, so that a file only loads as the types it was saved from, or types that store alike.
+	* Use the free functions below rather than this class directly.
+	*/
+	template<typename N, typename E>
+	class graph_io {
+		using graph_type = graph<N, E>;
+		using node_id = typename graph_type::node_id;
+		using adjacency = typename graph_type::adjacency;
+		using node_slot = typename graph_type::node_slot;
+
+		static constexpr std::size_t alignment = 64;
+		static constexpr std::uint32_t byte_order = 0x01020304;
+		static constexpr std::uint32_t version = 2;
+		static constexpr std::array<char, 8> magic = {'G', 'D', 'W', 'G', 'R', 'A', 'P', 'H'};
+		// How the node section is encoded
+		static constexpr std::uint32_t raw_nodes = 0;
+		static constexpr std::uint32_t string_nodes = 1;
+
+		// Tags a stored type by its kind and signedness, since its size alone does not tell int from float.
+		// Other trivially copyable types all share the tag 0.
+		static constexpr std::uint32_t integral_tag = 1;
+		static constexpr std::uint32_t floating_tag = 2;
+		static constexpr std::uint32_t string_tag = 4;
+		static constexpr std::uint32_t signed_tag = 8;
+		template<typename T>
+		static constexpr auto type_tag() noexcept -> std::uint32_t {
+			if constexpr (std::same_as<T, std::string>) {
+				return string_tag;
+			} else if constexpr (std::is_floating_point_v<T>) {
+				return floating_tag | signed_tag;
+			} else if constexpr (std::is_integral_v<T>) {
+				return std::is_signed_v<T> ? integral_tag | signed_tag : integral_tag;
+			} else {
+				return 0;
+			}
+		}
+		// The node type's tag in the low half, the weight type's in the high half
+		static constexpr std::uint32_t type_tags = type_tag<N>() | (type_tag<E>() << 16);
+
+		struct file_header {
+			std::array<char, 8> magic;
+			std::uint32_t byte_order;
+			std::uint32_t version;
+			std::uint32_t node_encoding;
+			std::uint32_t node_size;
+			std::uint32_t weight_size;
+			std::uint32_t type_tags;
+			std::uint64_t num_nodes;
+			std::uint64_t num_edges;
+			std::uint64_t node_bytes;
+			std::array<std::uint64_t, 1> padding;
+		};
+		static_assert(sizeof(file_header) == alignment);
+
+	public:
+		// Sections of a parsed file. Pointers refer into the file's bytes, which must outlive the image.
+		struct image {
+			std::size_t num_nodes;
+			std::size_t num_edges;
+			std::byte const* nodes;
+			// Only for std::string nodes: num_nodes + 1 offsets into chars
+			std::uint64_t const* name_offsets;
+			char const* chars;
+			std::uint64_t const* offsets;
+			std::uint32_t const* dsts;
+			std::uint8_t const* weighted;
+			std::byte const* weights;
+		};
+
+		static auto save(graph_type const& g, std::filesystem::path const& path) -> void {
+			auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+			if (!out) {
+				throw std::runtime_error("Cannot call gdwg::save on a path that cannot be written");
+			}
+			const auto& state = *g.state_;
+			auto positions = std::vector<std::uint32_t>(state.nodes.size());
+			auto header = file_header{magic, byte_order, version, raw_nodes, static_cast<std::uint32_t>(sizeof(N)), static_cast<std::uint32_t>(sizeof(E)), type_tags, 0, 0, 0, {}};
+			for (const auto& [node, id] : state.index) {
+				positions[id] = static_cast<std::uint32_t>(header.num_nodes++);
+				header.num_edges += g.edges_of(id).outgoing.size();
+				if constexpr (std::same_as<N, std::string>) {
+					header.node_bytes += node.size();
+				}
+			}
+			if constexpr (std::same_as<N, std::string>) {
+				header.node_encoding = string_nodes;
+				header.node_size = 0;
+				header.node_bytes += (header.num_nodes + 1) * sizeof(std::uint64_t);
+			} else {
+				header.node_bytes = header.num_nodes * sizeof(N);
+			}
+
+			auto writer = section_writer(out);
+			writer.put(header);
+			if constexpr (std::same_as<N, std::string>) {
+				auto name_offset = std::uint64_t{0};
+				for (const auto& [node, id] : state.index) {
+					writer.put(name_offset);
+					name_offset += node.size();
+				}
+				writer.put(name_offset);
+				for (const auto& [node, id] : state.index) {
+					writer.put_bytes(node.data(), node.size());
+				}
+			} else {
+				for (const auto& [node, id] : state.index) {
+					writer.put(node);
+				}
+			}
+			writer.align();
+
+			auto row_offset = std::uint64_t{0};
+			writer.put(row_offset);
+			for (const auto& [node, id] : state.index) {
+				row_offset += g.edges_of(id).outgoing.size();
+				writer.put(row_offset);
+			}
+			writer.align();
+			for (const auto& [node, id] : state.index) {
+				for (const auto& record : g.edges_of(id).outgoing) {
+					writer.put(positions[record.node]);
+				}
+			}
+			writer.align();
+			for (const auto& [node, id] : state.index) {
+				for (const auto& record : g.edges_of(id).outgoing) {
+					writer.put(static_cast<std::uint8_t>(record.weight.has_value()));
+				}
+			}
+			writer.align();
+			const auto no_weight = std::array<std::byte, sizeof(E)>{};
+			for (const auto& [node, id] : state.index) {
+				for (const auto& record : g.edges_of(id).outgoing) {
+					if (record.weight) {
+						writer.put(*record.weight);
+					} else {
+						writer.put_bytes(no_weight.data(), no_weight.size());
+					}
+				}
+			}
+			writer.align();
+			writer.flush();
+			if (!out) {
+				throw std::runtime_error("Cannot call gdwg::save on a path that cannot be written");
+			}
+		}
+
+		// Checks the header and section bounds of bytes. Row offsets are checked too, since every
+		// reader relies on them, but the edge arrays are left to build and to mapped_graph.
+		static auto parse(std::span<std::byte const> bytes, char const* caller) -> image {
+			const auto invalid = [caller] {
+				return std::runtime_error(std::string("Cannot call gdwg::") + caller + " on a file that is not a valid gdwg graph of this type");
+			};
+			auto header = file_header{};
+			if (bytes.size() < sizeof(header)) {
+				throw invalid();
+			}
+			std::memcpy(&header, bytes.data(), sizeof(header));
+			const auto encoding = std::same_as<N, std::string> ? string_nodes : raw_nodes;
+			const auto node_size = std::same_as<N, std::string> ? std::uint32_t{0} : std::uint32_t{sizeof(N)};
+			if (header.magic != magic or header.byte_order != byte_order or header.version != version
+			    or header.node_encoding != encoding or header.node_size != node_size or header.weight_size != sizeof(E)
+			    or header.type_tags != type_tags
+			    or header.num_nodes > std::numeric_limits<node_id>::max()) {
+				throw invalid();
+			}
+
+			auto cursor = sizeof(header);
+			const auto section = [&](std::uint64_t count, std::size_t element_size) {
+				if (cursor > bytes.size() or count > (bytes.size() - cursor) / element_size) {
+					throw invalid();
+				}
+				auto const* const start = bytes.data() + cursor;
+				cursor += align_up(static_cast<std::size_t>(count) * element_size);
+				return start;
+			};
+
+			auto result = image{};
+			result.num_nodes = static_cast<std::size_t>(header.num_nodes);
+			result.num_edges = static_cast<std::size_t>(header.num_edges);
+			result.nodes = section(header.node_bytes, 1);
+			if constexpr (std::same_as<N, std::string>) {
+				const auto table_bytes = (result.num_nodes + 1) * sizeof(std::uint64_t);
+				if (header.node_bytes < table_bytes) {
+					throw invalid();
+				}
+				result.name_offsets = reinterpret_cast<std::uint64_t const*>(result.nodes);
+				result.chars = reinterpret_cast<char const*>(result.nodes + table_bytes);
+				if (!is_row_table(result.name_offsets, result.num_nodes, header.node_bytes - table_bytes)) {
+					throw invalid();
+				}
+			} else if (header.node_bytes != header.num_nodes * sizeof(N)) {
+				throw invalid();
+			}
+			result.offsets = reinterpret_cast<std::uint64_t const*>(section(header.num_nodes + 1, sizeof(std::uint64_t)));
+			result.dsts = reinterpret_cast<std::uint32_t const*>(section(header.num_edges, sizeof(std::uint32_t)));
+			result.weighted = reinterpret_cast<std::uint8_t const*>(section(header.num_edges, sizeof(std::uint8_t)));
+			result.weights = section(header.num_edges, sizeof(E));
+			if (!is_row_table(result.offsets, result.num_nodes, header.num_edges)) {
+				throw invalid();
+			}
+			return result;
+		}
+
+		// Checks that every dst is in range and that each row is in graph's order. Returns false otherwise.
+		static auto valid_edges(image const& img) -> bool {
+			for (std::size_t src = 0; src < img.num_nodes; ++src) {
+				for (auto i = img.offsets[src]; i < img.offsets[src + 1]; ++i) {
+					if (img.dsts[i] >= img.num_nodes or img.weighted[i] > 1) {
+						return false;
+					}
+					if (i != img.offsets[src] and !record_before(img, i - 1, i)) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		static auto node_at(image const& img, std::size_t i) -> N {
+			if constexpr (std::same_as<N, std::string>) {
+				return std::string(img.chars + img.name_offsets[i], img.chars + img.name_offsets[i + 1]);
+			} else {
+				auto value = N();
+				std::memcpy(&value, img.nodes + i * sizeof(N), sizeof(N));
+				return value;
+			}
+		}
+
+		static auto weight_at(image const& img, std::size_t i) -> std::optional<E> {
+			if (img.weighted[i] == 0) {
+				return std::nullopt;
+			}
+			auto weight = E();
+			std::memcpy(&weight, img.weights + i * sizeof(E), sizeof(E));
+			return weight;
+		}
+
+		// Builds a graph from a parsed file in O(n + e): the node index is filled in order with hints,
+		// outgoing lists are copied row by row, and incoming lists come out sorted by bucketing on dst.
+		static auto build(image const& img, typename graph_type::allocator_type alloc, char const* caller) -> graph_type {
+			const auto invalid = [caller] {
+				return std::runtime_error(std::string("Cannot call gdwg::") + caller + " on a file that is not a valid gdwg graph of this type");
+			};
+			if (!valid_edges(img)) {
+				throw invalid();
+			}
+			auto g = graph_type(alloc);
+			if (img.num_nodes == 0) {
+				return g;
+			}
+			auto& state = g.writable();
+			state.nodes.reserve(img.num_nodes);
+			for (std::size_t i = 0; i < img.num_nodes; ++i) {
+				auto value = node_at(img, i);
+				if (i != 0 and !(*state.nodes.back().value < value)) {
+					throw invalid();
+				}
+				const auto it = state.index.emplace_hint(state.index.end(), std::move(value), static_cast<node_id>(i));
+				state.nodes.push_back(node_slot{&it->first, graph_type::empty_adjacency()});
+			}
+
+			auto in_degree = std::vector<std::size_t>(img.num_nodes);
+			for (std::size_t i = 0; i < img.num_edges; ++i) {
+				++in_degree[img.dsts[i]];
+			}
+			for (std::size_t id = 0; id < img.num_nodes; ++id) {
+				const auto out_degree = img.offsets[id + 1] - img.offsets[id];
+				if (out_degree != 0 or in_degree[id] != 0) {
+					auto edges = std::allocate_shared<adjacency>(alloc, alloc);
+					edges->outgoing.reserve(static_cast<std::size_t>(out_degree));
+					edges->incoming.reserve(in_degree[id]);
+					state.nodes[id].edges = std::move(edges);
+				}
+			}
+			for (std::size_t src = 0; src < img.num_nodes; ++src) {
+				auto& outgoing = state.nodes[src].edges->outgoing;
+				for (auto i = img.offsets[src]; i < img.offsets[src + 1]; ++i) {
+					const auto dst = img.dsts[i];
+					const auto weight = weight_at(img, static_cast<std::size_t>(i));
+					outgoing.push_back({dst, weight});
+					state.nodes[dst].edges->incoming.push_back({static_cast<node_id>(src), weight});
+				}
+			}
+			g.rebuild_derived();
+			return g;
+		}
+
+		static auto write_to(graph_type const& g, std::FILE* out) -> void {
+			g.write_text([out](char const* data, std::size_t size) {
+				if (std::fwrite(data, 1, size, out) != size) {
+					throw std::runtime_error("Cannot call gdwg::write_to on a stream that cannot be written");
+				}
+			});
+		}
+
+		static auto write_to(graph_type const& g, int fd) -> void {
+			g.write_text([fd](char const* data, std::size_t size) {
+				while (size > 0) {
+					const auto written = ::write(fd, data, size);
+					if (written < 0 and errno == EINTR) {
+						continue;
+					}
+					if (written <= 0) {
+						throw std::runtime_error("Cannot call gdwg::write_to on a file descriptor that cannot be written");
+					}
+					data += written;
+					size -= static_cast<std::size_t>(written);
+				}
+			});
+		}
+
+	private:
+		// Buffers output so that the file is written in large blocks
+		class section_writer {
+		public:
+			explicit section_writer(std::ofstream& out)
+			: out_(out) {
+				buffer_.reserve(buffer_size);
+			}
+
+			template<typename T>
+			auto put(T const& value) -> void {
+				put_bytes(&value, sizeof(T));
+			}
+
+			auto put_bytes(void const* data, std::size_t size) -> void {
+				auto const* const bytes = static_cast<char const*>(data);
+				buffer_.insert(buffer_.end(), bytes, bytes + size);
+				written_ += size;
+				if (buffer_.size() >= buffer_size) {
+					flush();
+				}
+			}
+
+			// Pads with zeros up to the next section boundary
+			auto align() -> void {
+				buffer_.resize(buffer_.size() + (align_up(written_) - written_));
+				written_ = align_up(written_);
+			}
+
+			auto flush() -> void {
+				out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+				buffer_.clear();
+			}
+
+		private:
+			static constexpr std::size_t buffer_size = std::size_t{1} << 20;
+
+			std::ofstream& out_;
+			std::vector<char> buffer_;
+			std::size_t written_ = 0;
+		};
+
+		static constexpr auto align_up(std::size_t size) noexcept -> std::size_t {
+			return (size + alignment - 1) / alignment * alignment;
+		}
+
+		// Whether table holds count + 1 non-decreasing offsets from 0 to total
+		static auto is_row_table(std::uint64_t const* table, std::size_t count, std::uint64_t total) -> bool {
+			return table[0] == 0 and table[count] == total and std::is_sorted(table, table + count + 1);
+		}
+
+		// Whether edge a sorts strictly before edge b of the same row: by dst, then unweighted first, then by weight
+		static auto record_before(image const& img, std::size_t a, std::size_t b) -> bool {
+			if (img.dsts[a] != img.dsts[b]) {
+				return img.dsts[a] < img.dsts[b];
+			}
+			return weight_at(img, a) < weight_at(img, b);
+		}
+	};
+
+	/**
+	* A read-only graph backed directly by a file written by gdwg::save, mapped into memory.
+	*
+	* Nothing is parsed or copied: nodes(), the row offsets and the edge arrays are used in place, so
+	* opening a graph costs an mmap and touching an edge costs at most a page fault. It offers the read
+	* API of csr_graph, and its iterator has the same value_type as graph::iterator.
+	* N and E must be trivially copyable. The file must not be modified while it is mapped.
+	*/
+	template<typename N, typename E>
+	requires binary_value<N> and binary_value<E>
+	class mapped_graph {
+		public:
+			class iterator;
+
+			/**
+			* Effects: Maps the file at path. The header, the node order and the row offsets are always checked.
+			* If verify_edges is true, every edge is checked as well, which reads the whole file once; pass false
+			* for trusted files so that only the pages actually used are ever read.
+			*
+			* Throws:
+			* - std::runtime_error("Cannot call gdwg::mapped_graph on a path that cannot be read") if path cannot be mapped.
+			* - std::runtime_error("Cannot call gdwg::mapped_graph on a file that is not a valid gdwg graph of this type")
+			* if the file was not written by gdwg::save for these N and E, or is damaged.
+			* Complexity: O(n), or O(n + e) if verify_edges is true.
+			*/
+			explicit mapped_graph(std::filesystem::path const& path, bool verify_edges = true)
+			: mapping_(path, "mapped_graph")
+			, image_(graph_io<N, E>::parse(mapping_.bytes(), "mapped_graph"))
+			, nodes_(reinterpret_cast<N const*>(image_.nodes), image_.num_nodes)
+			, weights_(reinterpret_cast<E const*>(image_.weights), image_.num_edges) {
+				if (std::adjacent_find(nodes_.begin(), nodes_.end(), [](N const& a, N const& b) { return !(a < b); }) != nodes_.end()
+				    or (verify_edges and !graph_io<N, E>::valid_edges(image_))) {
+					throw std::runtime_error("Cannot call gdwg::mapped_graph on a file that is not a valid gdwg graph of this type");
+				}
+			}
+
+			/**
+			* Returns: true if a node equivalent to value exists, and false otherwise.
+			* Complexity: O(log n) time.
+			*/
+			[[nodiscard]] auto is_node(N const& value) const noexcept -> bool {
+				return position_of(value).has_value();
+			}
+
+			/**
+			* Returns: true if there are no nodes, and false otherwise
+			*/
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return nodes_.empty();
+			}
+
+			/**
+			* Returns: All stored nodes, sorted in ascending order, in place in the file.
+			* Complexity: O(1)
+			*/
+			[[nodiscard]] auto nodes() const noexcept -> std::span<N const> {
+				return nodes_;
+			}
+
+			/**
+			* Returns: true if an edge src → dst exists, and false otherwise.
+			* Complexity: O(log(n) + log(e)), where e is the number of outgoing edges of src.
+			* Throws: std::runtime_error("Cannot call gdwg::mapped_graph<N, E>::is_connected if src or dst node don't exist in the graph")
+			* if either of is_node(src) or is_node(dst) are false.
+			*/
+			[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+				const auto src_pos = position_of(src);
+				const auto dst_pos = position_of(dst);
+				if (!src_pos or !dst_pos) {
+					throw std::runtime_error("Cannot call gdwg::mapped_graph<N, E>::is_connected if src or dst node don't exist in the graph");
+				}
+				auto const* const row_begin = image_.dsts + image_.offsets[*src_pos];
+				auto const* const row_end = image_.dsts + image_.offsets[*src_pos + 1];
+				return std::binary_search(row_begin, row_end, static_cast<std::uint32_t>(*dst_pos));
+			}
+
+			/**
+			* Returns: All nodes connected to src by an outgoing edge, sorted in ascending order.
+			* Complexity: O(log (n) + e), where e is the number of outgoing edges of src.
+			* Throws: std::runtime_error("Cannot call gdwg::mapped_graph<N, E>::connections if src doesn't exist in the graph") if is_node(src) is false.
+			*/
+			[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+				const auto src_pos = position_of(src);
+				if (!src_pos) {
+					throw std::runtime_error("Cannot call gdwg::mapped_graph<N, E>::connections if src doesn't exist in the graph");
+				}
+				std::vector<N> unique_dests;
+				for (auto i = image_.offsets[*src_pos]; i < image_.offsets[*src_pos + 1]; ++i) {
+					if (i == image_.offsets[*src_pos] or image_.dsts[i] != image_.dsts[i - 1]) {
+						unique_dests.push_back(nodes_[image_.dsts[i]]);
+					}
+				}
+				return unique_dests;
+			}
+
+			/**
+			* Returns: A graph holding the same nodes and edges, allocated from alloc.
+			* Complexity: O(n + e)
+			*/
+			[[nodiscard]] auto to_graph(typename graph<N, E>::allocator_type alloc = {}) const -> graph<N, E> {
+				return graph_io<N, E>::build(image_, alloc, "mapped_graph");
+			}
+
+			// Returns: An iterator pointing to the first edge.
+			[[nodiscard]] auto begin() const noexcept -> iterator {
+				auto it = iterator(this, 0, 0);
+				it.skip_empty_nodes();
+				return it;
+			}
+
+			// Returns: An iterator denoting the end of the iterable list that begin() points to.
+			[[nodiscard]] auto end() const noexcept -> iterator {
+				return iterator(this, image_.num_nodes, image_.num_edges);
+			}
+
+			/**
+			* Effects: Behaves as a formatted output function of os, in the same format as graph.
+			* Returns: os.
+			*/
+			friend auto operator<<(std::ostream& os, mapped_graph const& g) -> std::ostream& {
+				for (std::size_t n = 0; n < g.nodes_.size(); ++n) {
+					os << g.nodes_[n] << " (\n";
+					for (auto i = g.image_.offsets[n]; i < g.image_.offsets[n + 1]; ++i) {
+						os << "  " << to_string(g.nodes_[n]) << " -> " << to_string(g.nodes_[g.image_.dsts[i]]);
+						if (g.image_.weighted[i] != 0) {
+							os << " | W | " << to_string(g.weights_[i]) << "\n";
+						} else {
+							os << " | U\n";
+						}
+					}
+					os << ")\n";
+				}
+				return os;
+			}
+
+		private:
+			auto position_of(N const& value) const noexcept -> std::optional<std::size_t> {
+				const auto it = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+				if (it == nodes_.end() or *it != value) {
+					return std::nullopt;
+				}
+				return static_cast<std::size_t>(it - nodes_.begin());
+			}
+
+			file_mapping mapping_;
+			typename graph_io<N, E>::image image_;
+			std::span<N const> nodes_;
+			std::span<E const> weights_;
+	};
+
+	template<typename N, typename E>
+	requires binary_value<N> and binary_value<E>
+	class mapped_graph<N, E>::iterator {
+		private:
+			const mapped_graph* graph_ptr_;
+			// Position of the source node, and index of the edge in the edge arrays
+			std::size_t current_node_;
+			std::size_t current_edge_;
+
+			explicit iterator(const mapped_graph* g_ptr, std::size_t node, std::size_t edge) noexcept
+			: graph_ptr_(g_ptr), current_node_(node), current_edge_(edge) {};
+
+			// Moves current_node_ forward to the node owning current_edge_
+			auto skip_empty_nodes() noexcept -> void {
+				const auto& img = graph_ptr_->image_;
+				while (current_node_ < img.num_nodes and current_edge_ == img.offsets[current_node_ + 1]) {
+					++current_node_;
+				}
+			}
+
+		public:
+			using value_type = typename graph<N, E>::iterator::value_type;
+			using reference = value_type;
+			using pointer = void;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::bidirectional_iterator_tag;
+
+			// Iterator constructor
+			iterator() noexcept : graph_ptr_(nullptr), current_node_(0), current_edge_(0) {}
+
+			// Iterator source
+			auto operator*() const noexcept -> reference {
+				const auto& g = *graph_ptr_;
+				return value_type {
+					g.nodes_[current_node_],
+					g.nodes_[g.image_.dsts[current_edge_]],
+					g.image_.weighted[current_edge_] != 0 ? std::optional<E>(g.weights_[current_edge_]) : std::nullopt
+				};
+			}
+
+			// Iterator traversal
+			// Precondition: never add after end
+			auto operator++() noexcept -> iterator& {
+				++current_edge_;
+				skip_empty_nodes();
+				return *this;
+			}
+
+			auto operator++(int) noexcept -> iterator {
+				auto temp = *this;
+				++*this;
+				return temp;
+			}
+
+			// Precondition: never minus before start
+			auto operator--() noexcept -> iterator& {
+				--current_edge_;
+				while (current_edge_ < graph_ptr_->image_.offsets[current_node_]) {
+					--current_node_;
+				}
+				return *this;
+			}
+
+			auto operator--(int) noexcept -> iterator {
+				auto temp = *this;
+				--*this;
+				return temp;
+			}
+
+			// Iterator comparison, by position only
+			auto operator==(iterator const& other) const noexcept -> bool {
+				return graph_ptr_ == other.graph_ptr_ and current_edge_ == other.current_edge_;
+			}
+
+		friend class mapped_graph;
+	};
+
+	/**
+	* Reads edges from text in batches, for read_edge_list. Use the free functions below rather than this class directly.
+	*
+	* A second thread reads and tokenizes the input in blocks of 1 MiB while the calling thread, the only one
+	* that touches the graph, inserts the previous batch through insert_edges. At most two parsed batches wait
+	* at any time, so memory stays bounded whatever the input size.
+	*/
+	template<typename N, typename E>
+	class edge_list_reader {
+		using graph_type = graph<N, E>;
+		using edge_tuple = std::tuple<N, N, std::optional<E>>;
+
+		struct batch {
+			std::vector<N> nodes;
+			std::vector<edge_tuple> edges;
+		};
+
+	public:
+		// source(buffer, capacity) reads up to capacity bytes into buffer, and returns 0 at the end of the input
+		template<typename Source>
+		static auto read(Source source, graph_type& g, std::size_t batch_size) -> std::size_t {
+			auto mutex = std::mutex();
+			auto changed = std::condition_variable_any();
+			auto ready = std::deque<batch>();
+			auto done = false;
+			auto error = std::exception_ptr();
+
+			auto parser = std::jthread([&, batch_size](std::stop_token stop) {
+				auto reader = edge_list_reader();
+				auto lines = std::size_t{0};
+				const auto hand_over = [&] {
+					auto lock = std::unique_lock(mutex);
+					if (changed.wait(lock, stop, [&] { return ready.size() < max_ready; })) {
+						ready.push_back(std::exchange(reader.current_, batch{}));
+						changed.notify_all();
+					}
+				};
+				try {
+					reader.parse(source, stop, [&] {
+						if (++lines >= batch_size) {
+							hand_over();
+							lines = 0;
+						}
+					});
+					hand_over();
+				} catch (...) {
+					const auto lock = std::lock_guard(mutex);
+					error = std::current_exception();
+				}
+				const auto lock = std::lock_guard(mutex);
+				done = true;
+				changed.notify_all();
+			});
+
+			auto added = std::size_t{0};
+			while (true) {
+				auto next = batch{};
+				{
+					auto lock = std::unique_lock(mutex);
+					changed.wait(lock, [&] { return !ready.empty() or done; });
+					if (ready.empty()) {
+						if (error) {
+							std::rethrow_exception(error);
+						}
+						return added;
+					}
+					next = std::move(ready.front());
+					ready.pop_front();
+					changed.notify_all();
+				}
+				// The jthread is stopped and joined if inserting throws
+				std::sort(next.nodes.begin(), next.nodes.end());
+				next.nodes.erase(std::unique(next.nodes.begin(), next.nodes.end()), next.nodes.end());
+				for (const auto& node : next.nodes) {
+					g.insert_node(node);
+				}
+				added += g.insert_edges(next.edges);
+			}
+		}
+
+	private:
+		static constexpr std::size_t block_size = std::size_t{1} << 20;
+		static constexpr std::size_t max_ready = 2;
+
+		// Splits the input into lines, and calls after_line once each line has been added to current_
+		template<typename Source, typename AfterLine>
+		auto parse(Source& source, std::stop_token const& stop, AfterLine after_line) -> void {
+			auto buffer = std::string(block_size, '\0');
+			auto filled = std::size_t{0};
+			auto at_end = false;
+			while (!at_end and !stop.stop_requested()) {
+				if (filled == buffer.size()) {
+					// A single line longer than the buffer
+					buffer.resize(buffer.size() * 2);
+				}
+				const auto count = source(buffer.data() + filled, buffer.size() - filled);
+				at_end = count == 0;
+				filled += count;
+
+				auto text = std::string_view(buffer.data(), filled);
+				for (auto newline = text.find('\n'); newline != std::string_view::npos or (at_end and !text.empty());
+				     newline = text.find('\n')) {
+					parse_line(text.substr(0, newline));
+					after_line();
+					text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+				}
+				// Keep the unfinished last line for the next read
+				std::memmove(buffer.data(), text.data(), text.size());
+				filled = text.size();
+			}
+		}
+
+		// Accepts "src dst", "src dst weight", and the lines operator<< writes: "node (", "src -> dst | U",
+		// "src -> dst | W | weight" and ")". Blank lines and lines starting with # are skipped.
+		auto parse_line(std::string_view line) -> void {
+			++line_number_;
+			auto tokens = std::array<std::string_view, 8>();
+			auto count = std::size_t{0};
+			while (true) {
+				const auto first = line.find_first_not_of(" \t\r");
+				if (first == std::string_view::npos) {
+					break;
+				}
+				line.remove_prefix(first);
+				const auto last = std::min(line.find_first_of(" \t\r"), line.size());
+				if (count == tokens.size()) {
+					malformed();
+				}
+				tokens[count++] = line.substr(0, last);
+				line.remove_prefix(last);
+			}
+
+			if (count == 0 or tokens[0].front() == '#' or (count == 1 and tokens[0] == ")")) {
+				return;
+			}
+			if (count == 2 and tokens[1] == "(") {
+				current_.nodes.push_back(value_of<N>(tokens[0]));
+				return;
+			}
+			auto weight = std::optional<E>();
+			auto dst = std::string_view();
+			if (count >= 5 and tokens[1] == "->" and tokens[3] == "|") {
+				dst = tokens[2];
+				const auto unweighted = count == 5 and tokens[4] == "U";
+				const auto weighted = count == 7 and tokens[4] == "W" and tokens[5] == "|";
+				if (!unweighted and !weighted) {
+					malformed();
+				}
+				if (weighted) {
+					weight = value_of<E>(tokens[6]);
+				}
+			} else if (count == 2 or count == 3) {
+				dst = tokens[1];
+				if (count == 3) {
+					weight = value_of<E>(tokens[2]);
+				}
+			} else {
+				malformed();
+			}
+			auto src_value = value_of<N>(tokens[0]);
+			auto dst_value = value_of<N>(dst);
+			current_.nodes.push_back(src_value);
+			current_.nodes.push_back(dst_value);
+			current_.edges.emplace_back(std::move(src_value), std::move(dst_value), std::move(weight));
+		}
+
+		// Parses a whole token in the format to_string writes it
+		template<typename T>
+		auto value_of(std::string_view token) -> T {
+			if constexpr (std::same_as<T, std::string>) {
+				return T(token);
+			} else if constexpr (chars_formattable<T>) {
+				auto value = T();
+				const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+				if (error != std::errc() or end != token.data() + token.size()) {
+					malformed();
+				}
+				return value;
+			} else {
+				auto value = T();
+				scratch_.clear();
+				scratch_.str(std::string(token));
+				if (!(scratch_ >> value) or scratch_.rdbuf()->in_avail() != 0) {
+					malformed();
+				}
+				return value;
+			}
+		}
+
+		[[noreturn]] auto malformed() const -> void {
+			throw std::runtime_error("Cannot call gdwg::read_edge_list on malformed line " + std::to_string(line_number_));
+		}
+
+		batch current_;
+		std::size_t line_number_ = 0;
+		std::istringstream scratch_;
+	};
+
+	/**
+	* Effects: Writes g to path in the binary format of graph_io, replacing any existing file.
+	* N must be trivially copyable or std::string, and E trivially copyable.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::save on a path that cannot be written") if writing fails.
+	*
+	* Complexity: O(n + e), written in large blocks.
+	*/
+	template<binary_node N, binary_value E>
+	auto save(graph<N, E> const& g, std::filesystem::path const& path) -> void {
+		graph_io<N, E>::save(g, path);
+	}
+
+	/**
+	* Effects: Writes g to out in exactly the text format of operator<<, in blocks of 64 KiB and without
+	* going through iostreams. out is not flushed.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::write_to on a stream that cannot be written") if a write fails.
+	*
+	* Complexity: O(n + e)
+	*/
+	template<typename N, typename E>
+	auto write_to(graph<N, E> const& g, std::FILE* out) -> void {
+		graph_io<N, E>::write_to(g, out);
+	}
+
+	/**
+	* Effects: Writes g to the file descriptor fd in exactly the text format of operator<<, in blocks of 64 KiB.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::write_to on a file descriptor that cannot be written") if a write fails.
+	*
+	* Complexity: O(n + e)
+	*/
+	template<typename N, typename E>
+	auto write_to(graph<N, E> const& g, int fd) -> void {
+		graph_io<N, E>::write_to(g, fd);
+	}
+
+	/**
+	* Returns: The graph saved at path by gdwg::save, allocated from alloc.
+	* The file is mapped and its arrays are copied straight into the graph's storage: nothing is sorted
+	* or looked up, and each edge list is allocated once.
+	*
+	* Throws:
+	* - std::runtime_error("Cannot call gdwg::load on a path that cannot be read") if path cannot be read.
+	* - std::runtime_error("Cannot call gdwg::load on a file that is not a valid gdwg graph of this type")
+	* if the file was not written by gdwg::save for these N and E, or is damaged.
+	*
+	* Complexity: O(n + e)
+	*/
+	template<binary_node N, binary_value E>
+	auto load(std::filesystem::path const& path, typename graph<N, E>::allocator_type alloc = {}) -> graph<N, E> {
+		const auto mapping = file_mapping(path, "load");
+		return graph_io<N, E>::build(graph_io<N, E>::parse(mapping.bytes(), "load"), alloc, "load");
+	}
+
+	/**
+	* Effects: Reads an edge list from in and adds every edge to g, creating the nodes it names.
+	* Each line is one of:
+	* - src dst, for an unweighted edge, or src dst weight, for a weighted one;
+	* - a line of operator<<: "node (", "src -> dst | U", "src -> dst | W | weight" or ")", so dumps read back
+	* into an equal graph, isolated nodes included, as long as no value prints with whitespace and every value
+	* prints exactly. operator<< writes floating point values with 6 significant digits, so 0.1234567 reads
+	* back as 0.123457 and the graphs differ; integers and other exactly printed values round trip;
+	* - a blank line, or a comment starting with #.
+	* Values are parsed with std::from_chars for arithmetic types and operator>> otherwise. Edges are inserted
+	* through insert_edges in batches of batch_size lines, parsed on a second thread.
+	*
+	* Returns: The number of edges added.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::read_edge_list on malformed line <line number>").
+	* g then holds the edges of some prefix of the input.
+	*
+	* Complexity: O(l log n) for l lines, with memory bounded by a few batches rather than the input size.
+	*/
+	template<typename N, typename E>
+	auto read_edge_list(std::istream& in, graph<N, E>& g, std::size_t batch_size = std::size_t{1} << 16) -> std::size_t {
+		return edge_list_reader<N, E>::read([&in](char* buffer, std::size_t capacity) {
+			in.read(buffer, static_cast<std::streamsize>(capacity));
+			return static_cast<std::size_t>(in.gcount());
+		}, g, batch_size);
+	}
+
+	/**
+	* Effects: As read_edge_list(in, g, batch_size), reading from the file descriptor fd (a file, pipe or socket)
+	* until the end of its input.
+	*
+	* Throws: std::runtime_error("Cannot call gdwg::read_edge_list on a file descriptor that cannot be read")
+	* if a read fails, and as above for malformed lines.
+	*
+	* Complexity: As above.
+	*/
+	template<typename N, typename E>
+	auto read_edge_list(int fd, graph<N, E>& g, std::size_t batch_size = std::size_t{1} << 16) -> std::size_t {
+		return edge_list_reader<N, E>::read([fd](char* buffer, std::size_t capacity) {
+			while (true) {
+				const auto count = ::read(fd, buffer, capacity);
+				if (count >= 0) {
+					return static_cast<std::size_t>(count);
+				}
+				if (errno != EINTR) {
+					throw std::runtime_error("Cannot call gdwg::read_edge_list on a file descriptor that cannot be read");
+				}
+			}
+		}, g, batch_size);
+	}
+} // namespace gdwg
+
+#endif // GDWG_IO_H
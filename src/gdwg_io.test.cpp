@@ -0,0 +1,264 @@
+#include "gdwg_io.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+	auto temp_path(std::string const& name) -> std::filesystem::path {
+		return std::filesystem::temp_directory_path() / ("gdwg_io_test_" + name + ".bin");
+	}
+
+	template<typename Graph>
+	auto printed(Graph const& g) -> std::string {
+		auto out = std::ostringstream{};
+		out << g;
+		return out.str();
+	}
+
+	// 1 → 2 twice, self loop on 3, 4 erased so its id sits on the free list, 5 isolated
+	auto make_sample() -> gdwg::graph<int, double> {
+		auto g = gdwg::graph<int, double>{1, 2, 3, 4, 5};
+		g.insert_edge(1, 2, 2.5);
+		g.insert_edge(1, 2);
+		g.insert_edge(1, 3, -1.0);
+		g.insert_edge(3, 3, 0.5);
+		g.insert_edge(3, 1);
+		g.insert_edge(4, 1, 7.0);
+		g.erase_node(4);
+		g.insert_node(0);
+		return g;
+	}
+}
+
+TEST_CASE("save and load round trip a graph") {
+	SECTION("Trivially copyable nodes and weights") {
+		auto const g = make_sample();
+		auto const path = temp_path("int_double");
+		gdwg::save(g, path);
+		auto loaded = gdwg::load<int, double>(path);
+		REQUIRE(loaded == g);
+		REQUIRE(loaded.fingerprint() == g.fingerprint());
+		REQUIRE(loaded.num_edges() == g.num_edges());
+		REQUIRE(printed(loaded) == printed(g));
+
+		// The loaded graph is an ordinary graph, its incoming lists included
+		REQUIRE(loaded.erase_node(3));
+		REQUIRE(loaded.connections(1) == std::vector<int>{2});
+		std::filesystem::remove(path);
+	}
+
+	SECTION("std::string nodes") {
+		auto g = gdwg::graph<std::string, int>{"", "a", "hello", "world"};
+		g.insert_edge("hello", "world", 3);
+		g.insert_edge("world", "", 4);
+		g.insert_edge("a", "a");
+		auto const path = temp_path("string_int");
+		gdwg::save(g, path);
+		REQUIRE(gdwg::load<std::string, int>(path) == g);
+		std::filesystem::remove(path);
+	}
+
+	SECTION("Empty graphs") {
+		auto const path = temp_path("empty");
+		gdwg::save(gdwg::graph<int, int>{}, path);
+		REQUIRE(gdwg::load<int, int>(path).empty());
+		auto const mapped = gdwg::mapped_graph<int, int>(path);
+		REQUIRE(mapped.empty());
+		REQUIRE(mapped.begin() == mapped.end());
+		std::filesystem::remove(path);
+	}
+}
+
+TEST_CASE("mapped_graph reads a saved graph in place") {
+	auto const g = make_sample();
+	auto const path = temp_path("mapped");
+	gdwg::save(g, path);
+
+	for (auto const verify : {true, false}) {
+		auto const mapped = gdwg::mapped_graph<int, double>(path, verify);
+		auto const nodes = g.nodes();
+		REQUIRE(std::vector<int>(mapped.nodes().begin(), mapped.nodes().end()) == nodes);
+		REQUIRE(mapped.is_node(5));
+		REQUIRE_FALSE(mapped.is_node(4));
+		REQUIRE(mapped.is_connected(1, 3));
+		REQUIRE_FALSE(mapped.is_connected(2, 1));
+		REQUIRE(mapped.connections(1) == std::vector<int>{2, 3});
+		REQUIRE(printed(mapped) == printed(g));
+		REQUIRE(mapped.to_graph() == g);
+
+		auto expected = g.begin();
+		for (auto const& [from, to, weight] : mapped) {
+			auto const e = *expected++;
+			REQUIRE(from == e.from);
+			REQUIRE(to == e.to);
+			REQUIRE(weight == e.weight);
+		}
+		REQUIRE(expected == g.end());
+		REQUIRE((*--mapped.end()).from == 3);
+
+		REQUIRE_THROWS_WITH(mapped.is_connected(1, 4),
+		                    "Cannot call gdwg::mapped_graph<N, E>::is_connected if src or dst node don't exist in the graph");
+		REQUIRE_THROWS_WITH(mapped.connections(4),
+		                    "Cannot call gdwg::mapped_graph<N, E>::connections if src doesn't exist in the graph");
+	}
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Loading rejects files it cannot trust") {
+	auto const path = temp_path("invalid");
+	gdwg::save(make_sample(), path);
+	auto bytes = std::vector<char>(std::filesystem::file_size(path));
+	std::ifstream(path, std::ios::binary).read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	auto const rewrite = [&path](std::vector<char> const& content) {
+		std::ofstream(path, std::ios::binary | std::ios::trunc).write(content.data(), static_cast<std::streamsize>(content.size()));
+	};
+	auto const invalid = std::string("Cannot call gdwg::load on a file that is not a valid gdwg graph of this type");
+
+	SECTION("Missing files") {
+		REQUIRE_THROWS_WITH((gdwg::load<int, double>(temp_path("missing"))), "Cannot call gdwg::load on a path that cannot be read");
+		REQUIRE_THROWS_WITH((gdwg::mapped_graph<int, double>(temp_path("missing"))),
+		                    "Cannot call gdwg::mapped_graph on a path that cannot be read");
+	}
+
+	SECTION("Other node or weight types") {
+		REQUIRE_THROWS_WITH((gdwg::load<int, float>(path)), invalid);
+		REQUIRE_THROWS_WITH((gdwg::load<std::string, double>(path)), invalid);
+		// Types of the same size that store differently
+		REQUIRE_THROWS_WITH((gdwg::load<float, double>(path)), invalid);
+		REQUIRE_THROWS_WITH((gdwg::load<unsigned, double>(path)), invalid);
+		REQUIRE_THROWS_WITH((gdwg::load<int, std::int64_t>(path)), invalid);
+		REQUIRE_THROWS_WITH((gdwg::mapped_graph<int, std::int64_t>(path)),
+		                    "Cannot call gdwg::mapped_graph on a file that is not a valid gdwg graph of this type");
+	}
+
+	SECTION("Truncated files") {
+		rewrite(std::vector<char>(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(bytes.size() / 2)));
+		REQUIRE_THROWS_WITH((gdwg::load<int, double>(path)), invalid);
+		rewrite({});
+		REQUIRE_THROWS_WITH((gdwg::load<int, double>(path)), invalid);
+		REQUIRE_THROWS_WITH((gdwg::mapped_graph<int, double>(path)),
+		                    "Cannot call gdwg::mapped_graph on a file that is not a valid gdwg graph of this type");
+	}
+
+	SECTION("An edge to a node that does not exist") {
+		// Header, then 5 nodes and 6 row offsets each padded to 64 bytes: the dst array starts at 192
+		bytes[192] = 9;
+		rewrite(bytes);
+		REQUIRE_THROWS_WITH((gdwg::load<int, double>(path)), invalid);
+		REQUIRE_THROWS_WITH((gdwg::mapped_graph<int, double>(path)),
+		                    "Cannot call gdwg::mapped_graph on a file that is not a valid gdwg graph of this type");
+		REQUIRE_NOTHROW(gdwg::mapped_graph<int, double>(path, false));
+	}
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("write_to matches operator<< on FILE streams and file descriptors") {
+	auto const g = make_sample();
+	auto const expected = printed(g);
+	auto const path = temp_path("text");
+	auto const read_back = [&path] {
+		auto text = std::ostringstream{};
+		text << std::ifstream(path).rdbuf();
+		return text.str();
+	};
+
+	SECTION("FILE*") {
+		auto* const out = std::fopen(path.c_str(), "wb");
+		REQUIRE(out != nullptr);
+		gdwg::write_to(g, out);
+		std::fclose(out);
+		REQUIRE(read_back() == expected);
+	}
+
+	SECTION("File descriptor") {
+		const auto fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+		REQUIRE(fd >= 0);
+		gdwg::write_to(g, fd);
+		::close(fd);
+		REQUIRE(read_back() == expected);
+		REQUIRE_THROWS_WITH(gdwg::write_to(g, -1), "Cannot call gdwg::write_to on a file descriptor that cannot be written");
+	}
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("read_edge_list parses edge lists and reads back dumps") {
+	SECTION("Plain edge lists create their nodes") {
+		auto in = std::istringstream("# a comment\n1 2\n\n1 2 2.5\n  3 3 -0.5\r\n2 1 1e3");
+		auto g = gdwg::graph<int, double>{};
+		REQUIRE(gdwg::read_edge_list(in, g) == 4);
+		REQUIRE(g.nodes() == std::vector<int>{1, 2, 3});
+		REQUIRE(g.is_connected(1, 2));
+		REQUIRE(g.is_connected(3, 3));
+		REQUIRE(g.find(2, 1, 1000.0) != g.end());
+		REQUIRE(g.find(1, 2) != g.end());
+
+		// Duplicates of existing edges are not added again
+		auto again = std::istringstream("1 2 2.5\n1 3\n");
+		REQUIRE(gdwg::read_edge_list(again, g) == 1);
+	}
+
+	SECTION("operator<< output round trips, isolated nodes included") {
+		auto const g = make_sample();
+		auto in = std::istringstream(printed(g));
+		auto read = gdwg::graph<int, double>{};
+		REQUIRE(gdwg::read_edge_list(in, read) == 5);
+		REQUIRE(read == g);
+	}
+
+	SECTION("String nodes round trip through many small batches") {
+		auto g = gdwg::graph<std::string, int>{"lonely"};
+		for (auto i = 0; i < 500; ++i) {
+			g.insert_node("n" + std::to_string(i));
+		}
+		for (auto i = 0; i < 500; ++i) {
+			g.insert_edge("n" + std::to_string(i), "n" + std::to_string((i * 7) % 500), i);
+			g.insert_edge("n" + std::to_string(i), "n" + std::to_string((i + 1) % 500));
+		}
+		auto in = std::istringstream(printed(g));
+		auto read = gdwg::graph<std::string, int>{};
+		REQUIRE(gdwg::read_edge_list(in, read, 16) == 1000);
+		REQUIRE(read == g);
+	}
+
+	SECTION("Malformed lines throw with their line number") {
+		auto const malformed = [](std::string const& text) {
+			auto in = std::istringstream(text);
+			auto g = gdwg::graph<int, int>{};
+			gdwg::read_edge_list(in, g, 1);
+		};
+		REQUIRE_THROWS_WITH(malformed("1 2\n1 x\n"), "Cannot call gdwg::read_edge_list on malformed line 2");
+		REQUIRE_THROWS_WITH(malformed("1 2 3 4\n"), "Cannot call gdwg::read_edge_list on malformed line 1");
+		REQUIRE_THROWS_WITH(malformed("\n\n1 -> 2 | W\n"), "Cannot call gdwg::read_edge_list on malformed line 3");
+		REQUIRE_THROWS_WITH(malformed("1 2 3.5\n"), "Cannot call gdwg::read_edge_list on malformed line 1");
+	}
+
+	SECTION("File descriptor") {
+		auto const g = make_sample();
+		auto const path = temp_path("edges");
+		const auto out = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+		REQUIRE(out >= 0);
+		gdwg::write_to(g, out);
+		::close(out);
+
+		const auto in = ::open(path.c_str(), O_RDONLY);
+		REQUIRE(in >= 0);
+		auto read = gdwg::graph<int, double>{};
+		REQUIRE(gdwg::read_edge_list(in, read) == 5);
+		::close(in);
+		REQUIRE(read == g);
+		REQUIRE_THROWS_WITH(gdwg::read_edge_list(-1, read),
+		                    "Cannot call gdwg::read_edge_list on a file descriptor that cannot be read");
+		std::filesystem::remove(path);
+	}
+}
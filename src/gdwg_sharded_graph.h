@@ -0,0 +1,544 @@
+#ifndef GDWG_SHARDED_GRAPH_H
+#define GDWG_SHARDED_GRAPH_H
+#include "gdwg_graph.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	/**
+	* How well a sharded_graph's nodes are spread, returned by sharded_graph::partition_report().
+	* The per-shard vectors are indexed by shard.
+	*/
+	struct partition_report {
+		// Nodes owned by each shard
+		std::vector<std::size_t> nodes;
+		// Edges stored on each shard, which is the shard of their src
+		std::vector<std::size_t> edges;
+		// Ghost copies of other shards' nodes that each shard holds as the dst of a cut edge
+		std::vector<std::size_t> ghosts;
+		// Edges whose src and dst are owned by different shards
+		std::size_t cut_edges = 0;
+		std::size_t total_edges = 0;
+
+		// Returns: The fraction of edges that are cut, or 0 if there are none
+		[[nodiscard]] auto cut_ratio() const noexcept -> double {
+			return total_edges == 0 ? 0.0 : static_cast<double>(cut_edges) / static_cast<double>(total_edges);
+		}
+
+		// Returns: The edges on the fullest shard over the mean edges per shard, 1 being a perfect balance
+		[[nodiscard]] auto edge_imbalance() const noexcept -> double {
+			if (total_edges == 0) {
+				return 1.0;
+			}
+			const auto fullest = *std::max_element(edges.begin(), edges.end());
+			return static_cast<double>(fullest) * static_cast<double>(edges.size()) / static_cast<double>(total_edges);
+		}
+
+		// Writes one "name value" line per figure, as graph_stats does
+		friend auto operator<<(std::ostream& os, partition_report const& report) -> std::ostream& {
+			os << "shards " << report.nodes.size() << '\n' << "total_edges " << report.total_edges << '\n'
+			   << "cut_edges " << report.cut_edges << '\n' << "cut_ratio " << report.cut_ratio() << '\n'
+			   << "edge_imbalance " << report.edge_imbalance() << '\n';
+			for (auto shard = std::size_t{0}; shard < report.nodes.size(); ++shard) {
+				os << "shard." << shard << ".nodes " << report.nodes[shard] << '\n' << "shard." << shard << ".edges "
+				   << report.edges[shard] << '\n' << "shard." << shard << ".ghosts " << report.ghosts[shard] << '\n';
+			}
+			return os;
+		}
+	};
+
+	/**
+	* A directed weighted graph whose nodes are hash-partitioned across a fixed number of gdwg::graph shards,
+	* with the same edge semantics and the same read API as gdwg::graph.
+	*
+	* Each node is owned by shard partition(value) % num_shards(), and every edge is stored once, on the
+	* shard of its src. An edge to a node owned elsewhere is cut: the src shard holds a ghost copy of the
+	* dst as the edge's endpoint, and the dst shard keeps a ghost entry on its incoming side, counting the
+	* cut edges from each remote src so that erasing the dst knows which shards to visit. A ghost lives
+	* exactly as long as some edge points at it.
+	*
+	* Every shard is an ordinary graph, so it can allocate from its own std::pmr::memory_resource, for
+	* example one backed by a file mapping. Like graph, a sharded_graph is not safe to mutate from several
+	* threads at once, but shards never refer to each other's storage.
+	*
+	* Requires: Partition is a hash of N, std::hash<N> by default, in addition to what gdwg::graph requires.
+	*/
+	template<typename N, typename E, typename Partition = std::hash<N>>
+	class sharded_graph {
+		using shard_graph = graph<N, E>;
+
+		struct shard_state {
+			// Owned nodes, ghosts of the remote dsts of local edges, and every edge from an owned node
+			shard_graph local;
+			// Owned dst → remote src → number of edges src → dst stored on the shard of src
+			std::map<N, std::map<N, std::size_t>> remote_in;
+			std::size_t owned = 0;
+		};
+
+	public:
+		class iterator;
+
+		/**
+		* Effects: Constructs an empty graph over num_shards shards.
+		* Throws: std::runtime_error("Cannot construct gdwg::sharded_graph<N, E> with zero shards") if num_shards is 0.
+		*/
+		explicit sharded_graph(std::size_t num_shards = 4, Partition partition = Partition())
+		: sharded_graph(std::vector<typename shard_graph::allocator_type>(num_shards), std::move(partition)) {}
+
+		/**
+		* Effects: Constructs an empty graph with one shard per allocator, each shard allocating from its own.
+		* Throws: std::runtime_error("Cannot construct gdwg::sharded_graph<N, E> with zero shards") if allocs is empty.
+		*/
+		explicit sharded_graph(std::vector<typename shard_graph::allocator_type> const& allocs, Partition partition = Partition())
+		: partition_(std::move(partition)) {
+			if (allocs.empty()) {
+				throw std::runtime_error("Cannot construct gdwg::sharded_graph<N, E> with zero shards");
+			}
+			shards_.reserve(allocs.size());
+			for (const auto& alloc : allocs) {
+				shards_.push_back(shard_state{shard_graph(alloc), {}, 0});
+			}
+		}
+
+		/**
+		* Effects: Constructs a graph over num_shards shards holding the nodes and edges of g.
+		* Complexity: O(n log n + e log e)
+		*/
+		explicit sharded_graph(graph<N, E> const& g, std::size_t num_shards = 4, Partition partition = Partition())
+		: sharded_graph(num_shards, std::move(partition)) {
+			for (const auto& node : g.nodes()) {
+				insert_node(node);
+			}
+			for (auto it = g.begin(); it != g.end(); ++it) {
+				const auto& [from, to, weight] = *it;
+				insert_edge(from, to, weight);
+			}
+		}
+
+		/**
+		* Returns: The number of shards, fixed at construction.
+		*/
+		[[nodiscard]] auto num_shards() const noexcept -> std::size_t {
+			return shards_.size();
+		}
+
+		/**
+		* Returns: The shard that owns value, whether or not it is a node.
+		*/
+		[[nodiscard]] auto shard_of(N const& value) const -> std::size_t {
+			return static_cast<std::size_t>(std::invoke(partition_, value)) % shards_.size();
+		}
+
+		/**
+		* Effects: Adds a new node with value value to its shard if, and only if, there is no node equivalent to value already stored.
+		* Returns: true if the node is added to the graph and false otherwise.
+		*/
+		auto insert_node(N const& value) -> bool {
+			auto& s = shards_[shard_of(value)];
+			if (!s.local.insert_node(value)) {
+				return false;
+			}
+			++s.owned;
+			return true;
+		}
+
+		/**
+		* Effects: Adds a new edge src → dst with an optional weight on the shard of src, unless an equal edge already exists.
+		* If dst is owned by another shard, the shard of src gains a ghost of dst and the shard of dst records the edge on its incoming side.
+		* Returns: true if the edge is added and false otherwise.
+		* Throws: std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::insert_edge when either src or dst node does not exist")
+		* if either of is_node(src) or is_node(dst) are false.
+		*/
+		auto insert_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
+			if (!is_node(src) or !is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::insert_edge when either src or dst node does not exist");
+			}
+			const auto src_shard = shard_of(src);
+			const auto dst_shard = shard_of(dst);
+			auto& local = shards_[src_shard].local;
+			if (src_shard == dst_shard) {
+				return local.insert_edge(src, dst, std::move(weight));
+			}
+			local.insert_node(dst);
+			if (!local.insert_edge(src, dst, std::move(weight))) {
+				return false;
+			}
+			++shards_[dst_shard].remote_in[dst][src];
+			return true;
+		}
+
+		/**
+		* Effects: Erases the edge src → dst with the specified weight, or the unweighted edge if weight is std::nullopt.
+		* Returns: true if an edge was removed and false otherwise.
+		* Throws: std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::erase_edge on src or dst if they don't exist in the graph")
+		* if either of is_node(src) or is_node(dst) are false.
+		*/
+		auto erase_edge(N const& src, N const& dst, std::optional<E> const& weight = std::nullopt) -> bool {
+			if (!is_node(src) or !is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::erase_edge on src or dst if they don't exist in the graph");
+			}
+			const auto src_shard = shard_of(src);
+			const auto dst_shard = shard_of(dst);
+			auto& local = shards_[src_shard].local;
+			if (src_shard == dst_shard) {
+				return local.erase_edge(src, dst, weight);
+			}
+			if (!local.is_node(dst) or !local.erase_edge(src, dst, weight)) {
+				return false;
+			}
+			forget_cut_edges(dst_shard, dst, src, 1);
+			drop_ghost_if_unused(local, dst);
+			return true;
+		}
+
+		/**
+		* Effects: Erases the node equivalent to value and every edge incident to it, along with the ghosts of
+		* value on other shards and the ghosts only its edges used.
+		* Returns: true if value was removed and false otherwise.
+		* Complexity: O(s + d log n), where s is the number of shards holding a ghost of value and d is its degree.
+		*/
+		auto erase_node(N const& value) -> bool {
+			const auto owner = shard_of(value);
+			auto& s = shards_[owner];
+			if (!is_node(value)) {
+				return false;
+			}
+
+			// 1. Cut edges into value: erasing its ghost on each src shard erases them all at once
+			if (const auto it = s.remote_in.find(value); it != s.remote_in.end()) {
+				for (const auto& [src, count] : it->second) {
+					shards_[shard_of(src)].local.erase_node(value);
+				}
+				s.remote_in.erase(it);
+			}
+
+			// 2. Cut edges out of value: forget them on the dst shards, then drop the ghosts left unused
+			auto remote_dsts = std::vector<N>();
+			for (const auto& dst : s.local.connections_view(value)) {
+				if (shard_of(dst) != owner) {
+					forget_cut_edges(shard_of(dst), dst, value, s.local.edges(value, dst).size());
+					remote_dsts.push_back(dst);
+				}
+			}
+			s.local.erase_node(value);
+			for (const auto& dst : remote_dsts) {
+				drop_ghost_if_unused(s.local, dst);
+			}
+			--s.owned;
+			return true;
+		}
+
+		/**
+		* Effects: Erases all nodes and edges from every shard.
+		*/
+		auto clear() noexcept -> void {
+			for (auto& s : shards_) {
+				s.local.clear();
+				s.remote_in.clear();
+				s.owned = 0;
+			}
+		}
+
+		/**
+		* Returns: true if value is a node of the graph, and false otherwise.
+		* Complexity: O(log(n)), where n is the number of nodes of the shard of value.
+		*/
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return shards_[shard_of(value)].local.is_node(value);
+		}
+
+		/**
+		* Returns: true if there are no nodes in the graph, and false otherwise.
+		*/
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return num_nodes() == 0;
+		}
+
+		/**
+		* Returns: The number of nodes, not counting ghosts. Complexity: O(number of shards)
+		*/
+		[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+			auto total = std::size_t{0};
+			for (const auto& s : shards_) {
+				total += s.owned;
+			}
+			return total;
+		}
+
+		/**
+		* Returns: The number of edges, each stored once. Complexity: O(number of shards)
+		*/
+		[[nodiscard]] auto num_edges() const noexcept -> std::size_t {
+			auto total = std::size_t{0};
+			for (const auto& s : shards_) {
+				total += s.local.num_edges();
+			}
+			return total;
+		}
+
+		/**
+		* Returns: true if an edge src → dst exists in the graph, and false otherwise.
+		* Throws: std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::is_connected if src or dst node don't exist in the graph")
+		* if either of is_node(src) or is_node(dst) are false.
+		*/
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			if (!is_node(src) or !is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::is_connected if src or dst node don't exist in the graph");
+			}
+			const auto& local = shards_[shard_of(src)].local;
+			return local.is_node(dst) and local.is_connected(src, dst);
+		}
+
+		/**
+		* Returns: All nodes connected to src by an outgoing edge, sorted in ascending order, read from the shard of src alone.
+		* Throws: std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::connections if src doesn't exist in the graph")
+		* if is_node(src) is false.
+		*/
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			if (!is_node(src)) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::connections if src doesn't exist in the graph");
+			}
+			return shards_[shard_of(src)].local.connections(src);
+		}
+
+		/**
+		* Returns: The number of edges out of src, read from its shard alone.
+		* Throws: std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::out_degree if src doesn't exist in the graph")
+		* if is_node(src) is false.
+		*/
+		[[nodiscard]] auto out_degree(N const& src) const -> std::size_t {
+			if (!is_node(src)) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::out_degree if src doesn't exist in the graph");
+			}
+			return shards_[shard_of(src)].local.out_degree(src);
+		}
+
+		/**
+		* Returns: The number of edges into dst: those stored on its own shard, plus its ghost entries for cut edges.
+		* Throws: std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::in_degree if dst doesn't exist in the graph")
+		* if is_node(dst) is false.
+		*/
+		[[nodiscard]] auto in_degree(N const& dst) const -> std::size_t {
+			if (!is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::in_degree if dst doesn't exist in the graph");
+			}
+			const auto& s = shards_[shard_of(dst)];
+			auto degree = s.local.in_degree(dst);
+			if (const auto it = s.remote_in.find(dst); it != s.remote_in.end()) {
+				for (const auto& [src, count] : it->second) {
+					degree += count;
+				}
+			}
+			return degree;
+		}
+
+		/**
+		* Returns: A sequence of all nodes, not counting ghosts, sorted in ascending order.
+		* Complexity: O(n log n)
+		*/
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			auto result = std::vector<N>();
+			result.reserve(num_nodes());
+			for (auto shard = std::size_t{0}; shard < shards_.size(); ++shard) {
+				for (const auto& node : shards_[shard].local.nodes()) {
+					if (shard_of(node) == shard) {
+						result.push_back(node);
+					}
+				}
+			}
+			std::sort(result.begin(), result.end());
+			return result;
+		}
+
+		/**
+		* Returns: An iterator to the edge src → dst with the specified weight, or end() if there is none.
+		*/
+		[[nodiscard]] auto find(N const& src, N const& dst, std::optional<E> const& weight = std::nullopt) const -> iterator {
+			const auto shard = shard_of(src);
+			const auto& local = shards_[shard].local;
+			if (auto it = local.find(src, dst, weight); it != local.end()) {
+				return iterator(this, shard, std::move(it));
+			}
+			return end();
+		}
+
+		/**
+		* Returns: An iterator to the first edge. Edges are visited shard by shard, and in the order of
+		* graph::iterator within a shard. Mutating the graph invalidates every iterator.
+		*/
+		[[nodiscard]] auto begin() const -> iterator {
+			return iterator(this, 0);
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator(this, shards_.size());
+		}
+
+		/**
+		* Returns: The shard at index: the nodes it owns, the ghosts it holds and the edges it stores.
+		* Throws: std::out_of_range if index is not less than num_shards().
+		*/
+		[[nodiscard]] auto shard(std::size_t index) const -> graph<N, E> const& {
+			return shards_.at(index).local;
+		}
+
+		/**
+		* Returns: The nodes, edges and ghosts of every shard, and how many edges are cut.
+		* Complexity: O(n log n) in the nodes, and O(ghost entries)
+		*/
+		[[nodiscard]] auto partition_report() const -> gdwg::partition_report {
+			auto report = gdwg::partition_report();
+			for (const auto& s : shards_) {
+				report.nodes.push_back(s.owned);
+				report.edges.push_back(s.local.num_edges());
+				report.ghosts.push_back(s.local.num_nodes() - s.owned);
+				report.total_edges += s.local.num_edges();
+				for (const auto& [dst, sources] : s.remote_in) {
+					for (const auto& [src, count] : sources) {
+						report.cut_edges += count;
+					}
+				}
+			}
+			return report;
+		}
+
+		/**
+		* Returns: A graph holding the same nodes and edges, without ghosts.
+		* Complexity: O(n log n + e log e)
+		*/
+		[[nodiscard]] auto to_graph() const -> graph<N, E> {
+			auto edges = std::vector<std::tuple<N, N, std::optional<E>>>();
+			edges.reserve(num_edges());
+			for (auto it = begin(); it != end(); ++it) {
+				auto [from, to, weight] = *it;
+				edges.emplace_back(std::move(from), std::move(to), std::move(weight));
+			}
+			return graph<N, E>(nodes(), edges);
+		}
+
+	private:
+		// Removes count cut edges src → dst from the ghost entries of dst on its shard
+		auto forget_cut_edges(std::size_t dst_shard, N const& dst, N const& src, std::size_t count) -> void {
+			auto& remote_in = shards_[dst_shard].remote_in;
+			const auto dst_it = remote_in.find(dst);
+			const auto src_it = dst_it->second.find(src);
+			src_it->second -= count;
+			if (src_it->second == 0) {
+				dst_it->second.erase(src_it);
+				if (dst_it->second.empty()) {
+					remote_in.erase(dst_it);
+				}
+			}
+		}
+
+		// Precondition: ghost is owned by another shard than local's
+		static auto drop_ghost_if_unused(shard_graph& local, N const& ghost) -> void {
+			if (local.is_node(ghost) and local.in_degree(ghost) == 0) {
+				local.erase_node(ghost);
+			}
+		}
+
+		Partition partition_;
+		std::vector<shard_state> shards_;
+	};
+
+	/**
+	* Iterates the edges of a sharded_graph shard by shard, with the same value_type as graph::iterator.
+	* Ghosts never have outgoing edges, so each edge is visited exactly once, from the shard of its src.
+	*/
+	template<typename N, typename E, typename Partition>
+	class sharded_graph<N, E, Partition>::iterator {
+		using shard_iterator = typename graph<N, E>::iterator;
+
+	public:
+		using value_type = typename shard_iterator::value_type;
+		using reference = value_type;
+		using pointer = void;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::forward_iterator_tag;
+
+		iterator() = default;
+
+		iterator(iterator const&) = default;
+
+		// graph::iterator is not assignable, so the shard's iterator is emplaced again
+		auto operator=(iterator const& other) -> iterator& {
+			if (this != &other) {
+				graph_ = other.graph_;
+				shard_ = other.shard_;
+				current_.reset();
+				if (other.current_) {
+					current_.emplace(*other.current_);
+				}
+			}
+			return *this;
+		}
+
+		~iterator() = default;
+
+		auto operator*() const -> reference {
+			return **current_;
+		}
+
+		auto operator++() -> iterator& {
+			++*current_;
+			settle();
+			return *this;
+		}
+
+		auto operator++(int) -> iterator {
+			auto temp = *this;
+			++*this;
+			return temp;
+		}
+
+		// End is (num_shards, std::nullopt), and every other position names an edge
+		auto operator==(iterator const& other) const -> bool {
+			return graph_ == other.graph_ and shard_ == other.shard_ and current_ == other.current_;
+		}
+
+	private:
+		// The first edge at or after the start of shard
+		iterator(sharded_graph const* g, std::size_t shard)
+		: graph_(g), shard_(shard) {
+			if (shard_ < g->shards_.size()) {
+				current_.emplace(g->shards_[shard_].local.begin());
+			}
+			settle();
+		}
+
+		iterator(sharded_graph const* g, std::size_t shard, shard_iterator it)
+		: graph_(g), shard_(shard), current_(std::in_place, std::move(it)) {}
+
+		// Moves past the end of the current shard's edges, skipping shards without edges
+		auto settle() -> void {
+			const auto& shards = graph_->shards_;
+			while (shard_ < shards.size() and *current_ == shards[shard_].local.end()) {
+				++shard_;
+				current_.reset();
+				if (shard_ < shards.size()) {
+					current_.emplace(shards[shard_].local.begin());
+				}
+			}
+		}
+
+		sharded_graph const* graph_ = nullptr;
+		std::size_t shard_ = 0;
+		std::optional<shard_iterator> current_;
+
+		friend class sharded_graph;
+	};
+}
+
+#endif // GDWG_SHARDED_GRAPH_H
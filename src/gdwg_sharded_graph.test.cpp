@@ -0,0 +1,197 @@
+#include "gdwg_sharded_graph.h"
+
+#include <catch2/catch.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	// Puts node n on shard n % num_shards, so tests know which edges are cut
+	struct modulo_partition {
+		auto operator()(int n) const noexcept -> std::size_t {
+			return static_cast<std::size_t>(n);
+		}
+	};
+
+	// Checks every query of g against reference, a gdwg::graph holding the same nodes and edges
+	template<typename Sharded>
+	auto check_against(Sharded const& g, gdwg::graph<int, int> const& reference) -> void {
+		REQUIRE(g.to_graph() == reference);
+		REQUIRE(g.nodes() == reference.nodes());
+		REQUIRE(g.num_nodes() == reference.num_nodes());
+		REQUIRE(g.num_edges() == reference.num_edges());
+		REQUIRE(static_cast<std::size_t>(std::distance(g.begin(), g.end())) == reference.num_edges());
+		for (auto const& src : reference.nodes()) {
+			REQUIRE(g.connections(src) == reference.connections(src));
+			REQUIRE(g.out_degree(src) == reference.out_degree(src));
+			REQUIRE(g.in_degree(src) == reference.in_degree(src));
+			for (auto const& dst : reference.nodes()) {
+				REQUIRE(g.is_connected(src, dst) == reference.is_connected(src, dst));
+			}
+		}
+		auto const report = g.partition_report();
+		REQUIRE(report.total_edges == reference.num_edges());
+		auto cut = std::size_t{0};
+		for (auto it = reference.begin(); it != reference.end(); ++it) {
+			if (g.shard_of((*it).from) != g.shard_of((*it).to)) {
+				++cut;
+			}
+		}
+		REQUIRE(report.cut_edges == cut);
+		auto ghosts = std::size_t{0};
+		for (auto shard = std::size_t{0}; shard < g.num_shards(); ++shard) {
+			ghosts += report.ghosts[shard];
+			REQUIRE(report.edges[shard] == g.shard(shard).num_edges());
+		}
+		// Every ghost is the dst of at least one cut edge
+		REQUIRE(ghosts <= cut);
+	}
+}
+
+TEST_CASE("sharded_graph matches graph semantics") {
+	auto g = gdwg::sharded_graph<int, int, modulo_partition>(3);
+	auto reference = gdwg::graph<int, int>{};
+	for (auto i = 0; i < 6; ++i) {
+		REQUIRE(g.insert_node(i));
+		reference.insert_node(i);
+	}
+	REQUIRE_FALSE(g.insert_node(4));
+	REQUIRE(g.num_shards() == 3);
+	REQUIRE(g.shard_of(4) == 1);
+	STATIC_REQUIRE(std::forward_iterator<decltype(g)::iterator>);
+
+	SECTION("cut edges are stored once, with a ghost on each side") {
+		REQUIRE(g.insert_edge(0, 1, 5));
+		REQUIRE(g.insert_edge(0, 1));
+		REQUIRE(g.insert_edge(0, 3, 2));
+		REQUIRE_FALSE(g.insert_edge(0, 1, 5));
+		reference.insert_edge(0, 1, 5);
+		reference.insert_edge(0, 1);
+		reference.insert_edge(0, 3, 2);
+		check_against(g, reference);
+
+		// 0 and 3 share shard 0, which holds a ghost of 1
+		REQUIRE(g.shard(0).nodes() == std::vector<int>{0, 1, 3});
+		REQUIRE(g.shard(1).num_edges() == 0);
+		auto const report = g.partition_report();
+		REQUIRE(report.cut_edges == 2);
+		REQUIRE(report.ghosts == std::vector<std::size_t>{1, 0, 0});
+		REQUIRE(report.nodes == std::vector<std::size_t>{2, 2, 2});
+		REQUIRE(report.cut_ratio() == Approx(2.0 / 3.0));
+		REQUIRE(report.edge_imbalance() == Approx(3.0));
+
+		auto const it = g.find(0, 1, 5);
+		REQUIRE(it != g.end());
+		REQUIRE((*it).from == 0);
+		REQUIRE((*it).to == 1);
+		REQUIRE((*it).weight == 5);
+		REQUIRE(g.find(1, 0) == g.end());
+		REQUIRE(g.find(-3, 0) == g.end());
+	}
+
+	SECTION("ghosts go away with the last edge that uses them") {
+		g.insert_edge(0, 1, 5);
+		g.insert_edge(0, 1);
+		REQUIRE(g.erase_edge(0, 1, 5));
+		REQUIRE(g.shard(0).is_node(1));
+		REQUIRE_FALSE(g.erase_edge(0, 1, 5));
+		REQUIRE(g.erase_edge(0, 1));
+		REQUIRE_FALSE(g.shard(0).is_node(1));
+		REQUIRE_FALSE(g.erase_edge(0, 4));
+		check_against(g, reference);
+	}
+
+	SECTION("erase_node removes cut edges on both sides") {
+		for (auto const& [src, dst] : {std::pair{0, 1}, {2, 1}, {4, 1}, {1, 0}, {1, 1}, {1, 5}, {3, 0}}) {
+			g.insert_edge(src, dst, src + dst);
+			reference.insert_edge(src, dst, src + dst);
+		}
+		check_against(g, reference);
+		REQUIRE(g.erase_node(1));
+		REQUIRE_FALSE(g.erase_node(1));
+		reference.erase_node(1);
+		check_against(g, reference);
+		REQUIRE(g.partition_report().ghosts == std::vector<std::size_t>{0, 0, 0});
+		REQUIRE(g.insert_node(1));
+		REQUIRE(g.in_degree(1) == 0);
+	}
+
+	SECTION("missing nodes throw") {
+		REQUIRE_THROWS_WITH(g.insert_edge(0, 9),
+		                    "Cannot call gdwg::sharded_graph<N, E>::insert_edge when either src or dst node does not exist");
+		REQUIRE_THROWS_WITH(g.erase_edge(9, 0),
+		                    "Cannot call gdwg::sharded_graph<N, E>::erase_edge on src or dst if they don't exist in the graph");
+		REQUIRE_THROWS_WITH(g.is_connected(0, 9),
+		                    "Cannot call gdwg::sharded_graph<N, E>::is_connected if src or dst node don't exist in the graph");
+		REQUIRE_THROWS_WITH(g.connections(9), "Cannot call gdwg::sharded_graph<N, E>::connections if src doesn't exist in the graph");
+		REQUIRE_THROWS_WITH(g.out_degree(9), "Cannot call gdwg::sharded_graph<N, E>::out_degree if src doesn't exist in the graph");
+		REQUIRE_THROWS_WITH(g.in_degree(9), "Cannot call gdwg::sharded_graph<N, E>::in_degree if dst doesn't exist in the graph");
+		REQUIRE_THROWS_WITH((gdwg::sharded_graph<int, int>(0)), "Cannot construct gdwg::sharded_graph<N, E> with zero shards");
+	}
+}
+
+TEST_CASE("sharded_graph stays equal to a graph under random mutations") {
+	auto const num_shards = GENERATE(std::size_t{1}, std::size_t{4}, std::size_t{7});
+	auto g = gdwg::sharded_graph<int, int>(num_shards);
+	auto reference = gdwg::graph<int, int>{};
+	auto rng = std::mt19937(static_cast<unsigned>(num_shards));
+	auto pick = std::uniform_int_distribution<int>(0, 23);
+	for (auto step = 0; step < 1500; ++step) {
+		auto const a = pick(rng);
+		auto const b = pick(rng);
+		auto const weight = b % 4 == 0 ? std::nullopt : std::optional<int>(a % 3);
+		switch (step % 7) {
+		case 0: REQUIRE(g.insert_node(a) == reference.insert_node(a)); break;
+		case 1: REQUIRE(g.erase_node(a) == reference.erase_node(a)); break;
+		case 2:
+			if (reference.is_node(a) and reference.is_node(b)) {
+				REQUIRE(g.erase_edge(a, b, weight) == reference.erase_edge(a, b, weight));
+			}
+			break;
+		default:
+			if (reference.is_node(a) and reference.is_node(b)) {
+				REQUIRE(g.insert_edge(a, b, weight) == reference.insert_edge(a, b, weight));
+			}
+			break;
+		}
+	}
+	check_against(g, reference);
+
+	auto const rebuilt = gdwg::sharded_graph<int, int>(reference, num_shards);
+	check_against(rebuilt, reference);
+	g.clear();
+	REQUIRE(g.empty());
+	REQUIRE(g.begin() == g.end());
+}
+
+TEST_CASE("sharded_graph shards allocate from their own resources") {
+	auto first = std::pmr::monotonic_buffer_resource();
+	auto second = std::pmr::monotonic_buffer_resource();
+	using allocator_type = gdwg::graph<std::string, int>::allocator_type;
+	auto g = gdwg::sharded_graph<std::string, int>(std::vector<allocator_type>{&first, &second});
+	REQUIRE(g.num_shards() == 2);
+	for (auto const* node : {"a", "b", "c", "d", "e"}) {
+		g.insert_node(node);
+	}
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("c", "d");
+	g.insert_edge("e", "a", 3);
+	REQUIRE(g.num_edges() == 3);
+	REQUIRE(g.shard(0).get_allocator().resource() == &first);
+	REQUIRE(g.shard(1).get_allocator().resource() == &second);
+	REQUIRE(g.connections("a") == std::vector<std::string>{"b"});
+
+	auto out = std::ostringstream();
+	out << g.partition_report();
+	REQUIRE(out.str().find("shards 2\ntotal_edges 3\n") == 0);
+	REQUIRE(out.str().find("shard.1.ghosts ") != std::string::npos);
+	REQUIRE_THROWS_AS(g.shard(2), std::out_of_range);
+}